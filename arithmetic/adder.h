@@ -4,12 +4,16 @@
 
 // Half Adder — adds two single bits.
 // Outputs: sum and carry.
+//
+// Like everything in arithmetic/, these are templates over the wire type
+// (gates/lane.h). The plain names are the one-bit bool versions.
 
-struct HalfAdder {
-    bool sum   = false;
-    bool carry = false;
+template <typename Lane>
+struct BasicHalfAdder {
+    Lane sum   = LaneTraits<Lane>::zeros();
+    Lane carry = LaneTraits<Lane>::zeros();
 
-    void add(bool a, bool b) {
+    void add(Lane a, Lane b) {
         sum   = gate::XOR(a, b);
         carry = gate::AND(a, b);
     }
@@ -18,12 +22,13 @@ struct HalfAdder {
 // Full Adder — adds two bits plus a carry-in.
 // Built from two half adders (just like the book shows).
 
-struct FullAdder {
-    bool sum   = false;
-    bool carry = false;
+template <typename Lane>
+struct BasicFullAdder {
+    Lane sum   = LaneTraits<Lane>::zeros();
+    Lane carry = LaneTraits<Lane>::zeros();
 
-    void add(bool a, bool b, bool carry_in) {
-        HalfAdder ha1, ha2;
+    void add(Lane a, Lane b, Lane carry_in) {
+        BasicHalfAdder<Lane> ha1, ha2;
 
         ha1.add(a, b);              // First half: add a + b
         ha2.add(ha1.sum, carry_in); // Second half: add that sum + carry_in
@@ -33,20 +38,26 @@ struct FullAdder {
     }
 };
 
+using HalfAdder = BasicHalfAdder<bool>;
+using FullAdder = BasicFullAdder<bool>;
+
 // Ripple-Carry Adder — chains N full adders to add two N-bit numbers.
 // The carry "ripples" from bit 0 up to bit N-1.
 
-template <int N>
+template <int N, typename Lane = bool>
 class RippleCarryAdder {
 public:
-    std::array<bool, N> sum = {};
-    bool carry_out = false;
+    static constexpr const char* NAME = "ripple";
+
+    Wires<N, Lane> sum = {};
+    Lane carry_out = LaneTraits<Lane>::zeros();
 
-    void add(const std::array<bool, N>& a, const std::array<bool, N>& b, bool carry_in = false) {
-        bool carry = carry_in;
+    void add(const Wires<N, Lane>& a, const Wires<N, Lane>& b,
+             Lane carry_in = LaneTraits<Lane>::zeros()) {
+        Lane carry = carry_in;
 
         for (int i = 0; i < N; i++) {
-            FullAdder fa;
+            BasicFullAdder<Lane> fa;
             fa.add(a[i], b[i], carry);
             sum[i] = fa.sum;
             carry = fa.carry;
@@ -55,12 +66,6 @@ public:
         carry_out = carry;
     }
 
-    // Helper: convert result to integer
-    int to_int() const {
-        int result = 0;
-        for (int i = 0; i < N; i++) {
-            if (sum[i]) result |= (1 << i);
-        }
-        return result;
-    }
+    // Helper: convert result to integer (bool wires only)
+    int to_int() const { return sum.to_int(); }
 };
@@ -1,5 +1,6 @@
 #pragma once
 #include "adder.h"
+#include "lookahead_adder.h"
 #include <array>
 
 // Simple ALU (Arithmetic Logic Unit)
@@ -13,63 +14,63 @@
 // Flags:
 //   carry — carry/borrow out from addition/subtraction
 //   zero  — true when result is all zeros
+//
+// With Lane = uint64_t this is 64 independent ALUs: every lane has its
+// own operands and its own opcode, and one compute() runs them all.
+//
+// Adder picks the adder circuit: RippleCarryAdder (default),
+// CarryLookaheadAdder, KoggeStoneAdder or BrentKungAdder.
 
-template <int N>
+template <int N, typename Lane = bool, template <int, typename> class Adder = RippleCarryAdder>
 class ALU {
 public:
-    std::array<bool, N> result = {};
-    bool carry = false;
-    bool zero  = false;
+    Wires<N, Lane> result = {};
+    Lane carry = LaneTraits<Lane>::zeros();
+    Lane zero  = LaneTraits<Lane>::zeros();
 
-    void compute(const std::array<bool, N>& a,
-                 const std::array<bool, N>& b,
-                 bool op0, bool op1)
+    void compute(const Wires<N, Lane>& a,
+                 const Wires<N, Lane>& b,
+                 Lane op0, Lane op1)
     {
         // op1=0: arithmetic (ADD/SUB),  op1=1: logic (AND/OR)
         // op0=0: ADD or AND,            op0=1: SUB or OR
+        //
+        // The bitwise stages are written on whole buses: one gate per
+        // wire, or one word-wide gate when the bus is packed Bits<N>.
+        Wires<N, Lane> sel0 = fanout<N>(op0);
+        Wires<N, Lane> sel1 = fanout<N>(op1);
 
         // --- Arithmetic path ---
         // For SUB, invert B and set carry-in to 1 (two's complement negation)
-        std::array<bool, N> b_modified = {};
-        for (int i = 0; i < N; i++) {
-            b_modified[i] = gate::XOR(b[i], op0);  // invert B if SUB
-        }
+        Wires<N, Lane> b_modified = gate::XOR(b, sel0);  // invert B if SUB
 
-        RippleCarryAdder<N> adder;
+        Adder<N, Lane> adder;
         adder.add(a, b_modified, op0);  // carry_in = 1 if SUB
 
         // --- Logic path ---
-        std::array<bool, N> logic_result = {};
-        for (int i = 0; i < N; i++) {
-            bool and_result = gate::AND(a[i], b[i]);
-            bool or_result  = gate::OR(a[i], b[i]);
-            // Mux: op0 selects AND (0) or OR (1)
-            logic_result[i] = gate::OR(
-                gate::AND(gate::NOT(op0), and_result),
-                gate::AND(op0, or_result)
-            );
-        }
+        // Mux: op0 selects AND (0) or OR (1)
+        Wires<N, Lane> logic_result = gate::OR(
+            gate::AND(gate::NOT(sel0), gate::AND(a, b)),
+            gate::AND(sel0, gate::OR(a, b))
+        );
 
         // --- Output mux: op1 selects arithmetic (0) or logic (1) ---
-        zero = true;
+        result = gate::OR(
+            gate::AND(gate::NOT(sel1), adder.sum),
+            gate::AND(sel1, logic_result)
+        );
+
+        // Zero flag is a NOR across the result bits
+        zero = LaneTraits<Lane>::ones();
         for (int i = 0; i < N; i++) {
-            result[i] = gate::OR(
-                gate::AND(gate::NOT(op1), adder.sum[i]),
-                gate::AND(op1, logic_result[i])
-            );
-            if (result[i]) zero = false;
+            Lane bit = result[i];
+            zero = gate::AND(zero, gate::NOT(bit));
         }
 
         // Carry flag only meaningful for arithmetic ops
         carry = gate::AND(gate::NOT(op1), adder.carry_out);
     }
 
-    // Helper: convert result to integer
-    int to_int() const {
-        int r = 0;
-        for (int i = 0; i < N; i++) {
-            if (result[i]) r |= (1 << i);
-        }
-        return r;
-    }
+    // Helper: convert result to integer (bool wires only)
+    int to_int() const { return result.to_int(); }
 };
@@ -10,23 +10,23 @@
 // This is how a CPU selects which register to write to, or how
 // memory chips select which address to access.
 
-template <int N>
+template <int N, typename Lane = bool>
 class Decoder {
 public:
     static constexpr int NUM_OUTPUTS = 1 << N;  // 2^N
 
-    std::array<bool, NUM_OUTPUTS> outputs = {};
+    Wires<NUM_OUTPUTS, Lane> outputs = {};
 
-    void decode(const std::array<bool, N>& address, bool enable = true) {
+    void decode(const Wires<N, Lane>& address, Lane enable = LaneTraits<Lane>::ones()) {
         for (int out = 0; out < NUM_OUTPUTS; out++) {
             // An output line is HIGH when the address bits match its index.
             // We AND together each address bit (or its complement):
             //   - If bit i of the output index is 1, use address[i]
             //   - If bit i of the output index is 0, use NOT(address[i])
-            bool match = true;
+            Lane match = LaneTraits<Lane>::ones();
             for (int bit = 0; bit < N; bit++) {
                 bool need_high = (out >> bit) & 1;
-                bool term = need_high ? address[bit] : gate::NOT(address[bit]);
+                Lane term = need_high ? address[bit] : gate::NOT(address[bit]);
                 match = gate::AND(match, term);
             }
             outputs[out] = gate::AND(match, enable);
@@ -0,0 +1,194 @@
+#pragma once
+#include "adder.h"
+#include <array>
+
+// Faster adders — same interface as RippleCarryAdder, different carry logic.
+//
+// A ripple adder's carry has to walk through every bit, so its delay
+// grows with N. These adders compute all the carries in parallel from
+// two signals per bit:
+//   generate  g = AND(a, b)  this bit makes a carry by itself
+//   propagate p = XOR(a, b)  this bit passes an incoming carry along
+// Then sum[i] = XOR(p[i], carry into bit i), exactly as in a full adder.
+//
+// They cost more gates and win on depth (critical path); see
+// adder_netlist() in cpu/netlists.h for the numbers.
+
+template <int N, typename Lane>
+void generate_propagate(const Wires<N, Lane>& a, const Wires<N, Lane>& b,
+                        std::array<Lane, N>& g, std::array<Lane, N>& p) {
+    for (int i = 0; i < N; i++) {
+        g[i] = gate::AND(a[i], b[i]);
+        p[i] = gate::XOR(a[i], b[i]);
+    }
+}
+
+// Carry out of the lowest k of a set of (generate, propagate) pairs,
+// given the carry coming in. The classic two-level AND-OR:
+//   c = g[k-1] OR p[k-1]g[k-2] OR ... OR p[k-1]...p[0]cin
+template <typename Lane>
+Lane lookahead_carry(const Lane* g, const Lane* p, int k, Lane cin) {
+    Lane carry = LaneTraits<Lane>::zeros();
+    for (int j = -1; j < k; j++) {
+        Lane term = j < 0 ? cin : g[j];
+        for (int m = j + 1; m < k; m++) term = gate::AND(term, p[m]);
+        carry = gate::OR(carry, term);
+    }
+    return carry;
+}
+
+// Carry-Lookahead Adder — 4-bit lookahead groups, stacked.
+//
+// Each group of 4 bits gets a lookahead unit that produces every carry
+// inside the group at once, plus a group generate/propagate pair. Groups
+// of 4 groups get the same unit one level up, and so on until one group
+// covers the whole word. Carries then flow back down level by level.
+
+template <int N, typename Lane = bool>
+class CarryLookaheadAdder {
+public:
+    static constexpr const char* NAME = "lookahead";
+
+    Wires<N, Lane> sum = {};
+    Lane carry_out = LaneTraits<Lane>::zeros();
+
+    void add(const Wires<N, Lane>& a, const Wires<N, Lane>& b,
+             Lane carry_in = LaneTraits<Lane>::zeros()) {
+        // Level 0 is one (g, p) pair per bit; each level up has one per
+        // group of 4 below it
+        std::array<std::array<Lane, N>, LEVELS> g = {}, p = {};
+        std::array<int, LEVELS> count = {};
+        generate_propagate<N, Lane>(a, b, g[0], p[0]);
+        count[0] = N;
+
+        int top = 0;
+        while (count[top] > 1) {
+            int below = count[top];
+            top++;
+            count[top] = (below + GROUP - 1) / GROUP;
+            for (int j = 0; j < count[top]; j++) {
+                int first = j * GROUP;
+                int k = below - first < GROUP ? below - first : GROUP;
+                g[top][j] = lookahead_carry(&g[top - 1][first], &p[top - 1][first], k,
+                                            LaneTraits<Lane>::zeros());
+                p[top][j] = p[top - 1][first];
+                for (int m = 1; m < k; m++) p[top][j] = gate::AND(p[top][j], p[top - 1][first + m]);
+            }
+        }
+
+        // Carries back down: a group's carry-in is its first member's,
+        // and its lookahead unit supplies the rest
+        std::array<std::array<Lane, N>, LEVELS> c = {};
+        c[top][0] = carry_in;
+        for (int level = top; level > 0; level--) {
+            for (int j = 0; j < count[level]; j++) {
+                int first = j * GROUP;
+                int k = count[level - 1] - first < GROUP ? count[level - 1] - first : GROUP;
+                c[level - 1][first] = c[level][j];
+                for (int m = 1; m < k; m++)
+                    c[level - 1][first + m] = lookahead_carry(&g[level - 1][first], &p[level - 1][first],
+                                                              m, c[level][j]);
+            }
+        }
+
+        for (int i = 0; i < N; i++) sum[i] = gate::XOR(p[0][i], c[0][i]);
+        carry_out = gate::OR(g[top][0], gate::AND(p[top][0], carry_in));
+    }
+
+    // Helper: convert result to integer (bool wires only)
+    int to_int() const { return sum.to_int(); }
+
+private:
+    static constexpr int GROUP = 4;
+
+    // 1 + ceil(log4 N): enough levels for groups of 4 to reach one
+    static constexpr int levels_for(int n) { return n <= 1 ? 1 : 1 + levels_for((n + GROUP - 1) / GROUP); }
+    static constexpr int LEVELS = levels_for(N);
+};
+
+// Parallel-prefix adders.
+//
+// Carry into bit i+1 is the "group generate" of bits i..0: whether that
+// span produces a carry out. Spans combine with one small cell,
+//   (G, P) o (G', P') = (OR(G, AND(P, G')), AND(P, P'))
+// where (G, P) is the higher span and (G', P') the one just below it.
+// The carry-in is folded into bit 0's generate, so G[i] is the carry
+// out of bit i. The two adders below differ only in which spans they
+// combine, trading depth against cell count.
+
+template <typename Lane>
+void prefix_cell(Lane& g, Lane& p, Lane g_low, Lane p_low) {
+    g = gate::OR(g, gate::AND(p, g_low));
+    p = gate::AND(p, p_low);
+}
+
+// Kogge-Stone: every bit combines with the bit d below it, for
+// d = 1, 2, 4, ... — log2(N) levels, about N cells per level.
+
+template <int N, typename Lane = bool>
+class KoggeStoneAdder {
+public:
+    static constexpr const char* NAME = "kogge-stone";
+
+    Wires<N, Lane> sum = {};
+    Lane carry_out = LaneTraits<Lane>::zeros();
+
+    void add(const Wires<N, Lane>& a, const Wires<N, Lane>& b,
+             Lane carry_in = LaneTraits<Lane>::zeros()) {
+        std::array<Lane, N> g, p;
+        generate_propagate<N, Lane>(a, b, g, p);
+        std::array<Lane, N> G = g, P = p;
+        G[0] = gate::OR(g[0], gate::AND(p[0], carry_in));
+
+        for (int d = 1; d < N; d *= 2) {
+            // Each level reads only the previous level's spans
+            std::array<Lane, N> prev_g = G, prev_p = P;
+            for (int i = d; i < N; i++) prefix_cell(G[i], P[i], prev_g[i - d], prev_p[i - d]);
+        }
+
+        sum[0] = gate::XOR(p[0], carry_in);
+        for (int i = 1; i < N; i++) sum[i] = gate::XOR(p[i], G[i - 1]);
+        carry_out = G[N - 1];
+    }
+
+    // Helper: convert result to integer (bool wires only)
+    int to_int() const { return sum.to_int(); }
+};
+
+// Brent-Kung: build spans up a binary tree, then fill in the bits the
+// tree skipped on the way back down — about 2 log2(N) levels, fewer
+// than 2N cells in total.
+
+template <int N, typename Lane = bool>
+class BrentKungAdder {
+public:
+    static constexpr const char* NAME = "brent-kung";
+
+    Wires<N, Lane> sum = {};
+    Lane carry_out = LaneTraits<Lane>::zeros();
+
+    void add(const Wires<N, Lane>& a, const Wires<N, Lane>& b,
+             Lane carry_in = LaneTraits<Lane>::zeros()) {
+        std::array<Lane, N> g, p;
+        generate_propagate<N, Lane>(a, b, g, p);
+        std::array<Lane, N> G = g, P = p;
+        G[0] = gate::OR(g[0], gate::AND(p[0], carry_in));
+
+        int top = 1;
+        while (top * 2 <= N) top *= 2;
+
+        // Up the tree: bit 2d-1, 4d-1, ... takes in the span d below it
+        for (int d = 1; d < top; d *= 2)
+            for (int i = 2 * d - 1; i < N; i += 2 * d) prefix_cell(G[i], P[i], G[i - d], P[i - d]);
+        // Back down: the bits halfway between finished ones
+        for (int d = top / 2; d >= 1; d /= 2)
+            for (int i = 3 * d - 1; i < N; i += 2 * d) prefix_cell(G[i], P[i], G[i - d], P[i - d]);
+
+        sum[0] = gate::XOR(p[0], carry_in);
+        for (int i = 1; i < N; i++) sum[i] = gate::XOR(p[i], G[i - 1]);
+        carry_out = G[N - 1];
+    }
+
+    // Helper: convert result to integer (bool wires only)
+    int to_int() const { return sum.to_int(); }
+};
@@ -11,20 +11,20 @@
 // Each output bit is computed with pure gate logic:
 //   output[i] = OR(AND(NOT(sel), a[i]), AND(sel, b[i]))
 
-template <int N>
+template <int N, typename Lane = bool>
 class Mux2 {
 public:
-    std::array<bool, N> output = {};
+    Wires<N, Lane> output = {};
 
-    void select(bool sel,
-                const std::array<bool, N>& a,
-                const std::array<bool, N>& b) {
-        for (int i = 0; i < N; i++) {
-            output[i] = gate::OR(
-                gate::AND(gate::NOT(sel), a[i]),
-                gate::AND(sel, b[i])
-            );
-        }
+    void select(Lane sel,
+                const Wires<N, Lane>& a,
+                const Wires<N, Lane>& b) {
+        // Whole bus at once: sel fans out to every wire's AND gate
+        Wires<N, Lane> s = fanout<N>(sel);
+        output = gate::OR(
+            gate::AND(gate::NOT(s), a),
+            gate::AND(s, b)
+        );
     }
 };
 
@@ -43,16 +43,16 @@ public:
 //
 // Used in the CPU to select which of the 4 registers to read.
 
-template <int N>
+template <int N, typename Lane = bool>
 class Mux4 {
 public:
-    std::array<bool, N> output = {};
+    Wires<N, Lane> output = {};
 
-    void select(bool s0, bool s1,
-                const std::array<bool, N>& a,
-                const std::array<bool, N>& b,
-                const std::array<bool, N>& c,
-                const std::array<bool, N>& d) {
+    void select(Lane s0, Lane s1,
+                const Wires<N, Lane>& a,
+                const Wires<N, Lane>& b,
+                const Wires<N, Lane>& c,
+                const Wires<N, Lane>& d) {
         mux_lo.select(s0, a, b);
         mux_hi.select(s0, c, d);
         mux_out.select(s1, mux_lo.output, mux_hi.output);
@@ -60,7 +60,7 @@ public:
     }
 
 private:
-    Mux2<N> mux_lo;
-    Mux2<N> mux_hi;
-    Mux2<N> mux_out;
+    Mux2<N, Lane> mux_lo;
+    Mux2<N, Lane> mux_hi;
+    Mux2<N, Lane> mux_out;
 };
@@ -0,0 +1,606 @@
+#include "cpu/computer.h"
+#include "cpu/smp_computer.h"
+#include "cpu/netlists.h"
+#include "cpu/netlists_gen.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define BENCH_FORK 1
+#else
+#define BENCH_FORK 0
+#endif
+
+// Benchmark suite.
+//
+// Guest workloads on every execution core: instructions per second,
+// ns per instruction, each workload's opcode-class mix, and the peak RSS
+// of the process that ran it (every core/workload pair runs in its own
+// forked child, so one run's JIT buffer or caches don't show up in the
+// next one's number). Then component benchmarks: gate-level ALU
+// throughput with bool wires vs 64-lane bit slices, the ALU's captured
+// netlist against the template it came from, and the gate count, depth
+// and host speed of each adder design. Last, the ALU loop on 1, 2 and 4
+// FastCPU cores of an SmpComputer, lockstep and with a thread per core.
+//
+// Build: g++ -std=c++17 -O2 -pthread -o bench bench.cpp && ./bench
+//   ./bench --json     one JSON object on stdout, for diffing across commits
+//   ./bench --quick    shorter runs, noisier numbers
+
+void emit(std::vector<uint8_t>& prog, uint8_t opcode, uint8_t rd, uint8_t rs, uint16_t imm) {
+    uint8_t top = (opcode << 4) | ((rd & 3) << 2) | (rs & 3);
+    prog.push_back(imm & 0xFF);
+    prog.push_back((imm >> 8) & 0xFF);
+    prog.push_back(top);
+}
+
+// --- Opcode classes ---
+
+enum OpClass { ALU_OP, MEMORY, IO, BRANCH, STACK, INTERRUPT, OTHER, NUM_CLASSES };
+const char* const class_names[NUM_CLASSES] = {"alu", "mem", "io", "branch", "stack", "irq", "other"};
+
+// Class of the instruction the core is about to execute. Loads and
+// stores count as I/O when their address is in the device window.
+OpClass classify(const Bus& bus, const Core& cpu) {
+    uint16_t pc = cpu.get_pc();
+    uint16_t imm = bus.read_word(pc);
+    uint8_t top = bus.read_byte(pc + 2);
+    uint8_t op = top >> 4, rd = (top >> 2) & 3, rs = top & 3;
+
+    switch (op) {
+        case 0x0:
+            if (rs == 0) return rd == 0 ? OTHER : INTERRUPT;       // NOP / CLI, STI, RTI
+            if (rs != 3 || rd == 0) return STACK;                   // PUSH, POP, RET
+            return rd == 1 ? INTERRUPT : BRANCH;                    // SWI / JC, JNC
+        case 0x2:
+        case 0x3: {
+            uint16_t addr = rs == 1 ? (cpu.get_reg(2) << 8) | cpu.get_reg(3) : imm;
+            return addr >= Bus::IO_BASE ? IO : MEMORY;
+        }
+        case 0xA: case 0xB: case 0xC: return BRANCH;
+        case 0xE: return STACK;
+        case 0xF: return OTHER;
+        default: return ALU_OP;
+    }
+}
+
+// --- Guest workloads ---
+//
+// Each one is written to be dominated by one opcode class, so its
+// ns/instruction is roughly that class's cost on a given core; the mix
+// column says how dominated it really is.
+
+struct Workload {
+    const char* name;
+    OpClass stresses;
+    std::vector<uint8_t> (*program)();
+    void (*setup)(Computer&);              // before the first step (may be null)
+    void (*host)(Computer&, int steps);    // before each run() of `steps` (may be null)
+};
+
+// Tight ALU loop: five ALU ops and a branch per iteration
+std::vector<uint8_t> arith_program() {
+    std::vector<uint8_t> prog;
+    emit(prog, 0x1, 1, 0, 1);          // addr 0:  LDI R1, 1
+    emit(prog, 0x1, 0, 0, 200);        // addr 3:  LDI R0, 200
+    emit(prog, 0x4, 2, 0, 0);          // addr 6:  ADD R2, R0
+    emit(prog, 0x7, 3, 2, 0);          // addr 9:  OR R3, R2
+    emit(prog, 0x6, 3, 0, 0);          // addr 12: AND R3, R0
+    emit(prog, 0xD, 2, 0, 7);          // addr 15: ADDI R2, 7
+    emit(prog, 0x5, 0, 1, 0);          // addr 18: SUB R0, R1
+    emit(prog, 0xC, 0, 0, 6);          // addr 21: JNZ 6
+    emit(prog, 0xA, 0, 0, 3);          // addr 24: JMP 3
+    return prog;
+}
+
+// Increment every byte of 0x1000-0x1FFF through R2:R3, over and over
+std::vector<uint8_t> memsweep_program() {
+    std::vector<uint8_t> prog;
+    emit(prog, 0x1, 2, 0, 0x10);       // addr 0:  LDI R2, 0x10
+    emit(prog, 0x1, 3, 0, 0);          // addr 3:  LDI R3, 0
+    emit(prog, 0x2, 0, 1, 0);          // addr 6:  LDR R0, [R2:R3]
+    emit(prog, 0xD, 0, 0, 1);          // addr 9:  ADDI R0, 1
+    emit(prog, 0x3, 0, 1, 0);          // addr 12: STR R0, [R2:R3]
+    emit(prog, 0xD, 3, 0, 1);          // addr 15: ADDI R3, 1
+    emit(prog, 0x0, 3, 3, 6);          // addr 18: JNC 6
+    emit(prog, 0xD, 2, 0, 1);          // addr 21: ADDI R2, 1
+    emit(prog, 0x1, 1, 0, 0x20);       // addr 24: LDI R1, 0x20
+    emit(prog, 0x9, 2, 1, 0);          // addr 27: CMP R2, R1
+    emit(prog, 0xC, 0, 0, 6);          // addr 30: JNZ 6
+    emit(prog, 0xA, 0, 0, 0);          // addr 33: JMP 0
+    return prog;
+}
+
+// Recurse 24 deep, saving R0 in every frame
+std::vector<uint8_t> recursion_program() {
+    std::vector<uint8_t> prog;
+    emit(prog, 0x1, 0, 0, 24);         // addr 0:  LDI R0, 24
+    emit(prog, 0xE, 0, 0, 9);          // addr 3:  CALL 9
+    emit(prog, 0xA, 0, 0, 0);          // addr 6:  JMP 0
+    emit(prog, 0x0, 0, 1, 0);          // addr 9:  PUSH R0
+    emit(prog, 0x1, 1, 0, 1);          // addr 12: LDI R1, 1
+    emit(prog, 0x5, 0, 1, 0);          // addr 15: SUB R0, R1
+    emit(prog, 0xB, 0, 0, 24);         // addr 18: JZ 24
+    emit(prog, 0xE, 0, 0, 9);          // addr 21: CALL 9
+    emit(prog, 0x0, 0, 2, 0);          // addr 24: POP R0
+    emit(prog, 0x0, 0, 3, 0);          // addr 27: RET
+    return prog;
+}
+
+// Timer firing every 8 ticks; the handler acknowledges and returns
+constexpr uint16_t IRQ_HANDLER = 0x40;
+
+std::vector<uint8_t> irq_program() {
+    std::vector<uint8_t> prog;
+    emit(prog, 0x1, 0, 0, 8);          // addr 0:  LDI R0, 8
+    emit(prog, 0x3, 0, 0, 0xF000);     // addr 3:  ST R0, [timer reload]
+    emit(prog, 0x1, 0, 0, 2);          // addr 6:  LDI R0, 2
+    emit(prog, 0x3, 0, 0, 0xF001);     // addr 9:  ST R0, [timer control]  (enable)
+    emit(prog, 0x0, 2, 0, 0);          // addr 12: STI
+    emit(prog, 0xD, 1, 0, 1);          // addr 15: ADDI R1, 1
+    emit(prog, 0xA, 0, 0, 15);         // addr 18: JMP 15
+    prog.resize(IRQ_HANDLER);
+    emit(prog, 0x0, 0, 1, 0);          // addr 0x40: PUSH R0
+    emit(prog, 0x1, 0, 0, 2);          // addr 0x43: LDI R0, 2
+    emit(prog, 0x3, 0, 0, 0xF001);     // addr 0x46: ST R0, [timer control]  (ack, stay enabled)
+    emit(prog, 0x0, 0, 2, 0);          // addr 0x49: POP R0
+    emit(prog, 0x0, 3, 0, 0);          // addr 0x4C: RTI
+    return prog;
+}
+
+void irq_setup(Computer& c) { c.get_bus().write_word(IVT_BASE + 1 * 2, IRQ_HANDLER); }
+
+// Polled echo: wait for RX, copy the character to TX
+std::vector<uint8_t> uart_program() {
+    std::vector<uint8_t> prog;
+    emit(prog, 0x2, 0, 0, 0xF003);     // addr 0:  LD R0, [UART status]
+    emit(prog, 0x1, 1, 0, 1);          // addr 3:  LDI R1, 1
+    emit(prog, 0x6, 0, 1, 0);          // addr 6:  AND R0, R1
+    emit(prog, 0xB, 0, 0, 0);          // addr 9:  JZ 0
+    emit(prog, 0x2, 0, 0, 0xF002);     // addr 12: LD R0, [UART data]
+    emit(prog, 0x3, 0, 0, 0xF002);     // addr 15: ST R0, [UART data]
+    emit(prog, 0xA, 0, 0, 0);          // addr 18: JMP 0
+    return prog;
+}
+
+// One character per 7-instruction echo, so the guest never idles
+void uart_host(Computer& c, int steps) {
+    c.get_uart().recv_string();
+    c.get_uart().send_string_quiet(std::string(steps / 7 + 1, 'x'));
+}
+
+const Workload workloads[] = {
+    {"arith",     ALU_OP,    arith_program,     nullptr,   nullptr},
+    {"memsweep",  MEMORY,    memsweep_program,  nullptr,   nullptr},
+    {"recursion", STACK,     recursion_program, nullptr,   nullptr},
+    {"irq",       INTERRUPT, irq_program,       irq_setup, nullptr},
+    {"uart",      IO,        uart_program,      nullptr,   uart_host},
+};
+
+Computer& start(Computer& c, const Workload& w) {
+    auto prog = w.program();
+    c.load_program(prog.data(), prog.size());
+    if (w.setup) w.setup(c);
+    return c;
+}
+
+// Fraction of executed instructions in each class, stepping the fast
+// core one instruction at a time. Taking an interrupt is a step that
+// pushes three bytes (PC and flags) and counts as irq.
+std::array<double, NUM_CLASSES> instruction_mix(const Workload& w, int steps) {
+    Computer c(CoreType::Fast);
+    start(c, w);
+    Core& cpu = c.get_cpu();
+    std::array<int, NUM_CLASSES> counts = {};
+    const int chunk = 1000;
+
+    for (int i = 0; i < steps; i++) {
+        if (i % chunk == 0 && w.host) w.host(c, chunk);
+        uint16_t sp = cpu.get_sp();
+        OpClass k = classify(c.get_bus(), cpu);
+        c.step();
+        if (uint16_t(sp - cpu.get_sp()) == 3) k = INTERRUPT;
+        counts[k]++;
+    }
+
+    std::array<double, NUM_CLASSES> mix;
+    for (int k = 0; k < NUM_CLASSES; k++) mix[k] = double(counts[k]) / steps;
+    return mix;
+}
+
+// --- Running one core on one workload ---
+
+struct RunResult {
+    uint64_t steps = 0;
+    double secs = 0;
+    long peak_rss_kb = 0;
+};
+
+long peak_rss_kb() {
+#if BENCH_FORK
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+#if defined(__APPLE__)
+    return ru.ru_maxrss / 1024;   // bytes there, KB on Linux
+#else
+    return ru.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+// Run in chunks until `budget` seconds have passed
+RunResult run_workload(CoreType type, const Workload& w, double budget) {
+    Computer c(type);
+    start(c, w);
+    // A host that feeds the UART tops it up often enough to stay within
+    // the RX ring's capacity
+    const int chunk = type == CoreType::Gate ? 10000 : w.host ? 100000 : 1000000;
+
+    RunResult r;
+    auto begin = std::chrono::steady_clock::now();
+    do {
+        if (w.host) w.host(c, chunk);
+        c.run(chunk);
+        r.steps += chunk;
+        r.secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    } while (r.secs < budget);
+    r.peak_rss_kb = peak_rss_kb();
+    return r;
+}
+
+// Same, in a child process so its peak RSS is its own. Falls back to
+// running in-process where there is no fork().
+RunResult run_isolated(CoreType type, const Workload& w, double budget) {
+#if BENCH_FORK
+    int fds[2];
+    if (pipe(fds) == 0) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            RunResult r = run_workload(type, w, budget);
+            ssize_t n = write(fds[1], &r, sizeof r);
+            _exit(n == ssize_t(sizeof r) ? 0 : 1);
+        }
+        close(fds[1]);
+        RunResult r;
+        bool ok = pid > 0 && read(fds[0], &r, sizeof r) == ssize_t(sizeof r);
+        close(fds[0]);
+        if (pid > 0) waitpid(pid, nullptr, 0);
+        if (ok) return r;
+    }
+#endif
+    return run_workload(type, w, budget);
+}
+
+// --- Component benchmarks ---
+
+// ALU evaluations per second: one scalar ALU against 64 bit-sliced ones
+template <typename Lane>
+double measure_alu_evals(int iters) {
+    Wires<8, Lane> a = {}, b = {};
+    Lane op0 = LaneTraits<Lane>::zeros(), op1 = LaneTraits<Lane>::zeros();
+    ALU<8, Lane> alu;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < iters; n++) {
+        alu.compute(a, b, op0, op1);
+        // Feed results back so nothing is loop-invariant
+        a = alu.result;
+        Lane bit = b[n & 7];
+        b[n & 7] = bit ^ alu.carry;
+        op0 = op0 ^ alu.zero;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    volatile Lane sink = alu.result[0];
+    (void)sink;
+    double secs = std::chrono::duration<double>(end - start).count();
+    return double(iters) * LaneTraits<Lane>::WIDTH / secs;
+}
+
+// The 8-bit ALU three ways: the component template, the captured
+// netlist's eval loop, and the generated straight-line function.
+// Inputs come from an LCG so no evaluation can be hoisted.
+template <typename Lane>
+struct AluNetBench {
+    static constexpr int IN = 18, OUT = 10;
+    Lane in[IN], out[OUT];
+    uint64_t seed = 1;
+
+    void next_inputs() {
+        for (Lane& x : in) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            x = Lane(seed >> 11);
+        }
+    }
+
+    template <typename F>
+    double evals_per_sec(int iters, F&& evaluate) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t sink = 0;
+        for (int n = 0; n < iters; n++) {
+            next_inputs();
+            evaluate(in, out);
+            sink += uint64_t(out[n % OUT]);
+        }
+        auto end = std::chrono::steady_clock::now();
+        volatile uint64_t keep = sink;
+        (void)keep;
+        return iters / std::chrono::duration<double>(end - start).count();
+    }
+};
+
+struct NetlistResult {
+    size_t gates;
+    int depth;
+    struct Row { const char* name; double gates_per_sec; } rows[3];
+};
+
+NetlistResult netlist_bench(int iters) {
+    Netlist net = alu_netlist<8>();
+    std::vector<uint64_t> wires(net.num_wires());
+
+    auto via_template = [](const auto* in, auto* out) {
+        using Lane = std::remove_const_t<std::remove_pointer_t<decltype(in)>>;
+        Wires<8, Lane> a, b;
+        for (int i = 0; i < 8; i++) { a[i] = in[i]; b[i] = in[8 + i]; }
+        ALU<8, Lane> alu;
+        alu.compute(a, b, in[16], in[17]);
+        for (int i = 0; i < 8; i++) out[i] = alu.result[i];
+        out[8] = alu.carry;
+        out[9] = alu.zero;
+    };
+
+    AluNetBench<uint64_t> b64;
+    double per_eval = double(net.gate_count()) * 64;
+    return {net.gate_count(), net.depth, {
+        {"template", per_eval * b64.evals_per_sec(iters, via_template)},
+        {"netlist", per_eval * b64.evals_per_sec(iters, [&](const uint64_t* in, uint64_t* out) {
+            net.eval(in, out, wires.data());
+        })},
+        {"generated", per_eval * b64.evals_per_sec(iters, alu8_net<uint64_t>)},
+    }};
+}
+
+// Each 16-bit adder: simulated hardware cost (gates, depth from its
+// netlist) next to host cost (additions per second on bool wires)
+struct AdderResult {
+    const char* name;
+    size_t gates;
+    int depth;
+    double adds_per_sec;
+};
+
+template <template <int, typename> class Adder>
+AdderResult adder_row(int iters) {
+    Netlist net = adder_netlist<16, Adder>();
+    Adder<16, bool> adder;
+    Bits<16> a(0x1234), b(0x0F0F);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < iters; n++) {
+        adder.add(a, b, n & 1);
+        a = adder.sum;   // feed back so nothing is loop-invariant
+    }
+    auto end = std::chrono::steady_clock::now();
+    volatile int sink = adder.to_int();
+    (void)sink;
+
+    double adds = iters / std::chrono::duration<double>(end - start).count();
+    return {Adder<16, bool>::NAME, net.gate_count(), net.depth, adds};
+}
+
+// --- SMP ---
+
+// Instructions per second summed over `n` FastCPU cores all running the
+// ALU loop, which touches no memory, so the cores never contend
+struct SmpResult {
+    int cores;
+    double lockstep;
+    double parallel;
+};
+
+SmpResult smp_row(int n, double budget) {
+    auto ips = [&](bool parallel) {
+        SmpComputer c(n, CoreType::Fast);
+        c.set_quantum(100000);
+        std::vector<uint8_t> prog = arith_program();
+        c.load_program(prog.data(), prog.size());
+        auto begin = std::chrono::steady_clock::now();
+        double secs = 0;
+        do {
+            if (parallel) c.run_parallel(10000000);
+            else c.run(10000000);
+            secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        } while (secs < budget);
+        uint64_t steps = 0;
+        for (int i = 0; i < n; i++) steps += c.get_step_count(i);
+        return steps / secs;
+    };
+    return {n, ips(false), ips(true)};
+}
+
+// --- Report ---
+
+struct CoreRow { CoreType type; const char* name; };
+const CoreRow cores[] = {
+    {CoreType::Gate,     "gate"},
+    {CoreType::Fast,     "fast"},
+    {CoreType::Threaded, "threaded"},
+    {CoreType::Jit,      "jit"},
+};
+constexpr int NUM_CORES = sizeof(cores) / sizeof(cores[0]);
+constexpr int NUM_WORKLOADS = sizeof(workloads) / sizeof(workloads[0]);
+
+// Plain JSON number (no locale, no inf/nan)
+std::string num(double x) {
+    if (!(x == x) || x > 1e300 || x < -1e300) return "null";
+    std::ostringstream os;
+    os << std::setprecision(6) << x;
+    return os.str();
+}
+
+int main(int argc, char** argv) {
+    bool json = false, quick = false;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--json")) json = true;
+        else if (!std::strcmp(argv[i], "--quick")) quick = true;
+        else {
+            std::cerr << "usage: " << argv[0] << " [--json] [--quick]\n";
+            return 2;
+        }
+    }
+    const double budget = quick ? 0.1 : 0.5;
+    const int iters = quick ? 200000 : 2000000;
+
+    std::array<double, NUM_CLASSES> mixes[NUM_WORKLOADS];
+    RunResult runs[NUM_WORKLOADS][NUM_CORES];
+    for (int w = 0; w < NUM_WORKLOADS; w++) {
+        mixes[w] = instruction_mix(workloads[w], 100000);
+        for (int k = 0; k < NUM_CORES; k++) runs[w][k] = run_isolated(cores[k].type, workloads[w], budget);
+    }
+
+    double scalar = measure_alu_evals<bool>(iters);
+    double sliced = measure_alu_evals<uint64_t>(iters);
+#if defined(__AVX2__)
+    // The widest lane the build targets
+#if defined(__AVX512F__)
+    using WideLane = Lane512;
+#else
+    using WideLane = Lane256;
+#endif
+    const int wide_lanes = LaneTraits<WideLane>::WIDTH;
+    double wide = measure_alu_evals<WideLane>(iters);
+#endif
+    NetlistResult net = netlist_bench(iters);
+    const AdderResult adders[] = {
+        adder_row<RippleCarryAdder>(iters),
+        adder_row<CarryLookaheadAdder>(iters),
+        adder_row<KoggeStoneAdder>(iters),
+        adder_row<BrentKungAdder>(iters),
+    };
+    const SmpResult smp[] = {smp_row(1, budget), smp_row(2, budget), smp_row(4, budget)};
+
+    if (json) {
+        std::cout << "{\n  \"workloads\": [\n";
+        for (int w = 0; w < NUM_WORKLOADS; w++) {
+            std::cout << "    {\"name\": \"" << workloads[w].name << "\", \"class\": \""
+                      << class_names[workloads[w].stresses] << "\", \"mix\": {";
+            for (int k = 0; k < NUM_CLASSES; k++)
+                std::cout << (k ? ", " : "") << "\"" << class_names[k] << "\": " << num(mixes[w][k]);
+            std::cout << "},\n     \"cores\": [\n";
+            for (int k = 0; k < NUM_CORES; k++) {
+                const RunResult& r = runs[w][k];
+                std::cout << "       {\"core\": \"" << cores[k].name << "\", \"instructions\": " << r.steps
+                          << ", \"seconds\": " << num(r.secs)
+                          << ", \"instr_per_sec\": " << num(r.steps / r.secs)
+                          << ", \"ns_per_instr\": " << num(r.secs * 1e9 / r.steps)
+                          << ", \"peak_rss_kb\": " << r.peak_rss_kb << "}"
+                          << (k + 1 < NUM_CORES ? ",\n" : "\n");
+            }
+            std::cout << "     ]}" << (w + 1 < NUM_WORKLOADS ? ",\n" : "\n");
+        }
+        std::cout << "  ],\n  \"alu_evals_per_sec\": {\"bool\": " << num(scalar)
+                  << ", \"lanes64\": " << num(sliced)
+#if defined(__AVX2__)
+                  << ", \"lanes" << wide_lanes << "\": " << num(wide)
+#endif
+                  << "},\n"
+                  << "  \"alu_netlist\": {\"gates\": " << net.gates << ", \"depth\": " << net.depth
+                  << ", \"gates_per_sec\": {";
+        for (int i = 0; i < 3; i++)
+            std::cout << (i ? ", " : "") << "\"" << net.rows[i].name << "\": " << num(net.rows[i].gates_per_sec);
+        std::cout << "}},\n  \"adders16\": [\n";
+        for (int i = 0; i < 4; i++)
+            std::cout << "    {\"name\": \"" << adders[i].name << "\", \"gates\": " << adders[i].gates
+                      << ", \"depth\": " << adders[i].depth << ", \"adds_per_sec\": " << num(adders[i].adds_per_sec)
+                      << "}" << (i < 3 ? ",\n" : "\n");
+        std::cout << "  ],\n  \"smp\": [\n";
+        for (int i = 0; i < 3; i++)
+            std::cout << "    {\"cores\": " << smp[i].cores << ", \"lockstep_instr_per_sec\": " << num(smp[i].lockstep)
+                      << ", \"parallel_instr_per_sec\": " << num(smp[i].parallel) << "}" << (i < 2 ? ",\n" : "\n");
+        std::cout << "  ]\n}\n";
+        return 0;
+    }
+
+    std::cout << "=== guest workloads ===\n\n"
+              << std::left << std::setw(11) << "workload" << std::setw(8) << "class" << std::right
+              << std::setw(6) << "mix" << "  " << std::left << std::setw(10) << "core" << std::right
+              << std::setw(14) << "instr/s" << std::setw(10) << "ns/instr" << std::setw(10) << "RSS KB"
+              << std::setw(10) << "vs gate" << "\n";
+    for (int w = 0; w < NUM_WORKLOADS; w++) {
+        const Workload& wl = workloads[w];
+        double gate_ips = runs[w][0].steps / runs[w][0].secs;
+        for (int k = 0; k < NUM_CORES; k++) {
+            const RunResult& r = runs[w][k];
+            double ips = r.steps / r.secs;
+            if (k == 0) {
+                std::cout << std::left << std::setw(11) << wl.name << std::setw(8) << class_names[wl.stresses]
+                          << std::right << std::setw(5) << std::fixed << std::setprecision(0)
+                          << mixes[w][wl.stresses] * 100 << "%";
+            } else {
+                std::cout << std::setw(25) << "";
+            }
+            std::cout << "  " << std::left << std::setw(10) << cores[k].name << std::right
+                      << std::setw(14) << std::setprecision(0) << ips
+                      << std::setw(10) << std::setprecision(2) << 1e9 / ips
+                      << std::setw(10) << r.peak_rss_kb
+                      << std::setw(9) << std::setprecision(1) << ips / gate_ips << "x\n";
+        }
+    }
+
+    std::cout << "\n=== gate-level ALU, bool vs bit-sliced ===\n\n"
+              << std::left << std::setw(10) << "bool"
+              << std::right << std::setw(14) << std::setprecision(0) << scalar << " ALU ops/s\n"
+              << std::left << std::setw(10) << "64-lane"
+              << std::right << std::setw(14) << sliced << " ALU ops/s"
+              << std::setw(10) << std::setprecision(1) << sliced / scalar << "x bool\n";
+#if defined(__AVX2__)
+    std::cout << std::left << std::setw(10) << std::to_string(wide_lanes) + "-lane"
+              << std::right << std::setw(14) << std::setprecision(0) << wide << " ALU ops/s"
+              << std::setw(10) << std::setprecision(1) << wide / scalar << "x bool\n";
+#endif
+
+    std::cout << "\n=== ALU<8> netlist (" << net.gates << " gates, depth " << net.depth
+              << "), 64 lanes ===\n\n";
+    for (const NetlistResult::Row& r : net.rows) {
+        std::cout << std::left << std::setw(10) << r.name
+                  << std::right << std::setw(14) << std::setprecision(0) << r.gates_per_sec << " gates/s"
+                  << std::setw(10) << std::setprecision(1) << r.gates_per_sec / net.rows[0].gates_per_sec
+                  << "x template\n";
+    }
+
+    std::cout << "\n=== 16-bit adders ===\n\n"
+              << std::left << std::setw(13) << "adder" << std::right << std::setw(7) << "gates"
+              << std::setw(7) << "depth" << "\n";
+    for (const AdderResult& a : adders) {
+        std::cout << std::left << std::setw(13) << a.name
+                  << std::right << std::setw(7) << a.gates << std::setw(7) << a.depth
+                  << std::setw(14) << std::setprecision(0) << a.adds_per_sec << " adds/s\n";
+    }
+
+    std::cout << "\n=== SMP, ALU loop on FastCPU cores (" << std::thread::hardware_concurrency()
+              << " host threads) ===\n\n"
+              << std::left << std::setw(7) << "cores" << std::right << std::setw(14) << "lockstep"
+              << std::setw(14) << "parallel" << "\n";
+    for (const SmpResult& r : smp) {
+        std::cout << std::left << std::setw(7) << r.cores << std::right
+                  << std::setw(14) << std::setprecision(0) << r.lockstep
+                  << std::setw(14) << r.parallel << " instr/s"
+                  << std::setw(8) << std::setprecision(1) << r.parallel / r.lockstep << "x\n";
+    }
+    return 0;
+}
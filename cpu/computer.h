@@ -1,61 +1,354 @@
 #pragma once
 #include "cpu.h"
+#include "fast_cpu.h"
+#include "threaded_cpu.h"
+#include "jit_cpu.h"
+#include "cycles.h"
+#include "trace.h"
 #include "../memory/bus.h"
+#include "../memory/bank_mapper.h"
 #include "../devices/timer.h"
 #include "../devices/uart.h"
+#include "../devices/dma.h"
+#include "../devices/interrupt_controller.h"
+#include "../devices/scheduler.h"
 #include <cstdint>
 #include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#if SEEDISA_GATE_PROFILE
+#include <iostream>
+#endif
+
+// Which execution core a Computer is built with.
+//   Gate     — the gate-level CPU (reference model, slow)
+//   Fast     — FastCPU, same ISA on native integers
+//   Threaded — FastCPU state driven by a threaded-code dispatch loop
+//   Jit      — FastCPU state, basic blocks translated to x86-64
+//              (interprets where that isn't available)
+enum class CoreType { Gate, Fast, Threaded, Jit };
+
+// Why Computer::run() returned.
+//   Budget     — ran the steps or cycles it was given
+//   Halted     — the CPU executed HLT
+//   Breakpoint — the next instruction is at a breakpoint
+//   Watchpoint — the last step made a watched access (Bus::get_watch_hit)
+enum class StopReason { Budget, Halted, Breakpoint, Watchpoint };
 
 // Computer — the top-level system.
-// Owns Bus, CPU, Timer, and UART. Wires them together.
+// Owns Bus, CPU, Timer, UART, DMA, the interrupt controller and the bank
+// mapper. Wires them together.
 //
-// I/O address map (offsets from 0xF000):
-//   0x00-0x01  Timer (reload, control)
-//   0x02-0x03  UART  (data, status)
+// I/O address map:
+//   0xF000-0xF001  Timer (reload, control)
+//   0xF002-0xF003  UART  (data, status)
+//   0xF008-0xF00F  DMA   (source, destination, length, fill, control)
+//   0xF020-0xF02E  Bank mapper (frame for each 4 KB window of RAM)
+//   0xF030-0xF03B  Interrupt controller (control, mask, in service, pending, priorities)
 
 class Computer {
 public:
-    Computer() : cpu(bus), timer(cpu), uart(cpu) {
-        cpu.reset();
-        bus.attach_io(
-            [this](uint32_t addr) -> uint8_t {
-                if (addr < 2) return timer.read_reg(addr);
-                if (addr < 4) return uart.read_reg(addr - 2);
-                return 0;
-            },
-            [this](uint32_t addr, uint8_t val) {
-                if (addr < 2) timer.write_reg(addr, val);
-                else if (addr < 4) uart.write_reg(addr - 2, val);
-            }
-        );
+    static constexpr uint32_t TIMER_BASE = 0xF000;
+    static constexpr uint32_t UART_BASE  = 0xF002;
+    static constexpr uint32_t DMA_BASE   = 0xF008;
+    static constexpr uint32_t BANK_BASE  = 0xF020;
+    static constexpr uint32_t INTC_BASE  = 0xF030;
+
+    Computer(CoreType type = CoreType::Gate)
+        : core_type(type), cpu(make_core(type, bus)), timer(*cpu), uart(*cpu), dma(bus, *cpu),
+          intc(*cpu, steps, cycles), banks(bus) {
+        cpu->reset();
+        bus.map_device(TIMER_BASE, 2, timer);
+        bus.map_device(UART_BASE, 2, uart);
+        bus.map_device(DMA_BASE, 8, dma);
+        bus.map_device(BANK_BASE, Bus::NUM_WINDOWS, banks);
+        bus.map_device(INTC_BASE, 4 + MAX_INTERRUPTS, intc);
+        sched.add(timer);
+        sched.add(dma);
     }
 
     void load_program(const uint8_t* data, size_t length, uint32_t addr = 0) {
         bus.load(addr, data, length);
     }
 
-    void run(int max_cycles = 10000) {
-        while (!cpu.is_halted() && max_cycles-- > 0) {
-            timer.tick();
-            cpu.step();
-        }
+    // Run up to max_steps steps
+    StopReason run(int max_steps = 10000) {
+        return run_for(max_steps > 0 ? uint64_t(max_steps) : 0, UINT64_MAX);
+    }
+
+    // Run until at least max_cycles cycles have passed (the last step
+    // may end past them)
+    StopReason run_cycles(uint64_t max_cycles) {
+        return run_for(UINT64_MAX, max_cycles);
     }
 
     void step() {
-        timer.tick();
-        cpu.step();
+        if (tracer) return trace_step();
+        step_core(*cpu);
     }
 
-    void reset() { cpu.reset(); }
+    // A new Computer in this one's state, with the same core type. RAM
+    // is shared copy-on-write, so this costs about as much as a fresh
+    // Computer however much memory is in use, and each side then pays
+    // only for the pages it writes. Copies the CPU's architectural
+    // state, the timer, the UART buffers, the DMA, the interrupt
+    // controller's registers, the bank windows, the cycle costs and the
+    // step and cycle counts. It doesn't copy devices mapped with
+    // map_device() after construction, latency histograms, or any
+    // cached decoded/translated code, which the child rebuilds.
+    std::unique_ptr<Computer> fork() {
+        auto child = std::make_unique<Computer>(core_type);
+        child->bus.share_memory(bus);
+        child->cpu->set_state(cpu->get_state());
+        child->timer.set_state(timer.get_state());
+        child->uart.set_state(uart.get_state());
+        child->dma.set_state(dma.get_state());
+        child->intc.set_state(intc.get_state());
+        child->set_cycle_costs(cycle_table.get_costs());
+        child->steps = steps;
+        child->cycles = cycles;
+        return child;
+    }
+
+    void reset() { cpu->reset(); }
+
+    // --- Tracing ---
+    //
+    // While a Tracer is set, every step records a TraceRecord into it
+    // (null: stop). Like debugging, tracing runs one instruction at a
+    // time, and the bus logs writes only while it's on.
+    void set_tracer(Tracer* t) {
+        tracer = t;
+        bus.set_write_log(t ? &trace_writes : nullptr);
+    }
+
+    // --- Breakpoints ---
+    //
+    // run() stops before executing an instruction at a breakpoint, but
+    // never before the first step of a call, so calling run() again
+    // carries on past it. While any breakpoint or watchpoint is set,
+    // run() steps every core one instruction at a time; with none set
+    // it runs exactly as it would without them.
+
+    void add_breakpoint(uint16_t pc) {
+        if (breakpoints.empty()) breakpoints.assign(0x10000, false);
+        if (!breakpoints[pc]) num_breakpoints++;
+        breakpoints[pc] = true;
+    }
 
-    CPU& get_cpu() { return cpu; }
+    void remove_breakpoint(uint16_t pc) {
+        if (breakpoints.empty() || !breakpoints[pc]) return;
+        breakpoints[pc] = false;
+        num_breakpoints--;
+    }
+
+    void clear_breakpoints() {
+        breakpoints.clear();
+        num_breakpoints = 0;
+    }
+
+    // Steps run so far: one per step() and per step run() executes (not
+    // cleared by reset). Host events logged against it replay exactly.
+    uint64_t get_step_count() const { return steps; }
+
+    // --- Cycles ---
+    //
+    // Every step takes some number of cycles (see CycleCosts), and the
+    // timer counts cycles, not steps. By default each step is one cycle.
+    // The cycle count only ever grows, like the step count.
+
+    void set_cycle_costs(const CycleCosts& c) {
+        cycle_table = CycleTable(c);
+        cpu->set_cycle_table(cycle_table);
+    }
+
+    const CycleCosts& get_cycle_costs() const { return cycle_table.get_costs(); }
+    uint64_t get_cycle_count() const { return cycles; }
+
+    CoreType get_core_type() const { return core_type; }
+
+    // A core of the given type on `bus`
+    static std::unique_ptr<Core> make_core(CoreType type, Bus& bus) {
+        if (type == CoreType::Jit) return std::make_unique<JitCPU>(bus);
+        if (type == CoreType::Threaded) return std::make_unique<ThreadedCPU>(bus);
+        if (type == CoreType::Fast) return std::make_unique<FastCPU>(bus);
+        return std::make_unique<CPU>(bus);
+    }
+
+    Core& get_cpu() { return *cpu; }
     Bus& get_bus() { return bus; }
     Timer& get_timer() { return timer; }
     UART& get_uart() { return uart; }
+    DMA& get_dma() { return dma; }
+    InterruptController& get_intc() { return intc; }
+    BankMapper& get_banks() { return banks; }
 
 private:
     Bus bus;
-    CPU cpu;
+    CoreType core_type;
+    std::unique_ptr<Core> cpu;
     Timer timer;
     UART uart;
+    DMA dma;
+    uint64_t steps = 0;    // kept current through runs: the controller
+    uint64_t cycles = 0;   // times interrupts by them
+    InterruptController intc;
+    BankMapper banks;
+    Scheduler sched;   // clocked devices: the timer and the DMA
+    CycleTable cycle_table;
+    std::vector<bool> breakpoints;   // per PC, empty until first used
+    uint32_t num_breakpoints = 0;
+    Tracer* tracer = nullptr;
+    std::vector<Bus::LoggedWrite> trace_writes;   // this step's writes, while tracing
+
+    StopReason run_for(uint64_t max_steps, uint64_t max_cycles) {
+        if (num_breakpoints > 0 || bus.has_watchpoints() || tracer) return run_debug(max_steps, max_cycles);
+        // Resolve the core once so the hot loop calls step() directly
+        if (core_type == CoreType::Jit) run_batched(static_cast<JitCPU&>(*cpu), max_steps, max_cycles);
+        else if (core_type == CoreType::Threaded) run_batched(static_cast<ThreadedCPU&>(*cpu), max_steps, max_cycles);
+        else if (core_type == CoreType::Fast) run_batched(static_cast<FastCPU&>(*cpu), max_steps, max_cycles);
+        else run_loop(static_cast<CPU&>(*cpu), max_steps, max_cycles);
+#if SEEDISA_GATE_PROFILE
+        if (core_type == CoreType::Gate) GateProfile::get().report(std::clog);
+#endif
+        return cpu->is_halted() ? StopReason::Halted : StopReason::Budget;
+    }
+
+    // One step, then the devices catch up by the cycles it took (so an
+    // interrupt they raise is taken on the next step)
+    template <typename C>
+    void step_core(C& core) {
+        core.step();
+        uint32_t c = core.step_cycles();
+        steps++;
+        cycles += c;
+        sched.advance(c);
+    }
+
+    // The interrupt the next step takes, or -1
+    int next_interrupt(const CoreState& s) const {
+        return s.int_enabled && s.int_pending ? intc.select(s.int_pending) : -1;
+    }
+
+    // Cycles the run loops can let pass before looking at the devices
+    // again: up to the step that makes the next device event happen,
+    // without going past either limit. The budget is kept well below
+    // UINT32_MAX so one step more can't overflow a count.
+    uint32_t batch_budget(uint64_t steps_left, uint64_t cycles_left) {
+        uint64_t b = std::min<uint64_t>(cycles_left, uint64_t(sched.quiet_ticks()) + 1);
+        if (steps_left < (uint64_t(1) << 32)) b = std::min<uint64_t>(b, steps_left * cycle_table.min);
+        return uint32_t(std::min<uint64_t>(b, 1u << 30));
+    }
+
+    // One step at a time, skipping idle stretches (see spinning)
+    template <typename C>
+    void run_loop(C& core, uint64_t max_steps, uint64_t max_cycles) {
+        const uint64_t first_step = steps, first_cycle = cycles;
+        while (steps - first_step < max_steps && cycles - first_cycle < max_cycles && !core.is_halted()) {
+            if (uint32_t c = spinning()) {
+                uint32_t k = (batch_budget(max_steps - (steps - first_step), max_cycles - (cycles - first_cycle)) + c - 1) / c;
+                steps += k;
+                cycles += uint64_t(k) * c;
+                sched.advance(k * c);
+                continue;
+            }
+            step_core(core);
+        }
+    }
+
+    // The guest is waiting for an interrupt: it's on a branch to itself
+    // that will be taken (JMP, or JZ/JNZ on the zero flag as it stands)
+    // and no interrupt can be taken. Each step until a device raises one
+    // changes nothing but the time, so the run loops let all those steps
+    // pass at once, straight to the next deadline. Returns the cycles
+    // one time round the loop takes, or 0 if the guest isn't spinning.
+    uint32_t spinning() {
+        uint16_t pc = cpu->get_pc();
+        if (pc + 2u >= Bus::IO_BASE) return 0;   // fetching would read device registers
+        uint8_t b[3];
+        bus.fetch(pc, b, 3);
+        if ((b[0] | b[1] << 8) != pc) return 0;
+        uint8_t op = b[2] >> 4;
+        bool taken = op == 0xA || (op == 0xB && cpu->get_zero()) || (op == 0xC && !cpu->get_zero());
+        if (!taken) return 0;
+        return next_interrupt(cpu->get_state()) >= 0 ? 0 : cycle_table.inst[b[2]];
+    }
+
+    void trace_step() {
+        CoreState before = cpu->get_state();
+        if (before.halted) return step_core(*cpu);
+        TraceRecord r;
+        r.pc = before.pc;
+        int irq = next_interrupt(before);
+        if (irq >= 0) {
+            r.kind = TraceRecord::INTERRUPT;
+            r.inst[0] = uint8_t(irq);
+        } else {
+            bus.fetch(before.pc, r.inst, 3);
+        }
+        // step_core, with the devices catching up outside the log: what
+        // they write isn't this instruction's doing
+        trace_writes.clear();
+        cpu->step();
+        uint32_t c = cpu->step_cycles();
+        steps++;
+        cycles += c;
+        bus.pause_write_log();
+        sched.advance(c);
+        bus.resume_write_log();
+
+        CoreState after = cpu->get_state();
+        for (int i = 0; i < 4; i++) {
+            r.regs[i] = after.regs[i];
+            if (after.regs[i] != before.regs[i]) r.regs_changed |= 1 << i;
+        }
+        r.flags = after.zero | after.carry << 1 | after.int_enabled << 2 | after.halted << 3;
+        r.sp = after.sp;
+        if (!trace_writes.empty()) r.mem_addr = trace_writes[0].addr;
+        r.mem_len = uint8_t(std::min<size_t>(trace_writes.size(), 3));
+        for (uint8_t i = 0; i < r.mem_len; i++) r.mem[i] = trace_writes[i].value;
+        tracer->record(r);
+    }
+
+    // One step at a time, whatever the core: check for a breakpoint
+    // before each step and a watchpoint hit after it
+    StopReason run_debug(uint64_t max_steps, uint64_t max_cycles) {
+        bus.clear_watch_hit();
+        uint64_t start = cycles;
+        for (uint64_t n = 0; n < max_steps && cycles - start < max_cycles; n++) {
+            if (cpu->is_halted()) return StopReason::Halted;
+            if (n > 0 && num_breakpoints > 0 && breakpoints[cpu->get_pc()]) return StopReason::Breakpoint;
+            step();
+            if (bus.has_watch_hit()) return StopReason::Watchpoint;
+        }
+        return cpu->is_halted() ? StopReason::Halted : StopReason::Budget;
+    }
+
+    // Same result as run_loop, without the per-step device update and
+    // halt check: let the core run until the scheduler's next deadline,
+    // then catch the devices up in one go. Whatever ends a batch early
+    // (I/O, a pending interrupt) gets one ordinary step. A spinning guest
+    // skips the batch: the steps just pass.
+    template <typename C>
+    void run_batched(C& core, uint64_t max_steps, uint64_t max_cycles) {
+        const uint64_t first_step = steps, first_cycle = cycles;
+        while (steps - first_step < max_steps && cycles - first_cycle < max_cycles && !core.is_halted()) {
+            uint32_t budget = batch_budget(max_steps - (steps - first_step), max_cycles - (cycles - first_cycle));
+            uint32_t spent = 0, done;
+            if (uint32_t c = spinning()) {
+                done = (budget + c - 1) / c;
+                spent = done * c;
+            } else {
+                done = core.run_batch(budget, spent);
+            }
+            steps += done;
+            cycles += spent;
+            sched.advance(spent);
+            if (spent < budget) {
+                if (core.is_halted() || steps - first_step >= max_steps) break;
+                step_core(core);
+            }
+        }
+    }
 };
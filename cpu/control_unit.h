@@ -18,21 +18,24 @@
 // io_write:    output a register value to the I/O bus
 // is_mov:      register write data comes from Rs (register-to-register copy)
 
-struct ControlSignals {
-    bool reg_write    = false;
-    bool mem_read     = false;
-    bool mem_write    = false;
-    bool alu_op0      = false;
-    bool alu_op1      = false;
-    bool alu_src_imm  = false;
-    bool reg_src_mem  = false;
-    bool reg_src_imm  = false;
-    bool pc_jump      = false;
-    bool flags_write  = false;
-    bool halt         = false;
-    bool is_mov       = false;
+template <typename Lane>
+struct BasicControlSignals {
+    Lane reg_write    = LaneTraits<Lane>::zeros();
+    Lane mem_read     = LaneTraits<Lane>::zeros();
+    Lane mem_write    = LaneTraits<Lane>::zeros();
+    Lane alu_op0      = LaneTraits<Lane>::zeros();
+    Lane alu_op1      = LaneTraits<Lane>::zeros();
+    Lane alu_src_imm  = LaneTraits<Lane>::zeros();
+    Lane reg_src_mem  = LaneTraits<Lane>::zeros();
+    Lane reg_src_imm  = LaneTraits<Lane>::zeros();
+    Lane pc_jump      = LaneTraits<Lane>::zeros();
+    Lane flags_write  = LaneTraits<Lane>::zeros();
+    Lane halt         = LaneTraits<Lane>::zeros();
+    Lane is_mov       = LaneTraits<Lane>::zeros();
 };
 
+using ControlSignals = BasicControlSignals<bool>;
+
 // ControlUnit — the CPU's "brain". Pure combinational logic.
 //
 // Takes the 4-bit opcode and current flags, produces all the
@@ -45,30 +48,31 @@ struct ControlSignals {
 //      (e.g., reg_write is high for LDI, LD, ADD, SUB, AND, OR, MOV, ADDI)
 //   3. Conditional jumps AND the opcode line with the relevant flag
 
-class ControlUnit {
+template <typename Lane>
+class BasicControlUnit {
 public:
-    ControlSignals signals = {};
+    BasicControlSignals<Lane> signals = {};
 
-    void decode(const std::array<bool, 4>& opcode, bool zero_flag) {
+    void decode(const Wires<4, Lane>& opcode, Lane zero_flag) {
         dec.decode(opcode);
 
         // Give each decoder output a readable name
-        bool nop  = dec.outputs[0x0];
-        bool ldi  = dec.outputs[0x1];
-        bool ld   = dec.outputs[0x2];
-        bool st   = dec.outputs[0x3];
-        bool add  = dec.outputs[0x4];
-        bool sub  = dec.outputs[0x5];
-        bool and_ = dec.outputs[0x6];
-        bool or_  = dec.outputs[0x7];
-        bool mov  = dec.outputs[0x8];
-        bool cmp  = dec.outputs[0x9];
-        bool jmp  = dec.outputs[0xA];
-        bool jz   = dec.outputs[0xB];
-        bool jnz  = dec.outputs[0xC];
-        bool addi = dec.outputs[0xD];
-        bool call = dec.outputs[0xE];
-        bool hlt  = dec.outputs[0xF];
+        Lane nop  = dec.outputs[0x0];
+        Lane ldi  = dec.outputs[0x1];
+        Lane ld   = dec.outputs[0x2];
+        Lane st   = dec.outputs[0x3];
+        Lane add  = dec.outputs[0x4];
+        Lane sub  = dec.outputs[0x5];
+        Lane and_ = dec.outputs[0x6];
+        Lane or_  = dec.outputs[0x7];
+        Lane mov  = dec.outputs[0x8];
+        Lane cmp  = dec.outputs[0x9];
+        Lane jmp  = dec.outputs[0xA];
+        Lane jz   = dec.outputs[0xB];
+        Lane jnz  = dec.outputs[0xC];
+        Lane addi = dec.outputs[0xD];
+        Lane call = dec.outputs[0xE];
+        Lane hlt  = dec.outputs[0xF];
 
         (void)nop;   // NOP (and PUSH/POP/RET) handled directly in CPU
         (void)call;  // CALL handled directly in CPU
@@ -108,5 +112,7 @@ public:
     }
 
 private:
-    Decoder<4> dec;
+    Decoder<4, Lane> dec;
 };
+
+using ControlUnit = BasicControlUnit<bool>;
@@ -0,0 +1,95 @@
+#pragma once
+#include "cycles.h"
+#include <cstdint>
+
+static constexpr uint16_t IVT_BASE = 0xEFF0;
+static constexpr int MAX_INTERRUPTS = 8;
+
+// CoreState — a core's architectural state: everything a program can
+// observe or depend on, and nothing about how a core implements it.
+// The same state loaded into any core continues the same program.
+struct CoreState {
+    uint8_t regs[4] = {};
+    uint16_t pc = 0;
+    uint16_t sp = 0xEFFF;
+    bool zero = false;
+    bool carry = false;
+    bool int_enabled = false;
+    bool halted = false;
+    uint8_t int_pending = 0;   // bit n: interrupt n raised, not yet taken
+};
+
+// InterruptRouter — decides which pending interrupt a core takes.
+//
+// A core without one takes the lowest-numbered pending interrupt. With
+// one, it asks select() whenever interrupts are enabled and something
+// is pending, and takes nothing if that says -1. raised() hears about
+// each line going from clear to pending, taken() about each handler
+// the core enters for a line (not SWI).
+class InterruptRouter {
+public:
+    virtual ~InterruptRouter() = default;
+
+    virtual void raised(uint8_t line) = 0;
+    virtual int select(uint8_t pending) const = 0;   // pending is nonzero
+    virtual void taken(uint8_t line) = 0;
+};
+
+// Core — what the rest of the system sees of a CPU.
+//
+// Devices only need raise_interrupt(); the Computer and test harness
+// need step() and a look at the architectural state. Both the gate-level
+// CPU and the native-integer FastCPU implement this, so the same Bus,
+// Timer and UART work with either one.
+//
+// Each step() also records how many cycles it took, by the CycleTable
+// the core was given (one cycle per step until then).
+
+class Core {
+public:
+    virtual ~Core() = default;
+
+    virtual void reset() = 0;
+    virtual void step() = 0;
+    virtual bool is_halted() const = 0;
+    virtual void raise_interrupt(uint8_t num) = 0;
+
+    virtual uint8_t get_reg(int i) const = 0;
+    virtual uint16_t get_pc() const = 0;
+    virtual bool get_zero() const = 0;
+    virtual bool get_carry() const = 0;
+    virtual uint16_t get_sp() const = 0;
+    virtual bool get_int_enabled() const = 0;
+
+    // Whole-state copy, for forks and snapshots
+    virtual CoreState get_state() const = 0;
+    virtual void set_state(const CoreState& s) = 0;
+
+    // Cycle costs to charge steps by. The table must outlive the core.
+    // Cores that keep translated code override this to drop it.
+    virtual void set_cycle_table(const CycleTable& t) { cycles = &t; }
+
+    // Cycles the last step() took
+    uint32_t step_cycles() const { return last_cycles; }
+
+    // Interrupt controller to consult (null: lowest line first). It must
+    // outlive the core.
+    void set_interrupt_router(InterruptRouter* r) { router = r; }
+
+protected:
+    const CycleTable* cycles = &CycleTable::uniform();
+    uint32_t last_cycles = 0;
+    InterruptRouter* router = nullptr;
+
+    // Mark `num` pending; tells the router if it wasn't already
+    void mark_pending(uint8_t& pending, uint8_t num) {
+        if (num >= MAX_INTERRUPTS || pending & (1 << num)) return;
+        pending |= 1 << num;
+        if (router) router->raised(num);
+    }
+
+    // The line to take out of `pending` (nonzero) now, or -1
+    int pick_interrupt(uint8_t pending) const {
+        return router ? router->select(pending) : __builtin_ctz(pending);
+    }
+};
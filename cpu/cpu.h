@@ -4,46 +4,14 @@
 #include "instruction_register.h"
 #include "flags.h"
 #include "control_unit.h"
+#include "core.h"
+#include "decode_cache.h"
 #include "../arithmetic/alu.h"
 #include "../arithmetic/mux.h"
 #include "../memory/bus.h"
 #include <array>
 #include <cstdint>
 
-inline std::array<bool, 8> to_bits8(uint8_t val) {
-    std::array<bool, 8> bits = {};
-    for (int i = 0; i < 8; i++) bits[i] = (val >> i) & 1;
-    return bits;
-}
-
-inline uint8_t from_bits8(const std::array<bool, 8>& bits) {
-    uint8_t val = 0;
-    for (int i = 0; i < 8; i++) if (bits[i]) val |= (1 << i);
-    return val;
-}
-
-inline std::array<bool, 16> to_bits16(uint16_t val) {
-    std::array<bool, 16> bits = {};
-    for (int i = 0; i < 16; i++) bits[i] = (val >> i) & 1;
-    return bits;
-}
-
-inline uint16_t from_bits16(const std::array<bool, 16>& bits) {
-    uint16_t val = 0;
-    for (int i = 0; i < 16; i++) if (bits[i]) val |= (1 << i);
-    return val;
-}
-
-template <size_t N>
-inline uint16_t bits_to_int(const std::array<bool, N>& bits) {
-    uint16_t val = 0;
-    for (size_t i = 0; i < N; i++) if (bits[i]) val |= (1 << i);
-    return val;
-}
-
-static constexpr uint16_t IVT_BASE = 0xEFF0;
-static constexpr int MAX_INTERRUPTS = 8;
-
 // 8-bit CPU with 16-bit address space and interrupt support.
 //
 // Opcode 0x0 sub-instructions:
@@ -52,12 +20,33 @@ static constexpr int MAX_INTERRUPTS = 8;
 //   Rs=2: POP Rd
 //   Rs=3: Rd=0 RET, Rd=1 SWI (imm8 = interrupt number)
 //         Rd=2 JC imm16 (jump if carry), Rd=3 JNC imm16 (jump if no carry)
+//
+// Decode cache: the first time a PC is fetched, the IR and control unit
+// run as usual and the result is kept in a DecodeCache. Later fetches of
+// the same PC skip the bus reads, IR clocks and control decode. Writes
+// through the Bus to cached code invalidate the affected entries.
+//
+// Built with -DSEEDISA_GATE_PROFILE=1, every gate call, latch update and
+// flip-flop clock is counted against the component doing the work and
+// the opcode being executed (gates/profile.h).
 
-class CPU {
+class CPU final : public Core {
 public:
-    CPU(Bus& bus) : bus(bus) {}
+    CPU(Bus& bus) : bus(bus) {
+        code_watch = bus.add_code_watcher([this](uint32_t addr) { icache.invalidate(addr); });
+        remap_watch = bus.add_remap_watcher([this](uint32_t, uint32_t) { icache.flush(); });
+    }
+
+    ~CPU() override {
+        bus.remove_watcher(code_watch);
+        bus.remove_watcher(remap_watch);
+    }
+
+    CPU(const CPU&) = delete;
+    CPU& operator=(const CPU&) = delete;
 
-    void reset() {
+    void reset() override {
+        icache.flush();
         pc.reset();
         sp = 0xEFFF;
         halted = false;
@@ -65,35 +54,71 @@ public:
         int_pending = 0;
     }
 
-    bool is_halted() const { return halted; }
+    bool is_halted() const override { return halted; }
 
-    void raise_interrupt(uint8_t num) {
-        if (num < MAX_INTERRUPTS) int_pending |= (1 << num);
+    void raise_interrupt(uint8_t num) override {
+        mark_pending(int_pending, num);
     }
 
-    void step() {
-        if (halted) return;
-        if (check_interrupts()) return;
-        fetch();
-        auto ctrl = decode();
-        execute(ctrl);
+    void step() override {
+        if (halted) { last_cycles = cycles->idle; return; }
+        SEEDISA_PROFILE_STEP();
+        if (check_interrupts()) {
+            SEEDISA_PROFILE_OPCODE(GateProfile::IRQ);
+            last_cycles = cycles->interrupt;
+            return;
+        }
+        DecodedInstruction inst = fetch();
+        SEEDISA_PROFILE_OPCODE(inst.opcode.to_int());
+        last_cycles = cycles->inst[inst.opcode.to_int() << 4 | inst.rd.to_int() << 2 | inst.rs.to_int()];
+        auto ctrl = decode(inst);
+        execute(inst, ctrl);
+    }
+
+    // On by default; turn off to clock every fetch through the IR
+    void set_decode_cache(bool enabled) {
+        decode_cache_enabled = enabled;
+        icache.flush();
     }
 
-    uint8_t get_reg(int i) const { return reg_file.get_reg(i); }
-    uint16_t get_pc() const { return pc.to_int(); }
-    bool get_zero() const { return flags.zero; }
-    bool get_carry() const { return flags.carry; }
-    uint16_t get_sp() const { return sp; }
-    bool get_int_enabled() const { return int_enabled; }
+    uint8_t get_reg(int i) const override { return reg_file.get_reg(i); }
+    uint16_t get_pc() const override { return pc.to_int(); }
+    bool get_zero() const override { return flags.zero; }
+    bool get_carry() const override { return flags.carry; }
+    uint16_t get_sp() const override { return sp; }
+    bool get_int_enabled() const override { return int_enabled; }
+
+    CoreState get_state() const override {
+        CoreState s;
+        for (int i = 0; i < 4; i++) s.regs[i] = reg_file.get_reg(i);
+        s.pc = pc.to_int(); s.sp = sp;
+        s.zero = flags.zero; s.carry = flags.carry;
+        s.int_enabled = int_enabled; s.halted = halted;
+        s.int_pending = int_pending;
+        return s;
+    }
+
+    // Clocks the values into the register file, PC and flag flip-flops
+    void set_state(const CoreState& s) override {
+        for (int i = 0; i < 4; i++) write_reg(Bits<2>(i), Bits<8>(s.regs[i]));
+        jump_to(Bits<16>(s.pc));
+        flags.unpack((s.zero ? 1 : 0) | (s.carry ? 2 : 0));
+        sp = s.sp;
+        int_enabled = s.int_enabled; halted = s.halted;
+        int_pending = s.int_pending;
+    }
 
 private:
     Bus& bus;
+    Bus::WatcherId code_watch, remap_watch;
     ProgramCounter pc;
     InstructionRegister ir;
     RegisterFile reg_file;
     ALU<8> alu;
     Flags flags;
     ControlUnit control;
+    DecodeCache icache;
+    bool decode_cache_enabled = true;
     bool halted = false;
     uint16_t sp = 0xEFFF;
     bool int_enabled = false;
@@ -103,43 +128,49 @@ private:
 
     bool check_interrupts() {
         if (!int_enabled || !int_pending) return false;
-        for (int i = 0; i < MAX_INTERRUPTS; i++) {
-            if (int_pending & (1 << i)) {
-                int_pending &= ~(1 << i);
-                enter_interrupt(i);
-                return true;
-            }
-        }
-        return false;
+        int num = pick_interrupt(int_pending);
+        if (num < 0) return false;
+        int_pending &= ~(1 << num);
+        if (router) router->taken(num);
+        enter_interrupt(num);
+        return true;
     }
 
     void enter_interrupt(uint8_t num) {
         // Pack interrupt-enable into flags byte (bit 2)
         uint8_t saved_flags = flags.pack() | (int_enabled ? 4 : 0);
-        push16(pc.to_int());
-        push_byte(saved_flags);
+        uint16_t ret_addr = pc.to_int();
+        const uint8_t frame[3] = {saved_flags, uint8_t(ret_addr & 0xFF), uint8_t(ret_addr >> 8)};
+        sp -= 3;
+        bus.write(sp, frame, 3);
         int_enabled = false;
-        uint16_t handler = bus.read_byte(IVT_BASE + num * 2)
-                         | (bus.read_byte(IVT_BASE + num * 2 + 1) << 8);
-        jump_to(to_bits16(handler));
+        jump_to(Bits<16>(bus.read_word(IVT_BASE + num * 2)));
     }
 
     void return_from_interrupt() {
-        uint8_t saved_flags = pop_byte();
-        uint16_t ret_addr = pop16();
-        flags.unpack(saved_flags);
+        uint8_t frame[3];
+        bus.read(sp, frame, 3);
+        sp += 3;
+        uint8_t saved_flags = frame[0];
+        uint16_t ret_addr = frame[1] | (frame[2] << 8);
+        {
+            SEEDISA_PROFILE_PART(Flags);
+            flags.unpack(saved_flags);
+        }
         int_enabled = (saved_flags >> 2) & 1;
-        jump_to(to_bits16(ret_addr));
+        jump_to(Bits<16>(ret_addr));
     }
 
     // --- Helpers ---
 
-    void jump_to(const std::array<bool, 16>& addr) {
+    void jump_to(const Bits<16>& addr) {
+        SEEDISA_PROFILE_PART(PC);
         pc.clock(false, true, addr);
         pc.clock(true, true, addr);
     }
 
-    void write_reg(const std::array<bool, 2>& sel, const std::array<bool, 8>& data) {
+    void write_reg(const Bits<2>& sel, const Bits<8>& data) {
+        SEEDISA_PROFILE_PART(RegisterFile);
         reg_file.write(false, sel, true, data);
         reg_file.write(true, sel, true, data);
     }
@@ -147,44 +178,71 @@ private:
     void push_byte(uint8_t val) { sp--; bus.write_byte(sp, val); }
     uint8_t pop_byte() { uint8_t v = bus.read_byte(sp); sp++; return v; }
 
-    void push16(uint16_t val) {
-        push_byte((val >> 8) & 0xFF);
-        push_byte(val & 0xFF);
-    }
-
-    uint16_t pop16() {
-        uint16_t lo = pop_byte();
-        uint16_t hi = pop_byte();
-        return (hi << 8) | lo;
-    }
+    // A pushed word sits little-endian at the new SP
+    void push16(uint16_t val) { sp -= 2; bus.write_word(sp, val); }
+    uint16_t pop16() { uint16_t v = bus.read_word(sp); sp += 2; return v; }
 
     // --- Fetch / Decode / Execute ---
 
-    void fetch() {
+    DecodedInstruction fetch() {
         uint16_t addr = pc.to_int();
-        auto b0 = to_bits8(bus.read_byte(addr));
-        auto b1 = to_bits8(bus.read_byte(addr + 1));
-        auto b2 = to_bits8(bus.read_byte(addr + 2));
-
-        ir.load_byte0(false, true, b0); ir.load_byte0(true, true, b0);
-        ir.load_byte1(false, true, b1); ir.load_byte1(true, true, b1);
-        ir.load_byte2(false, true, b2); ir.load_byte2(true, true, b2);
+        const DecodedInstruction* cached = decode_cache_enabled ? icache.lookup(addr) : nullptr;
+        DecodedInstruction inst = cached ? *cached : fetch_and_predecode(addr);
 
-        std::array<bool, 16> unused = {};
+        SEEDISA_PROFILE_PART(PC);
+        Bits<16> unused = {};
         pc.clock(false, false, unused);
         pc.clock(true, false, unused);
+        return inst;
+    }
+
+    // Cache miss: clock the three bytes into the IR and run the control
+    // unit once per zero-flag value so the entry serves either way.
+    DecodedInstruction fetch_and_predecode(uint16_t addr) {
+        uint8_t bytes[3];
+        bus.fetch(addr, bytes, 3);
+        auto b0 = Bits<8>(bytes[0]);
+        auto b1 = Bits<8>(bytes[1]);
+        auto b2 = Bits<8>(bytes[2]);
+
+        DecodedInstruction inst;
+        {
+            SEEDISA_PROFILE_PART(IR);
+            ir.load_byte0(false, true, b0); ir.load_byte0(true, true, b0);
+            ir.load_byte1(false, true, b1); ir.load_byte1(true, true, b1);
+            ir.load_byte2(false, true, b2); ir.load_byte2(true, true, b2);
+
+            inst.opcode = ir.opcode();
+            inst.rd = ir.rd();
+            inst.rs = ir.rs();
+            inst.imm16 = ir.imm16();
+        }
+        {
+            SEEDISA_PROFILE_PART(ControlUnit);
+            for (int z = 0; z < 2; z++) {
+                control.decode(inst.opcode, z);
+                inst.signals[z] = control.signals;
+            }
+        }
+
+        // I/O reads can change under us, so only RAM-resident code is cached
+        if (decode_cache_enabled && addr + 2u < Bus::IO_BASE) {
+            icache.insert(addr, inst);
+            bus.mark_code(addr, 3);
+        }
+        return inst;
     }
 
-    ControlSignals decode() {
-        control.decode(ir.opcode(), flags.zero);
-        reg_file.read(ir.rd(), ir.rs());
-        return control.signals;
+    ControlSignals decode(const DecodedInstruction& inst) {
+        SEEDISA_PROFILE_PART(RegisterFile);
+        reg_file.read(inst.rd, inst.rs);
+        return inst.signals[flags.zero];
     }
 
     // Opcode 0x0 sub-dispatch
-    void execute_misc() {
-        uint8_t rs = bits_to_int(ir.rs());
-        uint8_t rd = bits_to_int(ir.rd());
+    void execute_misc(const DecodedInstruction& inst) {
+        uint8_t rs = inst.rs.to_int();
+        uint8_t rd = inst.rd.to_int();
 
         switch (rs) {
             case 0:
@@ -194,52 +252,56 @@ private:
                     case 3: return_from_interrupt(); return;    // RTI
                     default: return;                            // NOP
                 }
-            case 1: push_byte(from_bits8(reg_file.rd_out)); return;       // PUSH
-            case 2: write_reg(ir.rd(), to_bits8(pop_byte())); return;     // POP
+            case 1: push_byte(reg_file.rd_out.to_int()); return;         // PUSH
+            case 2: write_reg(inst.rd, Bits<8>(pop_byte())); return;     // POP
             case 3:
-                if (rd == 0) { jump_to(to_bits16(pop16())); return; }              // RET
-                if (rd == 1) { enter_interrupt(from_bits8(ir.imm8())); return; }   // SWI
-                if (rd == 2) { if (flags.carry) jump_to(ir.imm16()); return; }     // JC
-                if (rd == 3) { if (!flags.carry) jump_to(ir.imm16()); return; }    // JNC
+                if (rd == 0) { jump_to(Bits<16>(pop16())); return; }                // RET
+                if (rd == 1) { enter_interrupt(inst.imm8().to_int()); return; }     // SWI
+                if (rd == 2) { if (flags.carry) jump_to(inst.imm16); return; }      // JC
+                if (rd == 3) { if (!flags.carry) jump_to(inst.imm16); return; }     // JNC
                 return;
         }
     }
 
-    void execute(const ControlSignals& s) {
-        uint8_t op = bits_to_int(ir.opcode());
+    void execute(const DecodedInstruction& inst, const ControlSignals& s) {
+        uint8_t op = inst.opcode.to_int();
 
-        if (op == 0x0) { execute_misc(); return; }
-        if (op == 0xE) { push16(pc.to_int()); jump_to(ir.imm16()); return; }  // CALL
+        if (op == 0x0) { execute_misc(inst); return; }
+        if (op == 0xE) { push16(pc.to_int()); jump_to(inst.imm16); return; }  // CALL
 
         // Indexed load/store: rs=1 signals "use R2:R3 as address"
-        if (bits_to_int(ir.rs()) == 1) {
+        if (inst.rs.to_int() == 1) {
             uint16_t addr = (reg_file.get_reg(2) << 8) | reg_file.get_reg(3);
-            if (op == 0x2) { write_reg(ir.rd(), to_bits8(bus.read_byte(addr))); return; }  // LDR
-            if (op == 0x3) { bus.write_byte(addr, from_bits8(reg_file.rd_out)); return; }   // STR
+            if (op == 0x2) { write_reg(inst.rd, Bits<8>(bus.read_byte(addr))); return; }  // LDR
+            if (op == 0x3) { bus.write_byte(addr, reg_file.rd_out.to_int()); return; }   // STR
         }
 
         // ALU
         Mux2<8> alu_b_mux;
-        alu_b_mux.select(s.alu_src_imm, reg_file.rs_out, ir.imm8());
-        alu.compute(reg_file.rd_out, alu_b_mux.output, s.alu_op0, s.alu_op1);
+        alu_b_mux.select(s.alu_src_imm, reg_file.rs_out, inst.imm8());
+        {
+            SEEDISA_PROFILE_PART(ALU);
+            alu.compute(reg_file.rd_out, alu_b_mux.output, s.alu_op0, s.alu_op1);
+        }
 
         // Memory
-        std::array<bool, 8> mem_data = {};
-        if (s.mem_read)  mem_data = to_bits8(bus.read_byte(from_bits16(ir.imm16())));
-        if (s.mem_write) bus.write_byte(from_bits16(ir.imm16()), from_bits8(reg_file.rd_out));
+        Bits<8> mem_data = {};
+        if (s.mem_read)  mem_data = Bits<8>(bus.read_byte(inst.imm16.to_int()));
+        if (s.mem_write) bus.write_byte(inst.imm16.to_int(), reg_file.rd_out.to_int());
 
         // Writeback mux
-        std::array<bool, 8> write_data = alu.result;
+        Bits<8> write_data = alu.result;
         if (s.reg_src_mem) write_data = mem_data;
-        else if (s.reg_src_imm) write_data = ir.imm8();
+        else if (s.reg_src_imm) write_data = inst.imm8();
         else if (s.is_mov) write_data = reg_file.rs_out;
 
-        if (s.reg_write) write_reg(ir.rd(), write_data);
+        if (s.reg_write) write_reg(inst.rd, write_data);
         if (s.flags_write) {
+            SEEDISA_PROFILE_PART(Flags);
             flags.update(false, true, alu.carry, alu.zero);
             flags.update(true, true, alu.carry, alu.zero);
         }
-        if (s.pc_jump) jump_to(ir.imm16());
+        if (s.pc_jump) jump_to(inst.imm16);
         if (s.halt) halted = true;
     }
 };
@@ -0,0 +1,95 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+// CycleCosts — how many cycles each kind of step takes.
+//
+// An instruction costs its entry in `op` (or, for opcode 0x0, in `misc`
+// by sub-instruction) plus `mem` for every byte of data it reads or
+// writes: LD/ST 1, PUSH/POP 1, CALL/RET 2 (the return address), RTI 3
+// (the frame), SWI 5 (the frame plus the vector). Instruction fetch is
+// part of the `op` cost. Taking an interrupt costs `interrupt` plus the
+// same 5 bytes as SWI. A step of a halted core costs `idle`.
+//
+// The defaults make every step one cycle, so cycles and steps agree.
+// standard() charges for what each instruction does on the datapath.
+
+struct CycleCosts {
+    uint8_t op[16] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+    uint8_t misc[16] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};   // by rs * 4 + rd
+    uint8_t mem = 0;
+    uint8_t interrupt = 1;
+    uint8_t idle = 1;
+
+    // Fetching an instruction takes 3 cycles (one per byte), an ALU
+    // operation or a register move 1 more, a jump 1 more (loading the
+    // PC), and each data byte 2 (address, then data)
+    static CycleCosts standard() {
+        CycleCosts c;
+        const uint8_t ops[16] = {
+            0, 4, 4, 4, 4, 4, 4, 4,   // (misc), LDI, LD, ST, ADD, SUB, AND, OR
+            4, 4, 4, 4, 4, 4, 4, 3,   // MOV, CMP, JMP, JZ, JNZ, ADDI, CALL, HLT
+        };
+        const uint8_t misc[16] = {
+            3, 3, 3, 4,               // NOP, CLI, STI, RTI
+            4, 4, 4, 4,               // PUSH
+            4, 4, 4, 4,               // POP
+            4, 4, 4, 4,               // RET, SWI, JC, JNC
+        };
+        std::copy(ops, ops + 16, c.op);
+        std::copy(misc, misc + 16, c.misc);
+        c.mem = 2;
+        c.interrupt = 2;
+        return c;
+    }
+};
+
+// CycleTable — CycleCosts worked out per instruction encoding, for the
+// cores to look up by the instruction's third byte (opcode, Rd, Rs).
+// Every entry is at least 1, so time always moves forward.
+
+class CycleTable {
+public:
+    CycleTable() : CycleTable(CycleCosts()) {}
+
+    explicit CycleTable(const CycleCosts& c) : costs(c) {
+        for (int b2 = 0; b2 < 256; b2++) {
+            uint8_t op = b2 >> 4, rd = (b2 >> 2) & 3, rs = b2 & 3;
+            uint32_t n = op == 0 ? c.misc[rs * 4 + rd] : c.op[op];
+            inst[b2] = clamp(n + c.mem * data_bytes(op, rd, rs));
+        }
+        interrupt = clamp(c.interrupt + c.mem * 5u);
+        idle = clamp(c.idle);
+        min = std::min({*std::min_element(inst, inst + 256), interrupt, idle});
+    }
+
+    // The table every core starts with: one cycle per step
+    static const CycleTable& uniform() {
+        static const CycleTable t;
+        return t;
+    }
+
+    const CycleCosts& get_costs() const { return costs; }
+
+    uint16_t inst[256];    // by instruction byte 2
+    uint16_t interrupt;    // taking an interrupt
+    uint16_t idle;         // a step while halted
+    uint16_t min;          // the cheapest step of any kind
+
+private:
+    CycleCosts costs;
+
+    static uint16_t clamp(uint32_t n) { return uint16_t(std::max<uint32_t>(n, 1)); }
+
+    // Bytes of data memory an instruction reads or writes
+    static uint32_t data_bytes(uint8_t op, uint8_t rd, uint8_t rs) {
+        if (op == 0x2 || op == 0x3) return 1;      // LD/LDR, ST/STR
+        if (op == 0xE) return 2;                   // CALL
+        if (op != 0x0) return 0;
+        if (rs == 1 || rs == 2) return 1;          // PUSH, POP
+        if (rs == 3 && rd == 0) return 2;          // RET
+        if (rs == 3 && rd == 1) return 5;          // SWI
+        if (rs == 0 && rd == 3) return 3;          // RTI
+        return 0;
+    }
+};
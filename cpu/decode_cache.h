@@ -0,0 +1,66 @@
+#pragma once
+#include "control_unit.h"
+#include <array>
+#include <cstdint>
+
+// One fetched and decoded instruction: the IR fields the datapath uses,
+// plus the control unit's output for both values of the zero flag
+// (the only input to the control unit besides the opcode).
+
+struct DecodedInstruction {
+    Bits<4>  opcode = {};
+    Bits<2>  rd     = {};
+    Bits<2>  rs     = {};
+    Bits<16> imm16  = {};
+    ControlSignals signals[2] = {};   // indexed by zero flag
+
+    Bits<8> imm8() const { return Bits<8>(imm16.to_int()); }
+};
+
+// DecodeCache — remembers decoded instructions by PC.
+//
+// Direct-mapped: slot = PC mod SIZE, tagged with the full PC. Since
+// instructions are 3 bytes and SIZE is a power of two, any run of up to
+// SIZE consecutive instructions lands in distinct slots.
+//
+// The cache only knows about addresses; keeping it coherent with memory
+// is the owner's job (the CPU invalidates from a Bus code watcher).
+
+class DecodeCache {
+public:
+    static constexpr int SIZE = 1024;
+
+    const DecodedInstruction* lookup(uint16_t pc) const {
+        const Entry& e = entries[pc & (SIZE - 1)];
+        return e.tag == pc ? &e.inst : nullptr;
+    }
+
+    void insert(uint16_t pc, const DecodedInstruction& inst) {
+        Entry& e = entries[pc & (SIZE - 1)];
+        e.tag = pc;
+        e.inst = inst;
+    }
+
+    // A byte changed: drop every instruction whose 3 bytes cover it
+    void invalidate(uint32_t addr) {
+        for (uint32_t back = 0; back < 3; back++) {
+            uint16_t pc = (addr - back) & 0xFFFF;
+            Entry& e = entries[pc & (SIZE - 1)];
+            if (e.tag == pc) e.tag = INVALID;
+        }
+    }
+
+    void flush() {
+        for (auto& e : entries) e.tag = INVALID;
+    }
+
+private:
+    static constexpr uint32_t INVALID = 0xFFFFFFFF;
+
+    struct Entry {
+        uint32_t tag = INVALID;
+        DecodedInstruction inst;
+    };
+
+    std::array<Entry, SIZE> entries = {};
+};
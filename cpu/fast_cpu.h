@@ -0,0 +1,245 @@
+#pragma once
+#include "core.h"
+#include "../memory/bus.h"
+#include <cstdint>
+
+// FastCPU — the same ISA as CPU, executed on plain integers.
+//
+// CPU models every register as flip-flops and every add as a ripple of
+// full adders, which is the point of this project but makes it slow.
+// FastCPU keeps the architectural state in uint8_t/uint16_t and does
+// each instruction with native host arithmetic. It shares the Bus and
+// the interrupt rules (IVT at IVT_BASE, same push order, same flags
+// byte) with CPU, so the gate-level core stays the reference model and
+// the two can be run side by side and compared step by step.
+//
+// Anything that looks odd here (reset leaving registers and flags alone,
+// SWI ignoring int_enabled) is there because CPU does it too.
+//
+// ThreadedCPU builds on this class and reuses its state and helpers.
+
+class FastCPU : public Core {
+public:
+    FastCPU(Bus& bus) : bus(bus) {}
+
+    void reset() override {
+        pc = 0;
+        sp = 0xEFFF;
+        halted = false;
+        int_enabled = false;
+        int_pending = 0;
+    }
+
+    bool is_halted() const override { return halted; }
+
+    void raise_interrupt(uint8_t num) override {
+        mark_pending(int_pending, num);
+    }
+
+    void step() final {
+        if (halted) { last_cycles = cycles->idle; return; }
+        if (check_interrupts()) { last_cycles = cycles->interrupt; return; }
+        uint8_t b[3];
+        bus.fetch(pc, b, 3);
+        pc += 3;
+        last_cycles = cycles->inst[b[2]];
+        execute(b[2], b[0] | (b[1] << 8));
+    }
+
+    // Execute instructions for the run loop while fewer than `budget`
+    // cycles have passed (the last one may end past it). Returns how many
+    // completed and adds the cycles they took to `used`. Stops before
+    // anything that could touch I/O (the caller steps those with the
+    // devices caught up) and never takes an interrupt: with one
+    // deliverable, stops there.
+    uint32_t run_batch(uint32_t budget, uint32_t& used) {
+        uint32_t n = 0, spent = 0;
+        for (; spent < budget && !halted && !interrupt_ready(); n++) {
+            if (pc + 2u >= Bus::IO_BASE) break;
+            uint8_t b[3];
+            bus.fetch(pc, b, 3);
+            if (may_touch_io(b[2], b[0] | (b[1] << 8))) break;
+            pc += 3;
+            spent += cycles->inst[b[2]];
+            execute(b[2], b[0] | (b[1] << 8));
+        }
+        used += spent;
+        return n;
+    }
+
+    uint8_t get_reg(int i) const override { return regs[i]; }
+    uint16_t get_pc() const override { return pc; }
+    bool get_zero() const override { return zero; }
+    bool get_carry() const override { return carry; }
+    uint16_t get_sp() const override { return sp; }
+    bool get_int_enabled() const override { return int_enabled; }
+
+    CoreState get_state() const override {
+        CoreState s;
+        for (int i = 0; i < 4; i++) s.regs[i] = regs[i];
+        s.pc = pc; s.sp = sp;
+        s.zero = zero; s.carry = carry;
+        s.int_enabled = int_enabled; s.halted = halted;
+        s.int_pending = int_pending;
+        return s;
+    }
+
+    void set_state(const CoreState& s) override {
+        for (int i = 0; i < 4; i++) regs[i] = s.regs[i];
+        pc = s.pc; sp = s.sp;
+        zero = s.zero; carry = s.carry;
+        int_enabled = s.int_enabled; halted = s.halted;
+        int_pending = s.int_pending;
+    }
+
+protected:
+    Bus& bus;
+    uint8_t regs[4] = {};
+    uint16_t pc = 0;
+    uint16_t sp = 0xEFFF;
+    bool zero = false;
+    bool carry = false;
+    bool halted = false;
+    bool int_enabled = false;
+    uint8_t int_pending = 0;
+
+    // --- Interrupt handling ---
+
+    // The next step would take an interrupt
+    bool interrupt_ready() const {
+        return int_enabled && int_pending && pick_interrupt(int_pending) >= 0;
+    }
+
+    bool check_interrupts() {
+        if (!int_enabled || !int_pending) return false;
+        int num = pick_interrupt(int_pending);
+        if (num < 0) return false;
+        int_pending &= ~(1 << num);
+        if (router) router->taken(num);
+        enter_interrupt(num);
+        return true;
+    }
+
+    void enter_interrupt(uint8_t num) {
+        // Same frame as CPU, low to high: flags (int_enabled in bit 2), PC lo, PC hi
+        uint8_t saved_flags = (zero ? 1 : 0) | (carry ? 2 : 0) | (int_enabled ? 4 : 0);
+        const uint8_t frame[3] = {saved_flags, uint8_t(pc & 0xFF), uint8_t(pc >> 8)};
+        sp -= 3;
+        bus.write(sp, frame, 3);
+        int_enabled = false;
+        pc = bus.read_word(IVT_BASE + num * 2);
+    }
+
+    void return_from_interrupt() {
+        uint8_t frame[3];
+        bus.read(sp, frame, 3);
+        sp += 3;
+        uint8_t saved_flags = frame[0];
+        pc = frame[1] | (frame[2] << 8);
+        zero  = saved_flags & 1;
+        carry = (saved_flags >> 1) & 1;
+        int_enabled = (saved_flags >> 2) & 1;
+    }
+
+    // --- Helpers ---
+
+    void push_byte(uint8_t val) { sp--; bus.write_byte(sp, val); }
+    uint8_t pop_byte() { uint8_t v = bus.read_byte(sp); sp++; return v; }
+
+    // A pushed word sits little-endian at the new SP
+    void push16(uint16_t val) { sp -= 2; bus.write_word(sp, val); }
+    uint16_t pop16() { uint16_t v = bus.read_word(sp); sp += 2; return v; }
+
+    // Could this instruction read or write the I/O region? Loads and
+    // stores by address; anything using the stack unless SP is well
+    // inside RAM (an interrupt frame is the most it moves: 3 bytes); and
+    // an SWI past the IVT, whose vector is read from the I/O region.
+    bool may_touch_io(uint8_t b2, uint16_t imm) const {
+        uint8_t op = b2 >> 4, rd = (b2 >> 2) & 3, rs = b2 & 3;
+        if (op == 0x2 || op == 0x3) return uint32_t(rs == 1 ? (regs[2] << 8) | regs[3] : imm) >= Bus::IO_BASE;
+        if (op == 0x0 && rs == 3 && rd == 1 && (imm & 0xFF) >= MAX_INTERRUPTS) return true;
+        bool stack = op == 0xE || (op == 0x0 && (rs == 1 || rs == 2 || (rs == 3 && rd <= 1) || (rs == 0 && rd == 3)));
+        return stack && (sp < 3 || sp + 3u > Bus::IO_BASE);
+    }
+
+    // ADD/SUB/AND/OR exactly as ALU<8> produces them.
+    // SUB is A + ~B + 1, so carry means "no borrow" (A >= B).
+    void alu_flags(unsigned wide, uint8_t result) {
+        carry = wide > 0xFF;
+        zero  = result == 0;
+    }
+
+    // --- Execute ---
+
+    void execute_misc(uint8_t rd, uint8_t rs, uint16_t imm) {
+        switch (rs) {
+            case 0:
+                switch (rd) {
+                    case 1: int_enabled = false; return;       // CLI
+                    case 2: int_enabled = true; return;        // STI
+                    case 3: return_from_interrupt(); return;    // RTI
+                    default: return;                            // NOP
+                }
+            case 1: push_byte(regs[rd]); return;                // PUSH
+            case 2: regs[rd] = pop_byte(); return;              // POP
+            case 3:
+                if (rd == 0) { pc = pop16(); return; }                  // RET
+                if (rd == 1) { enter_interrupt(imm & 0xFF); return; }   // SWI
+                if (rd == 2) { if (carry) pc = imm; return; }           // JC
+                if (rd == 3) { if (!carry) pc = imm; return; }          // JNC
+                return;
+        }
+    }
+
+    void execute(uint8_t b2, uint16_t imm) {
+        uint8_t op = b2 >> 4;
+        uint8_t rd = (b2 >> 2) & 3;
+        uint8_t rs = b2 & 3;
+        uint8_t a = regs[rd];
+        uint8_t b = regs[rs];
+
+        switch (op) {
+            case 0x0: execute_misc(rd, rs, imm); return;
+            case 0x1: regs[rd] = imm & 0xFF; return;                    // LDI
+            case 0x2:                                                   // LD / LDR
+                if (rs == 1) regs[rd] = bus.read_byte((regs[2] << 8) | regs[3]);
+                else regs[rd] = bus.read_byte(imm);
+                return;
+            case 0x3:                                                   // ST / STR
+                if (rs == 1) bus.write_byte((regs[2] << 8) | regs[3], a);
+                else bus.write_byte(imm, a);
+                return;
+            case 0x4: {                                                 // ADD
+                unsigned w = a + b;
+                regs[rd] = w & 0xFF;
+                alu_flags(w, regs[rd]);
+                return;
+            }
+            case 0x5: {                                                 // SUB
+                unsigned w = a + (uint8_t)~b + 1;
+                regs[rd] = w & 0xFF;
+                alu_flags(w, regs[rd]);
+                return;
+            }
+            case 0x6: regs[rd] = a & b; alu_flags(0, regs[rd]); return;  // AND
+            case 0x7: regs[rd] = a | b; alu_flags(0, regs[rd]); return;  // OR
+            case 0x8: regs[rd] = b; return;                             // MOV
+            case 0x9: {                                                 // CMP
+                unsigned w = a + (uint8_t)~b + 1;
+                alu_flags(w, w & 0xFF);
+                return;
+            }
+            case 0xA: pc = imm; return;                                 // JMP
+            case 0xB: if (zero) pc = imm; return;                       // JZ
+            case 0xC: if (!zero) pc = imm; return;                      // JNZ
+            case 0xD: {                                                 // ADDI
+                unsigned w = a + (imm & 0xFF);
+                regs[rd] = w & 0xFF;
+                alu_flags(w, regs[rd]);
+                return;
+            }
+            case 0xE: push16(pc); pc = imm; return;                     // CALL
+            case 0xF: halted = true; return;                            // HLT
+        }
+    }
+};
@@ -10,41 +10,28 @@
 
 class InstructionRegister {
 public:
-    void load_byte0(bool clk, bool en, const std::array<bool, 8>& data) {
+    void load_byte0(bool clk, bool en, const Bits<8>& data) {
         b0.clock(clk, en, data);
     }
-    void load_byte1(bool clk, bool en, const std::array<bool, 8>& data) {
+    void load_byte1(bool clk, bool en, const Bits<8>& data) {
         b1.clock(clk, en, data);
     }
-    void load_byte2(bool clk, bool en, const std::array<bool, 8>& data) {
+    void load_byte2(bool clk, bool en, const Bits<8>& data) {
         b2.clock(clk, en, data);
     }
 
-    std::array<bool, 4> opcode() const {
-        return {b2.data_out[4], b2.data_out[5], b2.data_out[6], b2.data_out[7]};
-    }
+    Bits<4> opcode() const { return Bits<4>(b2.data_out.to_int() >> 4); }
 
-    std::array<bool, 2> rd() const {
-        return {b2.data_out[2], b2.data_out[3]};
-    }
+    Bits<2> rd() const { return Bits<2>(b2.data_out.to_int() >> 2); }
 
-    std::array<bool, 2> rs() const {
-        return {b2.data_out[0], b2.data_out[1]};
-    }
+    Bits<2> rs() const { return Bits<2>(b2.data_out.to_int()); }
 
     // 8-bit immediate (low byte only, for LDI etc)
-    std::array<bool, 8> imm8() const {
-        return b0.data_out;
-    }
+    Bits<8> imm8() const { return b0.data_out; }
 
     // 16-bit immediate (for JMP, CALL, LD/ST addresses)
-    std::array<bool, 16> imm16() const {
-        std::array<bool, 16> val = {};
-        for (int i = 0; i < 8; i++) {
-            val[i] = b0.data_out[i];
-            val[i + 8] = b1.data_out[i];
-        }
-        return val;
+    Bits<16> imm16() const {
+        return Bits<16>(b0.data_out.to_int() | (b1.data_out.to_int() << 8));
     }
 
 private:
@@ -0,0 +1,504 @@
+#pragma once
+#include "fast_cpu.h"
+#include "x86_emitter.h"
+#include "../memory/bus.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// JitCPU — FastCPU with a basic-block translator to x86-64.
+//
+// run_batch() looks up (or compiles) the block starting at PC and runs it
+// as native code. A block is a straight run of instructions ending at the
+// first JMP/JZ/JNZ/JC/JNC/CALL/RET/RTI/SWI/HLT (or STI, or 32 instructions).
+// Blocks with a known successor jump straight into it once it exists
+// (chaining), so a hot loop never returns to C++ at all.
+//
+// Inside a block guest R0-R3 live in host registers r12b-r15b. Zero and
+// carry are evaluated lazily: an ALU op only writes them back if some
+// later instruction can observe them before the next ALU op overwrites
+// them — a CMP right before a JNZ pays, a chain of ADDs doesn't.
+// Memory goes through small C helpers that call the Bus.
+//
+// Same batch contract as ThreadedCPU: anything that would touch the I/O
+// page (LD/ST of an I/O address, LDR/STR through R2:R3, stack or IVT
+// accesses) ends the batch before it executes so the Computer can
+// single-step it; so do STI, RTI and HLT after executing. The budget is
+// in cycles: a block charges all of its instructions' cycles on entry
+// (and refunds the ones it didn't run), and only runs if they fit, so
+// a batch never passes the next device event. Cycle costs are compiled
+// into the blocks, so a new cycle table flushes them.
+//
+// Self-modifying code: a write that hits translated code throws away
+// the whole translation cache (blocks are never patched in place). A
+// 256-byte page that keeps being written after it was translated stops
+// being compiled and is left to the interpreter.
+//
+// Off-platform (anything but Linux x86-64), or if the host refuses an
+// executable mapping, run_batch() always returns 0 and every step is
+// interpreted by FastCPU::step().
+
+class JitCPU final : public FastCPU {
+public:
+    static constexpr int MAX_BLOCK = 32;
+    static constexpr size_t CODE_SIZE = 4 << 20;
+    static constexpr int BLACKLIST_AFTER = 4;   // code writes before a page is left to the interpreter
+
+    JitCPU(Bus& bus) : FastCPU(bus), code(CODE_SIZE) {
+        state.bus = &bus;
+        code_watch = bus.add_code_watcher([this](uint32_t addr) { on_code_write(addr); });
+        remap_watch = bus.add_remap_watcher([this](uint32_t addr, uint32_t length) { on_remap(addr, length); });
+        if (code.ok()) flush();
+    }
+
+    ~JitCPU() override {
+        bus.remove_watcher(code_watch);
+        bus.remove_watcher(remap_watch);
+    }
+
+    JitCPU(const JitCPU&) = delete;
+    JitCPU& operator=(const JitCPU&) = delete;
+
+    bool jit_available() const { return code.ok(); }
+    size_t blocks_compiled() const { return compiled; }
+
+    // Same contract as FastCPU::run_batch, except that it never runs
+    // past the budget: a block that doesn't fit ends the batch
+    uint32_t run_batch(uint32_t budget, uint32_t& used) {
+        if (halted || budget == 0 || !code.ok()) return 0;
+        if (interrupt_ready()) return 0;
+        if (state.code_dirty) flush();
+
+        load_state();
+        state.left = budget;
+        state.steps = 0;
+
+        while (state.left > 0) {
+            const uint8_t* entry = block_at(state.pc);
+            if (!entry) break;
+            state.stop = 0;
+            state.exit_site = nullptr;
+            enter(&state, entry);
+
+            if (state.code_dirty) { flush(); if (state.stop) break; continue; }
+            if (state.stop) break;
+
+            // Left through an unresolved chain exit: link it to the next block
+            // (unless compiling that block flushed the buffer the exit lived in)
+            if (state.exit_site) {
+                uint32_t gen = generation;
+                const uint8_t* next = block_at(state.pc);
+                if (!next) break;
+                if (gen == generation)
+                    X86Emitter::patch_rel32(static_cast<uint8_t*>(state.exit_site), next);
+            }
+        }
+
+        store_state();
+        used += budget - state.left;
+        return state.steps;
+    }
+
+    void set_cycle_table(const CycleTable& t) override {
+        FastCPU::set_cycle_table(t);
+        state.code_dirty = 1;
+    }
+
+private:
+    // Everything generated code reads or writes, at fixed offsets from rbx
+    struct State {
+        uint8_t regs[4];
+        uint16_t pc;
+        uint16_t sp;
+        uint8_t zero;
+        uint8_t carry;
+        uint8_t int_enabled;
+        uint8_t halted;
+        uint8_t stop;          // exit ends the batch
+        uint8_t code_dirty;    // translated code was written
+        uint32_t left;         // cycle budget
+        uint32_t steps;        // instructions run this batch
+        void* exit_site;       // chain exit to patch, if any
+        Bus* bus;
+    };
+
+    // Helper return value meaning "would touch I/O, nothing was done"
+    static constexpr uint32_t REFUSE = 0xFFFFFFFF;
+
+    State state = {};
+    CodeBuffer code;
+    uint8_t* code_end = nullptr;       // first free byte
+    uint8_t* epilogue = nullptr;
+    void (*enter)(State*, const void*) = nullptr;
+    size_t compiled = 0;
+    uint32_t generation = 0;           // bumped by every flush
+    Bus::WatcherId code_watch, remap_watch;
+
+    std::array<std::unique_ptr<const uint8_t*[]>, 256> blocks;   // entry by PC, paged
+    std::vector<uint64_t> code_bytes = std::vector<uint64_t>(0x10000 / 64);
+    std::array<uint8_t, 256> page_writes = {};
+
+    // --- Host side ---
+
+    void load_state() {
+        for (int i = 0; i < 4; i++) state.regs[i] = regs[i];
+        state.pc = pc; state.sp = sp;
+        state.zero = zero; state.carry = carry;
+        state.int_enabled = int_enabled; state.halted = halted;
+    }
+
+    void store_state() {
+        for (int i = 0; i < 4; i++) regs[i] = state.regs[i];
+        pc = state.pc; sp = state.sp;
+        zero = state.zero; carry = state.carry;
+        int_enabled = state.int_enabled; halted = state.halted;
+    }
+
+    void on_code_write(uint32_t addr) {
+        addr &= 0xFFFF;
+        if (!(code_bytes[addr / 64] >> (addr % 64) & 1)) return;
+        state.code_dirty = 1;
+        if (page_writes[addr >> 8] < BLACKLIST_AFTER) page_writes[addr >> 8]++;
+    }
+
+    // A bank switch under translated code: flush before the next batch.
+    // Not a code write, so it doesn't count towards blacklisting.
+    void on_remap(uint32_t addr, uint32_t length) {
+        uint32_t first = addr >= 2 ? addr - 2 : 0;   // instructions running into the range
+        for (uint32_t a = first; a < addr + length && a < 0x10000; a++)
+            if (code_bytes[a / 64] >> (a % 64) & 1) { state.code_dirty = 1; return; }
+    }
+
+    // Drop every block and start the buffer over with the entry/exit stubs
+    void flush() {
+        for (auto& page : blocks) page.reset();
+        std::fill(code_bytes.begin(), code_bytes.end(), 0);
+        state.code_dirty = 0;
+        generation++;
+
+        X86Emitter e(code.data(), code.data() + code.size());
+        enter = reinterpret_cast<void (*)(State*, const void*)>(e.here());
+        e.trampoline(offsetof(State, regs), offsetof(State, left));
+        epilogue = e.here();
+        e.epilogue(offsetof(State, regs), offsetof(State, left));
+        code_end = e.here();
+    }
+
+    const uint8_t* block_at(uint16_t addr) {
+        auto& page = blocks[addr >> 8];
+        if (page && page[addr & 0xFF]) return page[addr & 0xFF];
+        const uint8_t* entry = compile(addr);
+        if (entry) {
+            auto& p = blocks[addr >> 8];   // compile() may have flushed
+            if (!p) {
+                p.reset(new const uint8_t*[256]);
+                for (int i = 0; i < 256; i++) p[i] = nullptr;
+            }
+            p[addr & 0xFF] = entry;
+        }
+        return entry;
+    }
+
+    // --- Helpers called from generated code (rdi = &state) ---
+
+    static uint32_t h_load(State* s, uint32_t addr) { return s->bus->read_byte(addr); }
+    static void h_store(State* s, uint32_t addr, uint32_t val) { s->bus->write_byte(addr, val); }
+
+    static void push(State* s, uint8_t v) { s->sp--; s->bus->write_byte(s->sp, v); }
+    static uint8_t pop(State* s) { return s->bus->read_byte(s->sp++); }
+
+    static uint32_t h_push8(State* s, uint32_t val) {
+        if (s->sp < 1 || s->sp > Bus::IO_BASE) return REFUSE;
+        push(s, val);
+        return 0;
+    }
+    static uint32_t h_pop8(State* s) {
+        if (s->sp + 1u > Bus::IO_BASE) return REFUSE;
+        return pop(s);
+    }
+    static uint32_t h_push16(State* s, uint32_t val) {
+        if (s->sp < 2 || s->sp > Bus::IO_BASE) return REFUSE;
+        s->sp -= 2;
+        s->bus->write_word(s->sp, val);
+        return 0;
+    }
+    static uint32_t h_pop16(State* s) {
+        if (s->sp + 2u > Bus::IO_BASE) return REFUSE;
+        uint16_t v = s->bus->read_word(s->sp);
+        s->sp += 2;
+        return v;
+    }
+    // SWI: same frame as FastCPU::enter_interrupt; returns the handler address
+    static uint32_t h_swi(State* s, uint32_t num, uint32_t ret_pc) {
+        if (s->sp < 3 || s->sp > Bus::IO_BASE) return REFUSE;
+        uint8_t saved_flags = (s->zero ? 1 : 0) | (s->carry ? 2 : 0) | (s->int_enabled ? 4 : 0);
+        const uint8_t frame[3] = {saved_flags, uint8_t(ret_pc & 0xFF), uint8_t(ret_pc >> 8)};
+        s->sp -= 3;
+        s->bus->write(s->sp, frame, 3);
+        s->int_enabled = 0;
+        return s->bus->read_word(IVT_BASE + num * 2);
+    }
+    static uint32_t h_rti(State* s) {
+        if (s->sp + 3u > Bus::IO_BASE) return REFUSE;
+        uint8_t frame[3];
+        s->bus->read(s->sp, frame, 3);
+        s->sp += 3;
+        uint8_t saved_flags = frame[0];
+        uint16_t lo = frame[1], hi = frame[2];
+        s->zero = saved_flags & 1;
+        s->carry = (saved_flags >> 1) & 1;
+        s->int_enabled = (saved_flags >> 2) & 1;
+        return (hi << 8) | lo;
+    }
+
+    // --- Translator ---
+
+    struct Inst {
+        uint16_t pc;
+        uint8_t op, rd, rs;
+        uint16_t imm;
+
+        uint8_t b2() const { return op << 4 | rd << 2 | rs; }
+    };
+
+    static bool is_flag_writer(const Inst& in) {
+        return (in.op >= 0x4 && in.op <= 0x7) || in.op == 0x9 || in.op == 0xD;
+    }
+
+    // Touches only registers: flags stay invisible across it
+    static bool is_pure(const Inst& in) {
+        if (in.op == 0x1 || in.op == 0x8) return true;                 // LDI, MOV
+        if (in.op == 0x0 && in.rs == 0 && in.rd <= 1) return true;     // NOP, CLI
+        return false;
+    }
+
+    static bool ends_block(const Inst& in) {
+        if (in.op >= 0xA && in.op <= 0xC) return true;                 // JMP, JZ, JNZ
+        if (in.op == 0xE || in.op == 0xF) return true;                 // CALL, HLT
+        if (in.op == 0x0 && in.rs == 0 && in.rd >= 2) return true;     // STI, RTI
+        if (in.op == 0x0 && in.rs == 3) return true;                   // RET, SWI, JC, JNC
+        return false;
+    }
+
+    // Can this instruction be translated at all?
+    bool translatable(uint16_t addr, const Inst& in) const {
+        if (addr + 2u >= Bus::IO_BASE) return false;
+        if (page_writes[addr >> 8] >= BLACKLIST_AFTER) return false;
+        if ((in.op == 0x2 || in.op == 0x3) && in.rs != 1 && in.imm >= Bus::IO_BASE) return false;
+        if (in.op == 0x0 && in.rs == 3 && in.rd == 1 && (in.imm & 0xFF) >= MAX_INTERRUPTS) return false;
+        return true;
+    }
+
+    Inst decode_at(uint16_t addr) const {
+        uint8_t b[3];
+        bus.fetch(addr, b, 3);
+        uint16_t imm = b[0] | (b[1] << 8);
+        return {addr, uint8_t(b[2] >> 4), uint8_t((b[2] >> 2) & 3), uint8_t(b[2] & 3), imm};
+    }
+
+    struct Stub {
+        uint8_t* site;     // rel32 that jumps here
+        uint16_t pc;       // guest PC to leave with
+        uint32_t refund;   // instructions not executed, to give back
+        bool stop;         // end the batch, or come back for the next block
+        bool chain;        // patchable link to the block at pc
+    };
+
+    const uint8_t* compile(uint16_t start) {
+        std::vector<Inst> insts;
+        uint16_t addr = start;
+        while ((int)insts.size() < MAX_BLOCK) {
+            if (addr + 2u >= Bus::IO_BASE) break;
+            Inst in = decode_at(addr);
+            if (!translatable(addr, in)) break;
+            insts.push_back(in);
+            addr += 3;
+            if (ends_block(in)) break;
+        }
+        if (insts.empty()) return nullptr;
+
+        // Worst case (CALL with its three exits) is under 256 bytes per instruction
+        if ((size_t)(code.data() + code.size() - code_end) < insts.size() * 256 + 64) flush();
+
+        X86Emitter e(code_end, code.data() + code.size());
+        std::vector<Stub> stubs;
+        const uint32_t k = insts.size();
+        const uint8_t* entry = e.here();
+        auto stub = [&](uint8_t* site, uint16_t pc, uint32_t refund, bool stop, bool chain) {
+            stubs.push_back({site, pc, refund, stop, chain});
+        };
+        auto stop_before = [&](x86::Cond cc, uint32_t i) {
+            stub(e.jcc_rel32(cc, e.here()), insts[i].pc, k - i, true, false);
+        };
+        auto dirty_check = [&](uint32_t i, uint16_t next_pc) {
+            e.cmp_state8_imm(offsetof(State, code_dirty), 0);
+            stub(e.jcc_rel32(x86::NZ, e.here()), next_pc, k - i - 1, false, false);
+        };
+        auto exit_now = [&]() { e.jmp_rel32(epilogue); };
+
+        // Cycles of instructions i..k-1, to refund an early exit
+        std::vector<uint32_t> tail(k + 1, 0);
+        for (uint32_t i = k; i-- > 0;) tail[i] = tail[i + 1] + cycles->inst[insts[i].b2()];
+
+        // Budget: take the whole block up front, or leave without running it
+        e.add_state32_imm(offsetof(State, steps), k);
+        e.sub_ebp_imm32(tail[0]);
+        stub(e.jcc_rel32(x86::C, e.here()), start, k, true, false);
+
+        for (uint32_t i = 0; i < k; i++) {
+            const Inst& in = insts[i];
+            uint16_t next = in.pc + 3;
+
+            bool flags_live = true;
+            for (uint32_t j = i + 1; j < k && flags_live; j++) {
+                if (is_flag_writer(insts[j])) flags_live = false;
+                else if (!is_pure(insts[j])) break;
+            }
+            auto write_flags = [&](bool carry_is_not_cf) {
+                if (!flags_live) return;
+                e.setcc_state(x86::Z, offsetof(State, zero));
+                e.setcc_state(carry_is_not_cf ? x86::NC : x86::C, offsetof(State, carry));
+            };
+            auto logic_flags = [&]() {
+                if (!flags_live) return;
+                e.setcc_state(x86::Z, offsetof(State, zero));
+                e.mov_state8_imm(offsetof(State, carry), 0);
+            };
+            auto indexed_addr = [&]() {
+                e.movzx_r32_g(x86::EAX, 2);
+                e.shl_eax_8();
+                e.movzx_r32_g(x86::ECX, 3);
+                e.or_eax_ecx();
+                e.cmp_eax_imm32(Bus::IO_BASE);
+                stop_before(x86::NC, i);
+                e.mov_esi_eax();
+            };
+            auto branch = [&](uint8_t flag_disp, x86::Cond taken_if) {
+                e.cmp_state8_imm(flag_disp, 0);
+                stub(e.jcc_rel32(taken_if, e.here()), in.imm, 0, false, true);
+                stub(e.jmp_rel32(e.here()), next, 0, false, true);
+            };
+
+            switch (in.op) {
+                case 0x0:
+                    if (in.rs == 0) {
+                        if (in.rd == 1) e.mov_state8_imm(offsetof(State, int_enabled), 0);    // CLI
+                        if (in.rd == 2) {                                                    // STI
+                            e.mov_state8_imm(offsetof(State, int_enabled), 1);
+                            e.mov_state16_imm(offsetof(State, pc), next);
+                            e.mov_state8_imm(offsetof(State, stop), 1);
+                            exit_now();
+                        }
+                        if (in.rd == 3) {                                                    // RTI
+                            e.call_helper(reinterpret_cast<const void*>(&h_rti));
+                            e.cmp_eax_imm8(-1);
+                            stop_before(x86::Z, i);
+                            e.mov_state16_ax(offsetof(State, pc));
+                            e.mov_state8_imm(offsetof(State, stop), 1);
+                            exit_now();
+                        }
+                    } else if (in.rs == 1) {                                                 // PUSH
+                        e.movzx_r32_g(x86::ESI, in.rd);
+                        e.call_helper(reinterpret_cast<const void*>(&h_push8));
+                        e.cmp_eax_imm8(-1);
+                        stop_before(x86::Z, i);
+                        dirty_check(i, next);
+                    } else if (in.rs == 2) {                                                 // POP
+                        e.call_helper(reinterpret_cast<const void*>(&h_pop8));
+                        e.cmp_eax_imm8(-1);
+                        stop_before(x86::Z, i);
+                        e.mov_g_al(in.rd);
+                    } else if (in.rd == 0) {                                                 // RET
+                        e.call_helper(reinterpret_cast<const void*>(&h_pop16));
+                        e.cmp_eax_imm8(-1);
+                        stop_before(x86::Z, i);
+                        e.mov_state16_ax(offsetof(State, pc));
+                        exit_now();
+                    } else if (in.rd == 1) {                                                 // SWI
+                        e.mov_r32_imm(x86::ESI, in.imm & 0xFF);
+                        e.mov_r32_imm(x86::EDX, next);
+                        e.call_helper(reinterpret_cast<const void*>(&h_swi));
+                        e.cmp_eax_imm8(-1);
+                        stop_before(x86::Z, i);
+                        e.mov_state16_ax(offsetof(State, pc));
+                        exit_now();
+                    } else {                                                                 // JC / JNC
+                        branch(offsetof(State, carry), in.rd == 2 ? x86::NZ : x86::Z);
+                    }
+                    break;
+                case 0x1: e.mov_g_imm8(in.rd, in.imm & 0xFF); break;                       // LDI
+                case 0x2:                                                                    // LD / LDR
+                    if (in.rs == 1) indexed_addr();
+                    else e.mov_r32_imm(x86::ESI, in.imm);
+                    e.call_helper(reinterpret_cast<const void*>(&h_load));
+                    e.mov_g_al(in.rd);
+                    break;
+                case 0x3:                                                                    // ST / STR
+                    if (in.rs == 1) indexed_addr();
+                    else e.mov_r32_imm(x86::ESI, in.imm);
+                    e.movzx_r32_g(x86::EDX, in.rd);
+                    e.call_helper(reinterpret_cast<const void*>(&h_store));
+                    dirty_check(i, next);
+                    break;
+                case 0x4: e.alu_g_g(x86::ADD, in.rd, in.rs); write_flags(false); break;   // ADD
+                case 0x5: e.alu_g_g(x86::SUB, in.rd, in.rs); write_flags(true); break;    // SUB: carry = no borrow
+                case 0x6: e.alu_g_g(x86::AND, in.rd, in.rs); logic_flags(); break;        // AND
+                case 0x7: e.alu_g_g(x86::OR, in.rd, in.rs); logic_flags(); break;         // OR
+                case 0x8: if (in.rd != in.rs) e.mov_g_g(in.rd, in.rs); break;             // MOV
+                case 0x9: e.alu_g_g(x86::CMP, in.rd, in.rs); write_flags(true); break;    // CMP
+                case 0xA: stub(e.jmp_rel32(e.here()), in.imm, 0, false, true); break;     // JMP
+                case 0xB: branch(offsetof(State, zero), x86::NZ); break;                  // JZ
+                case 0xC: branch(offsetof(State, zero), x86::Z); break;                   // JNZ
+                case 0xD: e.add_g_imm8(in.rd, in.imm & 0xFF); write_flags(false); break;  // ADDI
+                case 0xE:                                                                    // CALL
+                    e.mov_r32_imm(x86::ESI, next);
+                    e.call_helper(reinterpret_cast<const void*>(&h_push16));
+                    e.cmp_eax_imm8(-1);
+                    stop_before(x86::Z, i);
+                    dirty_check(i, in.imm);
+                    stub(e.jmp_rel32(e.here()), in.imm, 0, false, true);
+                    break;
+                case 0xF:                                                                    // HLT
+                    e.mov_state8_imm(offsetof(State, halted), 1);
+                    e.mov_state16_imm(offsetof(State, pc), next);
+                    e.mov_state8_imm(offsetof(State, stop), 1);
+                    exit_now();
+                    break;
+            }
+        }
+
+        // Ran off the end without a terminator: continue at the next PC
+        if (!ends_block(insts.back()))
+            stub(e.jmp_rel32(e.here()), insts.back().pc + 3, 0, false, true);
+
+        // Out-of-line exits
+        for (const Stub& s : stubs) {
+            X86Emitter::patch_rel32(s.site, e.here());
+            if (s.refund) {
+                e.add_ebp_imm32(tail[k - s.refund]);
+                e.sub_state32_imm(offsetof(State, steps), s.refund);
+            }
+            e.mov_state16_imm(offsetof(State, pc), s.pc);
+            if (s.stop) e.mov_state8_imm(offsetof(State, stop), 1);
+            if (s.chain) {
+                e.mov_rax_imm64(reinterpret_cast<uint64_t>(s.site));
+                e.mov_state64_rax(offsetof(State, exit_site));
+            }
+            exit_now();
+        }
+
+        code_end = e.here();
+        compiled++;
+        for (const Inst& in : insts) {
+            for (int b = 0; b < 3; b++) {
+                uint16_t a = in.pc + b;
+                code_bytes[a / 64] |= uint64_t(1) << (a % 64);
+            }
+            bus.mark_code(in.pc, 3);
+        }
+        return entry;
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include "../gates/netlist.h"
+#include "../arithmetic/adder.h"
+#include "../arithmetic/alu.h"
+#include "control_unit.h"
+#include <array>
+#include <vector>
+
+// Netlists of the CPU's combinational components, captured from the
+// same templates the gate-level CPU runs (see gates/netlist.h).
+//
+// Pin order (inputs -> outputs):
+//   adder:        a[0..N-1], b[0..N-1], carry_in  ->  sum[0..N-1], carry_out
+//   ALU:          a[0..N-1], b[0..N-1], op0, op1  ->  result[0..N-1], carry, zero
+//   control unit: opcode[0..3], zero_flag         ->  signals in control_pins() order
+
+// Any of the adders, e.g. adder_netlist<16, KoggeStoneAdder>().gate_count()
+template <int N, template <int, typename> class Adder = RippleCarryAdder>
+Netlist adder_netlist() {
+    return capture_netlist(2 * N + 1, [](const std::vector<NetWire>& in) {
+        std::array<NetWire, N> a, b;
+        for (int i = 0; i < N; i++) { a[i] = in[i]; b[i] = in[N + i]; }
+
+        Adder<N, NetWire> adder;
+        adder.add(a, b, in[2 * N]);
+
+        std::vector<NetWire> out(adder.sum.begin(), adder.sum.end());
+        out.push_back(adder.carry_out);
+        return out;
+    });
+}
+
+template <int N, template <int, typename> class Adder = RippleCarryAdder>
+Netlist alu_netlist() {
+    return capture_netlist(2 * N + 2, [](const std::vector<NetWire>& in) {
+        std::array<NetWire, N> a, b;
+        for (int i = 0; i < N; i++) { a[i] = in[i]; b[i] = in[N + i]; }
+
+        ALU<N, NetWire, Adder> alu;
+        alu.compute(a, b, in[2 * N], in[2 * N + 1]);
+
+        std::vector<NetWire> out(alu.result.begin(), alu.result.end());
+        out.push_back(alu.carry);
+        out.push_back(alu.zero);
+        return out;
+    });
+}
+
+// Control unit outputs, in netlist output order
+template <typename Lane>
+using ControlPin = Lane BasicControlSignals<Lane>::*;
+
+template <typename Lane>
+const std::array<ControlPin<Lane>, 12>& control_pins() {
+    using S = BasicControlSignals<Lane>;
+    static const std::array<ControlPin<Lane>, 12> pins = {
+        &S::reg_write, &S::mem_read, &S::mem_write, &S::alu_op0, &S::alu_op1, &S::alu_src_imm,
+        &S::reg_src_mem, &S::reg_src_imm, &S::pc_jump, &S::flags_write, &S::halt, &S::is_mov,
+    };
+    return pins;
+}
+
+inline Netlist control_unit_netlist() {
+    return capture_netlist(5, [](const std::vector<NetWire>& in) {
+        BasicControlUnit<NetWire> cu;
+        cu.decode({in[0], in[1], in[2], in[3]}, in[4]);
+
+        std::vector<NetWire> out;
+        for (auto pin : control_pins<NetWire>()) out.push_back(cu.signals.*pin);
+        return out;
+    });
+}
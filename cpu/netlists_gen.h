@@ -0,0 +1,396 @@
+#pragma once
+#include "../gates/gates.h"
+
+// Generated by netgen.cpp from the component templates. Do not edit.
+// Pin order is documented in cpu/netlists.h.
+
+// 72 gates, depth 20
+template <typename Lane>
+inline void adder8_net(const Lane* in, Lane* out) {
+    const Lane w2 = in[0];
+    const Lane w3 = in[1];
+    const Lane w4 = in[2];
+    const Lane w5 = in[3];
+    const Lane w6 = in[4];
+    const Lane w7 = in[5];
+    const Lane w8 = in[6];
+    const Lane w9 = in[7];
+    const Lane w10 = in[8];
+    const Lane w11 = in[9];
+    const Lane w12 = in[10];
+    const Lane w13 = in[11];
+    const Lane w14 = in[12];
+    const Lane w15 = in[13];
+    const Lane w16 = in[14];
+    const Lane w17 = in[15];
+    const Lane w18 = in[16];
+    const Lane w19 = gate::AND(w2, w10);
+    const Lane w20 = gate::OR(w2, w10);
+    const Lane w21 = gate::AND(w3, w11);
+    const Lane w22 = gate::OR(w3, w11);
+    const Lane w23 = gate::AND(w4, w12);
+    const Lane w24 = gate::OR(w4, w12);
+    const Lane w25 = gate::AND(w5, w13);
+    const Lane w26 = gate::OR(w5, w13);
+    const Lane w27 = gate::AND(w6, w14);
+    const Lane w28 = gate::OR(w6, w14);
+    const Lane w29 = gate::AND(w7, w15);
+    const Lane w30 = gate::OR(w7, w15);
+    const Lane w31 = gate::AND(w8, w16);
+    const Lane w32 = gate::OR(w8, w16);
+    const Lane w33 = gate::AND(w9, w17);
+    const Lane w34 = gate::OR(w9, w17);
+    const Lane w35 = gate::NOT(w19);
+    const Lane w36 = gate::NOT(w21);
+    const Lane w37 = gate::NOT(w23);
+    const Lane w38 = gate::NOT(w25);
+    const Lane w39 = gate::NOT(w27);
+    const Lane w40 = gate::NOT(w29);
+    const Lane w41 = gate::NOT(w31);
+    const Lane w42 = gate::NOT(w33);
+    const Lane w43 = gate::AND(w35, w20);
+    const Lane w44 = gate::AND(w36, w22);
+    const Lane w45 = gate::AND(w37, w24);
+    const Lane w46 = gate::AND(w38, w26);
+    const Lane w47 = gate::AND(w39, w28);
+    const Lane w48 = gate::AND(w40, w30);
+    const Lane w49 = gate::AND(w41, w32);
+    const Lane w50 = gate::AND(w42, w34);
+    const Lane w51 = gate::AND(w18, w43);
+    const Lane w52 = gate::OR(w18, w43);
+    const Lane w53 = gate::NOT(w51);
+    const Lane w54 = gate::OR(w19, w51);
+    const Lane w55 = gate::AND(w53, w52);
+    const Lane w56 = gate::AND(w54, w44);
+    const Lane w57 = gate::OR(w54, w44);
+    const Lane w58 = gate::NOT(w56);
+    const Lane w59 = gate::OR(w21, w56);
+    const Lane w60 = gate::AND(w58, w57);
+    const Lane w61 = gate::AND(w59, w45);
+    const Lane w62 = gate::OR(w59, w45);
+    const Lane w63 = gate::NOT(w61);
+    const Lane w64 = gate::OR(w23, w61);
+    const Lane w65 = gate::AND(w63, w62);
+    const Lane w66 = gate::AND(w64, w46);
+    const Lane w67 = gate::OR(w64, w46);
+    const Lane w68 = gate::NOT(w66);
+    const Lane w69 = gate::OR(w25, w66);
+    const Lane w70 = gate::AND(w68, w67);
+    const Lane w71 = gate::AND(w69, w47);
+    const Lane w72 = gate::OR(w69, w47);
+    const Lane w73 = gate::NOT(w71);
+    const Lane w74 = gate::OR(w27, w71);
+    const Lane w75 = gate::AND(w73, w72);
+    const Lane w76 = gate::AND(w74, w48);
+    const Lane w77 = gate::OR(w74, w48);
+    const Lane w78 = gate::NOT(w76);
+    const Lane w79 = gate::OR(w29, w76);
+    const Lane w80 = gate::AND(w78, w77);
+    const Lane w81 = gate::AND(w79, w49);
+    const Lane w82 = gate::OR(w79, w49);
+    const Lane w83 = gate::NOT(w81);
+    const Lane w84 = gate::OR(w31, w81);
+    const Lane w85 = gate::AND(w83, w82);
+    const Lane w86 = gate::AND(w84, w50);
+    const Lane w87 = gate::OR(w84, w50);
+    const Lane w88 = gate::NOT(w86);
+    const Lane w89 = gate::OR(w33, w86);
+    const Lane w90 = gate::AND(w88, w87);
+    out[0] = w55;
+    out[1] = w60;
+    out[2] = w65;
+    out[3] = w70;
+    out[4] = w75;
+    out[5] = w80;
+    out[6] = w85;
+    out[7] = w90;
+    out[8] = w89;
+}
+
+// 186 gates, depth 27
+template <typename Lane>
+inline void alu8_net(const Lane* in, Lane* out) {
+    const Lane w2 = in[0];
+    const Lane w3 = in[1];
+    const Lane w4 = in[2];
+    const Lane w5 = in[3];
+    const Lane w6 = in[4];
+    const Lane w7 = in[5];
+    const Lane w8 = in[6];
+    const Lane w9 = in[7];
+    const Lane w10 = in[8];
+    const Lane w11 = in[9];
+    const Lane w12 = in[10];
+    const Lane w13 = in[11];
+    const Lane w14 = in[12];
+    const Lane w15 = in[13];
+    const Lane w16 = in[14];
+    const Lane w17 = in[15];
+    const Lane w18 = in[16];
+    const Lane w19 = in[17];
+    const Lane w20 = gate::AND(w10, w18);
+    const Lane w21 = gate::AND(w11, w18);
+    const Lane w22 = gate::AND(w12, w18);
+    const Lane w23 = gate::AND(w13, w18);
+    const Lane w24 = gate::AND(w14, w18);
+    const Lane w25 = gate::AND(w15, w18);
+    const Lane w26 = gate::AND(w16, w18);
+    const Lane w27 = gate::AND(w17, w18);
+    const Lane w28 = gate::OR(w10, w18);
+    const Lane w29 = gate::OR(w11, w18);
+    const Lane w30 = gate::OR(w12, w18);
+    const Lane w31 = gate::OR(w13, w18);
+    const Lane w32 = gate::OR(w14, w18);
+    const Lane w33 = gate::OR(w15, w18);
+    const Lane w34 = gate::OR(w16, w18);
+    const Lane w35 = gate::OR(w17, w18);
+    const Lane w36 = gate::OR(w2, w10);
+    const Lane w37 = gate::OR(w3, w11);
+    const Lane w38 = gate::OR(w4, w12);
+    const Lane w39 = gate::OR(w5, w13);
+    const Lane w40 = gate::OR(w6, w14);
+    const Lane w41 = gate::OR(w7, w15);
+    const Lane w42 = gate::OR(w8, w16);
+    const Lane w43 = gate::OR(w9, w17);
+    const Lane w44 = gate::AND(w2, w10);
+    const Lane w45 = gate::AND(w3, w11);
+    const Lane w46 = gate::AND(w4, w12);
+    const Lane w47 = gate::AND(w5, w13);
+    const Lane w48 = gate::AND(w6, w14);
+    const Lane w49 = gate::AND(w7, w15);
+    const Lane w50 = gate::AND(w8, w16);
+    const Lane w51 = gate::AND(w9, w17);
+    const Lane w52 = gate::NOT(w18);
+    const Lane w53 = gate::NOT(w19);
+    const Lane w54 = gate::NOT(w20);
+    const Lane w55 = gate::NOT(w21);
+    const Lane w56 = gate::NOT(w22);
+    const Lane w57 = gate::NOT(w23);
+    const Lane w58 = gate::NOT(w24);
+    const Lane w59 = gate::NOT(w25);
+    const Lane w60 = gate::NOT(w26);
+    const Lane w61 = gate::NOT(w27);
+    const Lane w62 = gate::AND(w18, w36);
+    const Lane w63 = gate::AND(w18, w37);
+    const Lane w64 = gate::AND(w18, w38);
+    const Lane w65 = gate::AND(w18, w39);
+    const Lane w66 = gate::AND(w18, w40);
+    const Lane w67 = gate::AND(w18, w41);
+    const Lane w68 = gate::AND(w18, w42);
+    const Lane w69 = gate::AND(w18, w43);
+    const Lane w70 = gate::AND(w44, w52);
+    const Lane w71 = gate::AND(w45, w52);
+    const Lane w72 = gate::AND(w46, w52);
+    const Lane w73 = gate::AND(w47, w52);
+    const Lane w74 = gate::AND(w48, w52);
+    const Lane w75 = gate::AND(w49, w52);
+    const Lane w76 = gate::AND(w50, w52);
+    const Lane w77 = gate::AND(w51, w52);
+    const Lane w78 = gate::AND(w54, w28);
+    const Lane w79 = gate::AND(w55, w29);
+    const Lane w80 = gate::AND(w56, w30);
+    const Lane w81 = gate::AND(w57, w31);
+    const Lane w82 = gate::AND(w58, w32);
+    const Lane w83 = gate::AND(w59, w33);
+    const Lane w84 = gate::AND(w60, w34);
+    const Lane w85 = gate::AND(w61, w35);
+    const Lane w86 = gate::OR(w62, w70);
+    const Lane w87 = gate::OR(w63, w71);
+    const Lane w88 = gate::OR(w64, w72);
+    const Lane w89 = gate::OR(w65, w73);
+    const Lane w90 = gate::OR(w66, w74);
+    const Lane w91 = gate::OR(w67, w75);
+    const Lane w92 = gate::OR(w68, w76);
+    const Lane w93 = gate::OR(w69, w77);
+    const Lane w94 = gate::AND(w2, w78);
+    const Lane w95 = gate::OR(w2, w78);
+    const Lane w96 = gate::AND(w3, w79);
+    const Lane w97 = gate::OR(w3, w79);
+    const Lane w98 = gate::AND(w4, w80);
+    const Lane w99 = gate::OR(w4, w80);
+    const Lane w100 = gate::AND(w5, w81);
+    const Lane w101 = gate::OR(w5, w81);
+    const Lane w102 = gate::AND(w6, w82);
+    const Lane w103 = gate::OR(w6, w82);
+    const Lane w104 = gate::AND(w7, w83);
+    const Lane w105 = gate::OR(w7, w83);
+    const Lane w106 = gate::AND(w8, w84);
+    const Lane w107 = gate::OR(w8, w84);
+    const Lane w108 = gate::AND(w9, w85);
+    const Lane w109 = gate::OR(w9, w85);
+    const Lane w110 = gate::AND(w19, w86);
+    const Lane w111 = gate::AND(w19, w87);
+    const Lane w112 = gate::AND(w19, w88);
+    const Lane w113 = gate::AND(w19, w89);
+    const Lane w114 = gate::AND(w19, w90);
+    const Lane w115 = gate::AND(w19, w91);
+    const Lane w116 = gate::AND(w19, w92);
+    const Lane w117 = gate::AND(w19, w93);
+    const Lane w118 = gate::NOT(w94);
+    const Lane w119 = gate::NOT(w96);
+    const Lane w120 = gate::NOT(w98);
+    const Lane w121 = gate::NOT(w100);
+    const Lane w122 = gate::NOT(w102);
+    const Lane w123 = gate::NOT(w104);
+    const Lane w124 = gate::NOT(w106);
+    const Lane w125 = gate::NOT(w108);
+    const Lane w126 = gate::AND(w118, w95);
+    const Lane w127 = gate::AND(w119, w97);
+    const Lane w128 = gate::AND(w120, w99);
+    const Lane w129 = gate::AND(w121, w101);
+    const Lane w130 = gate::AND(w122, w103);
+    const Lane w131 = gate::AND(w123, w105);
+    const Lane w132 = gate::AND(w124, w107);
+    const Lane w133 = gate::AND(w125, w109);
+    const Lane w134 = gate::AND(w18, w126);
+    const Lane w135 = gate::OR(w18, w126);
+    const Lane w136 = gate::NOT(w134);
+    const Lane w137 = gate::OR(w94, w134);
+    const Lane w138 = gate::AND(w136, w135);
+    const Lane w139 = gate::AND(w137, w127);
+    const Lane w140 = gate::OR(w137, w127);
+    const Lane w141 = gate::NOT(w139);
+    const Lane w142 = gate::OR(w96, w139);
+    const Lane w143 = gate::AND(w138, w53);
+    const Lane w144 = gate::AND(w141, w140);
+    const Lane w145 = gate::AND(w142, w128);
+    const Lane w146 = gate::OR(w142, w128);
+    const Lane w147 = gate::OR(w110, w143);
+    const Lane w148 = gate::NOT(w145);
+    const Lane w149 = gate::OR(w98, w145);
+    const Lane w150 = gate::AND(w144, w53);
+    const Lane w151 = gate::NOT(w147);
+    const Lane w152 = gate::AND(w148, w146);
+    const Lane w153 = gate::AND(w149, w129);
+    const Lane w154 = gate::OR(w149, w129);
+    const Lane w155 = gate::OR(w111, w150);
+    const Lane w156 = gate::NOT(w153);
+    const Lane w157 = gate::OR(w100, w153);
+    const Lane w158 = gate::AND(w152, w53);
+    const Lane w159 = gate::NOT(w155);
+    const Lane w160 = gate::AND(w156, w154);
+    const Lane w161 = gate::AND(w157, w130);
+    const Lane w162 = gate::OR(w157, w130);
+    const Lane w163 = gate::OR(w112, w158);
+    const Lane w164 = gate::AND(w151, w159);
+    const Lane w165 = gate::NOT(w161);
+    const Lane w166 = gate::OR(w102, w161);
+    const Lane w167 = gate::AND(w160, w53);
+    const Lane w168 = gate::NOT(w163);
+    const Lane w169 = gate::AND(w165, w162);
+    const Lane w170 = gate::AND(w166, w131);
+    const Lane w171 = gate::OR(w166, w131);
+    const Lane w172 = gate::OR(w113, w167);
+    const Lane w173 = gate::AND(w164, w168);
+    const Lane w174 = gate::NOT(w170);
+    const Lane w175 = gate::OR(w104, w170);
+    const Lane w176 = gate::AND(w169, w53);
+    const Lane w177 = gate::NOT(w172);
+    const Lane w178 = gate::AND(w174, w171);
+    const Lane w179 = gate::AND(w175, w132);
+    const Lane w180 = gate::OR(w175, w132);
+    const Lane w181 = gate::OR(w114, w176);
+    const Lane w182 = gate::AND(w173, w177);
+    const Lane w183 = gate::NOT(w179);
+    const Lane w184 = gate::OR(w106, w179);
+    const Lane w185 = gate::AND(w178, w53);
+    const Lane w186 = gate::NOT(w181);
+    const Lane w187 = gate::AND(w183, w180);
+    const Lane w188 = gate::AND(w184, w133);
+    const Lane w189 = gate::OR(w184, w133);
+    const Lane w190 = gate::OR(w115, w185);
+    const Lane w191 = gate::AND(w182, w186);
+    const Lane w192 = gate::NOT(w188);
+    const Lane w193 = gate::OR(w108, w188);
+    const Lane w194 = gate::AND(w187, w53);
+    const Lane w195 = gate::NOT(w190);
+    const Lane w196 = gate::AND(w192, w189);
+    const Lane w197 = gate::OR(w116, w194);
+    const Lane w198 = gate::AND(w191, w195);
+    const Lane w199 = gate::AND(w193, w53);
+    const Lane w200 = gate::AND(w196, w53);
+    const Lane w201 = gate::NOT(w197);
+    const Lane w202 = gate::OR(w117, w200);
+    const Lane w203 = gate::AND(w198, w201);
+    const Lane w204 = gate::NOT(w202);
+    const Lane w205 = gate::AND(w203, w204);
+    out[0] = w147;
+    out[1] = w155;
+    out[2] = w163;
+    out[3] = w172;
+    out[4] = w181;
+    out[5] = w190;
+    out[6] = w197;
+    out[7] = w202;
+    out[8] = w199;
+    out[9] = w205;
+}
+
+// 47 gates, depth 7
+template <typename Lane>
+inline void control_unit_net(const Lane* in, Lane* out) {
+    const Lane w2 = in[0];
+    const Lane w3 = in[1];
+    const Lane w4 = in[2];
+    const Lane w5 = in[3];
+    const Lane w6 = in[4];
+    const Lane w7 = gate::NOT(w2);
+    const Lane w8 = gate::NOT(w3);
+    const Lane w9 = gate::NOT(w4);
+    const Lane w10 = gate::NOT(w5);
+    const Lane w11 = gate::AND(w2, w3);
+    const Lane w12 = gate::NOT(w6);
+    const Lane w13 = gate::AND(w7, w8);
+    const Lane w14 = gate::AND(w2, w8);
+    const Lane w15 = gate::AND(w3, w7);
+    const Lane w16 = gate::AND(w9, w11);
+    const Lane w17 = gate::AND(w4, w11);
+    const Lane w18 = gate::AND(w13, w9);
+    const Lane w19 = gate::AND(w9, w14);
+    const Lane w20 = gate::AND(w9, w15);
+    const Lane w21 = gate::AND(w10, w16);
+    const Lane w22 = gate::AND(w4, w13);
+    const Lane w23 = gate::AND(w4, w14);
+    const Lane w24 = gate::AND(w4, w15);
+    const Lane w25 = gate::AND(w10, w17);
+    const Lane w26 = gate::AND(w5, w16);
+    const Lane w27 = gate::AND(w5, w17);
+    const Lane w28 = gate::AND(w10, w19);
+    const Lane w29 = gate::AND(w10, w20);
+    const Lane w30 = gate::AND(w10, w22);
+    const Lane w31 = gate::AND(w10, w23);
+    const Lane w32 = gate::AND(w10, w24);
+    const Lane w33 = gate::AND(w5, w18);
+    const Lane w34 = gate::AND(w5, w19);
+    const Lane w35 = gate::AND(w5, w20);
+    const Lane w36 = gate::AND(w5, w22);
+    const Lane w37 = gate::AND(w5, w23);
+    const Lane w38 = gate::AND(w6, w26);
+    const Lane w39 = gate::OR(w33, w37);
+    const Lane w40 = gate::OR(w32, w25);
+    const Lane w41 = gate::OR(w30, w31);
+    const Lane w42 = gate::OR(w28, w29);
+    const Lane w43 = gate::OR(w25, w34);
+    const Lane w44 = gate::AND(w36, w12);
+    const Lane w45 = gate::OR(w34, w37);
+    const Lane w46 = gate::OR(w39, w40);
+    const Lane w47 = gate::OR(w41, w42);
+    const Lane w48 = gate::OR(w31, w43);
+    const Lane w49 = gate::OR(w44, w38);
+    const Lane w50 = gate::OR(w40, w45);
+    const Lane w51 = gate::OR(w46, w47);
+    const Lane w52 = gate::OR(w35, w49);
+    const Lane w53 = gate::OR(w41, w50);
+    out[0] = w51;
+    out[1] = w29;
+    out[2] = w21;
+    out[3] = w48;
+    out[4] = w40;
+    out[5] = w37;
+    out[6] = w29;
+    out[7] = w28;
+    out[8] = w52;
+    out[9] = w53;
+    out[10] = w27;
+    out[11] = w33;
+}
@@ -1,17 +1,20 @@
 #pragma once
 #include "../sequential/register.h"
 #include "../arithmetic/adder.h"
+#include "../arithmetic/lookahead_adder.h"
 #include "../arithmetic/mux.h"
 #include <array>
 #include <cstdint>
 
 // 16-bit program counter. Increments by 3 (24-bit instructions) or loads a jump address.
+// Adder is the incrementer's adder circuit (see arithmetic/lookahead_adder.h).
 
-class ProgramCounter {
+template <template <int, typename> class Adder>
+class BasicProgramCounter {
 public:
-    std::array<bool, 16> value = {};
+    Bits<16> value = {};
 
-    void clock(bool clk, bool jump, const std::array<bool, 16>& jump_addr) {
+    void clock(bool clk, bool jump, const Bits<16>& jump_addr) {
         adder.add(value, three);
         mux.select(jump, adder.sum, jump_addr);
         reg.clock(clk, true, mux.output);
@@ -20,23 +23,19 @@ public:
 
     void reset() {
         value = {};
-        std::array<bool, 16> zero = {};
+        Bits<16> zero = {};
         reg.clock(false, true, zero);
         reg.clock(true, true, zero);
         value = reg.data_out;
     }
 
-    uint16_t to_int() const {
-        uint16_t v = 0;
-        for (int i = 0; i < 16; i++)
-            if (value[i]) v |= (1 << i);
-        return v;
-    }
+    uint16_t to_int() const { return value.to_int(); }
 
 private:
     Register<16> reg;
-    RippleCarryAdder<16> adder;
+    Adder<16, bool> adder;
     Mux2<16> mux;
-    static constexpr std::array<bool, 16> three = {true, true, false, false, false, false, false, false,
-                                                    false, false, false, false, false, false, false, false};
+    static constexpr Bits<16> three = Bits<16>(3);
 };
+
+using ProgramCounter = BasicProgramCounter<RippleCarryAdder>;
@@ -20,14 +20,14 @@
 
 class RegisterFile {
 public:
-    std::array<bool, 8> rd_out = {};
-    std::array<bool, 8> rs_out = {};
+    Bits<8> rd_out = {};
+    Bits<8> rs_out = {};
 
     // Read two registers simultaneously.
     // rd_sel picks which register appears on rd_out.
     // rs_sel picks which register appears on rs_out.
-    void read(const std::array<bool, 2>& rd_sel,
-              const std::array<bool, 2>& rs_sel) {
+    void read(const Bits<2>& rd_sel,
+              const Bits<2>& rs_sel) {
         rd_mux.select(rd_sel[0], rd_sel[1],
                       regs[0].data_out, regs[1].data_out,
                       regs[2].data_out, regs[3].data_out);
@@ -42,20 +42,15 @@ public:
     // The decoder converts the 2-bit sel into a one-hot signal,
     // so only the selected register's load enable goes high.
     // write_en gates the whole thing — if false, nothing writes.
-    void write(bool clk, const std::array<bool, 2>& sel,
-               bool write_en, const std::array<bool, 8>& data) {
+    void write(bool clk, const Bits<2>& sel,
+               bool write_en, const Bits<8>& data) {
         dec.decode(sel, write_en);
         for (int i = 0; i < 4; i++) {
             regs[i].clock(clk, dec.outputs[i], data);
         }
     }
 
-    uint8_t get_reg(int i) const {
-        uint8_t val = 0;
-        for (int b = 0; b < 8; b++)
-            if (regs[i].data_out[b]) val |= (1 << b);
-        return val;
-    }
+    uint8_t get_reg(int i) const { return regs[i].data_out.to_int(); }
 
 private:
     Register<8> regs[4];
@@ -0,0 +1,175 @@
+#pragma once
+#include "computer.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Record/replay — reproduce a run exactly, and move to any point of it.
+//
+// A Computer is deterministic apart from what the host does to it, so a
+// run is its starting state plus the host's inputs, each stamped with
+// the step count (Computer::get_step_count) it arrived at. The Recorder
+// drives a Computer and logs those inputs: bytes sent to the UART and
+// interrupts raised from outside. It also keeps a checkpoint (a fork(),
+// so copy-on-write) every `interval` steps.
+//
+// A Replayer plays a Recording back on its own Computer. seek() goes to
+// any step count by starting from the nearest checkpoint at or before it
+// and re-executing, applying the logged inputs as it passes them, so
+// stepping back N steps costs at most `interval` steps of execution
+// however long the run is.
+//
+// The Recorder listens on the UART (UartInputListener), so input gets
+// logged whichever way the host sends it: through the Recorder, the
+// UART's own send*/commit_input, or a UartFd. Interrupts raised from
+// outside have to go through the Recorder. Draining UART output isn't
+// an input (the guest can't see the TX buffer), so the host may do
+// that directly on the recording Computer.
+
+struct ReplayEvent {
+    enum Kind : uint8_t { UartInput, UartInputQuiet, Interrupt };
+
+    uint64_t step;     // the Computer's step count when it happened
+    Kind kind;
+    uint8_t value;     // the interrupt number
+    uint32_t length;   // UART input: `length` bytes from Recording::input[offset]
+    uint64_t offset;
+};
+
+struct Recording {
+    std::vector<ReplayEvent> events;                          // in the order they happened
+    std::vector<uint8_t> input;                               // every UART input's bytes, in order
+    std::map<uint64_t, std::unique_ptr<Computer>> checkpoints;   // by step count
+};
+
+class Recorder : private UartInputListener {
+public:
+    static constexpr uint64_t DEFAULT_INTERVAL = 1000000;
+
+    // Records `c` from its current state; keeps a checkpoint of it now
+    explicit Recorder(Computer& c, uint64_t interval = DEFAULT_INTERVAL)
+        : c(c), interval(interval ? interval : 1) {
+        checkpoint();
+        c.get_uart().set_input_listener(this);
+    }
+
+    ~Recorder() override { c.get_uart().set_input_listener(nullptr); }
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // Computer::run, in chunks that stop at each checkpoint
+    void run(uint64_t max_steps) {
+        while (max_steps > 0 && !c.get_cpu().is_halted()) {
+            uint64_t now = c.get_step_count();
+            uint64_t next = (now / interval + 1) * interval;
+            int n = int(std::min<uint64_t>({max_steps, next - now, INT_MAX}));
+            c.run(n);
+            uint64_t done = c.get_step_count() - now;
+            max_steps -= done;
+            if (c.get_step_count() == next) checkpoint();
+            if (done < uint64_t(n)) break;
+        }
+    }
+
+    void step() {
+        c.step();
+        if (c.get_step_count() % interval == 0) checkpoint();
+    }
+
+    // Host inputs: logged, then passed on
+    void send_char(uint8_t ch) { c.get_uart().send_char(ch); }
+    void send_char_quiet(uint8_t ch) { c.get_uart().send_char_quiet(ch); }
+    void send_string(const std::string& s) { c.get_uart().send_string(s); }
+    void raise_interrupt(uint8_t num) {
+        rec.events.push_back({c.get_step_count(), ReplayEvent::Interrupt, num, 0, 0});
+        c.get_cpu().raise_interrupt(num);
+    }
+
+    Computer& computer() { return c; }
+    Recording& recording() { return rec; }
+
+private:
+    Computer& c;
+    uint64_t interval;
+    Recording rec;
+
+    void input(const uint8_t* data, size_t length, bool quiet) override {
+        ReplayEvent::Kind kind = quiet ? ReplayEvent::UartInputQuiet : ReplayEvent::UartInput;
+        rec.events.push_back({c.get_step_count(), kind, 0, uint32_t(length), rec.input.size()});
+        rec.input.insert(rec.input.end(), data, data + length);
+    }
+
+    void checkpoint() {
+        auto& slot = rec.checkpoints[c.get_step_count()];
+        if (!slot) slot = c.fork();
+    }
+};
+
+class Replayer {
+public:
+    // Starts at the recording's first checkpoint. The recording must
+    // outlive the Replayer.
+    explicit Replayer(Recording& rec) : rec(rec) {
+        restore(rec.checkpoints.begin());
+    }
+
+    // Go to step count `target`: after that many steps and every input
+    // logged at it. Targets before the recording's start go to the start.
+    void seek(uint64_t target) {
+        auto cp = rec.checkpoints.upper_bound(target);
+        if (cp != rec.checkpoints.begin()) --cp;
+        uint64_t now = position();
+        if (target < now || cp->first > now) restore(cp);
+        advance(target);
+    }
+
+    void step_back(uint64_t n) {
+        uint64_t now = position();
+        seek(n < now ? now - n : 0);
+    }
+
+    void step_forward(uint64_t n) { seek(position() + n); }
+
+    uint64_t position() const { return c->get_step_count(); }
+    Computer& computer() { return *c; }
+
+private:
+    Recording& rec;
+    std::unique_ptr<Computer> c;
+    size_t next_event = 0;
+
+    void restore(std::map<uint64_t, std::unique_ptr<Computer>>::iterator cp) {
+        c = cp->second->fork();
+        auto first = std::lower_bound(rec.events.begin(), rec.events.end(), cp->first,
+                                      [](const ReplayEvent& e, uint64_t step) { return e.step < step; });
+        next_event = size_t(std::distance(rec.events.begin(), first));
+    }
+
+    // Run to `target`, applying each logged input when the step count
+    // reaches it. A halted core only moves on through step(), which is
+    // the only way the recording could have moved on either.
+    void advance(uint64_t target) {
+        const std::vector<ReplayEvent>& ev = rec.events;
+        while (true) {
+            for (; next_event < ev.size() && ev[next_event].step == position(); next_event++) apply(ev[next_event]);
+            uint64_t now = position();
+            if (now >= target) break;
+            uint64_t stop = next_event < ev.size() ? std::min(target, ev[next_event].step) : target;
+            if (c->get_cpu().is_halted()) c->step();
+            else c->run(int(std::min<uint64_t>(stop - now, INT_MAX)));
+        }
+    }
+
+    void apply(const ReplayEvent& e) {
+        const uint8_t* data = rec.input.data() + e.offset;
+        if (e.kind == ReplayEvent::UartInput) c->get_uart().send(data, e.length);
+        else if (e.kind == ReplayEvent::UartInputQuiet) c->get_uart().send_quiet(data, e.length);
+        else c->get_cpu().raise_interrupt(e.value);
+    }
+};
@@ -0,0 +1,252 @@
+#pragma once
+#include "computer.h"
+#include "../devices/smp_controller.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// SmpComputer — several cores on one Bus, for multiprocessor guests.
+//
+// The cores share RAM (so the IVT too) and the UART, whose interrupts go
+// to core 0. Each core has its own timer at the usual address, and sees
+// the SmpController (devices/smp_controller.h) for its ID, IPIs and
+// atomics. There's no DMA, interrupt controller or bank mapper. Every
+// core starts at PC 0 in the same program, core n with its stack at
+// 0xEFFF - n * STACK_SIZE; the guest tells them apart by ID.
+//
+// I/O address map:
+//   0xF000-0xF001  Timer (each core's own)
+//   0xF002-0xF003  UART  (shared)
+//   0xF040-0xF049  SMP controller (ID, cores, IPI, atomics)
+//
+// Time passes in quanta of `quantum` cycles. In each, every core runs
+// until its own cycle count reaches the end of the quantum (its last
+// instruction may end past it), its timer counting its cycles. IPIs
+// sent during a quantum are delivered after it. Two ways to run:
+//
+//   run()           one host thread runs the cores in turn, core 0
+//                   first, each through the whole quantum. The same
+//                   calls from the same state give the same results.
+//   run_parallel()  one host thread per core, all meeting after each
+//                   quantum. Within a quantum the cores really do run
+//                   at once, so how their loads and stores interleave
+//                   varies from run to run, as on hardware, within the
+//                   memory model in devices/smp_controller.h. FastCPU
+//                   cores only: the others keep decoded or translated
+//                   code that another thread's write would drop under
+//                   them, so with those, or with watchpoints or a
+//                   write log on the bus, this runs as run() does.
+//
+// A smaller quantum keeps the cores' clocks closer together and gets
+// IPIs there sooner; a larger one means fewer meetings.
+
+class SmpComputer {
+public:
+    static constexpr uint32_t TIMER_BASE = Computer::TIMER_BASE;
+    static constexpr uint32_t UART_BASE  = Computer::UART_BASE;
+    static constexpr uint32_t SMP_BASE   = 0xF040;
+    static constexpr uint16_t STACK_SIZE = 0x100;
+    static constexpr uint32_t DEFAULT_QUANTUM = 1000;
+
+    // 1 to SmpController::MAX_CORES cores
+    SmpComputer(int num_cores, CoreType type = CoreType::Fast) : core_type(type) {
+        int n = std::max(1, std::min(num_cores, SmpController::MAX_CORES));
+        std::vector<Device*> timers;
+        for (int i = 0; i < n; i++) {
+            nodes.push_back(std::make_unique<Node>(type, bus));
+            nodes.back()->sched.add(nodes.back()->timer);
+            timers.push_back(&nodes.back()->timer);
+        }
+        uart = std::make_unique<UART>(*nodes[0]->cpu);
+        uart_port = std::make_unique<Serialized>(*uart);
+        smp = std::make_unique<SmpController>(bus, n);
+        timer_port = std::make_unique<CoreLocal>(*smp, timers);
+        bus.map_device(TIMER_BASE, 2, *timer_port);
+        bus.map_device(UART_BASE, 2, *uart_port);
+        bus.map_device(SMP_BASE, 10, *smp);
+        reset();
+    }
+
+    SmpComputer(const SmpComputer&) = delete;
+    SmpComputer& operator=(const SmpComputer&) = delete;
+
+    void load_program(const uint8_t* data, size_t length, uint32_t addr = 0) {
+        bus.load(addr, data, length);
+    }
+
+    // Every core back to PC 0 with its own stack
+    void reset() {
+        for (size_t i = 0; i < nodes.size(); i++) {
+            Core& cpu = *nodes[i]->cpu;
+            cpu.reset();
+            CoreState s = cpu.get_state();
+            s.sp = uint16_t(0xEFFF - i * STACK_SIZE);
+            cpu.set_state(s);
+        }
+    }
+
+    // Run whole quanta, one core after another, until max_cycles have
+    // passed or every core has halted
+    StopReason run(uint64_t max_cycles) {
+        uint64_t end = until(max_cycles);
+        while (now < end && !all_halted()) {
+            uint64_t target = std::min(now + quantum, end);
+            for (size_t i = 0; i < nodes.size(); i++) run_core(i, target);
+            end_quantum(target);
+        }
+        smp->set_current(0);
+        return all_halted() ? StopReason::Halted : StopReason::Budget;
+    }
+
+    // The same, with each core on its own host thread (the calling
+    // thread runs core 0)
+    StopReason run_parallel(uint64_t max_cycles) {
+        if (core_type != CoreType::Fast || nodes.size() == 1) return run(max_cycles);
+        uint64_t end = until(max_cycles);
+        if (now >= end || all_halted()) return all_halted() ? StopReason::Halted : StopReason::Budget;
+        if (!bus.share_ram()) return run(max_cycles);   // watchpoints or a write log
+
+        std::mutex m;
+        std::condition_variable cv;
+        size_t arrived = 0;
+        uint64_t quanta = 0;
+        bool done = false;
+        uint64_t target = std::min(now + quantum, end);
+
+        // The last core to finish a quantum ends it and starts the next
+        auto worker = [&](size_t i) {
+            uint64_t t = target;
+            for (uint64_t seen = 0;;) {
+                run_core(i, t);
+                std::unique_lock<std::mutex> lock(m);
+                if (++arrived == nodes.size()) {
+                    arrived = 0;
+                    end_quantum(t);
+                    done = now >= end || all_halted();
+                    target = std::min(now + quantum, end);
+                    quanta++;
+                    cv.notify_all();
+                } else {
+                    cv.wait(lock, [&] { return quanta != seen; });
+                }
+                seen = quanta;
+                if (done) return;
+                t = target;
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < nodes.size(); i++) threads.emplace_back(worker, i);
+        worker(0);
+        for (auto& t : threads) t.join();
+        bus.unshare_ram();
+        smp->set_current(0);
+        return all_halted() ? StopReason::Halted : StopReason::Budget;
+    }
+
+    bool all_halted() const {
+        for (auto& n : nodes)
+            if (!n->cpu->is_halted()) return false;
+        return true;
+    }
+
+    // Cycles in a quantum (at least 1)
+    void set_quantum(uint32_t cycles) { quantum = std::max<uint32_t>(cycles, 1); }
+    uint32_t get_quantum() const { return quantum; }
+
+    // Cycle costs for every core (see Computer::set_cycle_costs)
+    void set_cycle_costs(const CycleCosts& c) {
+        cycle_table = CycleTable(c);
+        for (auto& n : nodes) n->cpu->set_cycle_table(cycle_table);
+    }
+
+    // The end of the last quantum run: every core's clock is there or
+    // within an instruction past it
+    uint64_t get_time() const { return now; }
+    uint64_t get_step_count(int core) const { return nodes[core]->steps; }
+    uint64_t get_cycle_count(int core) const { return nodes[core]->cycles; }
+
+    int num_cores() const { return int(nodes.size()); }
+    CoreType get_core_type() const { return core_type; }
+    Core& get_cpu(int core) { return *nodes[core]->cpu; }
+    Timer& get_timer(int core) { return nodes[core]->timer; }
+    UART& get_uart() { return *uart; }
+    SmpController& get_smp() { return *smp; }
+    Bus& get_bus() { return bus; }
+
+private:
+    // A core and what's its own
+    struct Node {
+        Node(CoreType type, Bus& bus) : cpu(Computer::make_core(type, bus)), timer(*cpu) {}
+
+        std::unique_ptr<Core> cpu;
+        Timer timer;
+        Scheduler sched;   // the timer
+        uint64_t steps = 0;
+        uint64_t cycles = 0;
+    };
+
+    Bus bus;
+    CoreType core_type;
+    std::vector<std::unique_ptr<Node>> nodes;
+    std::unique_ptr<UART> uart;
+    std::unique_ptr<Serialized> uart_port;
+    std::unique_ptr<CoreLocal> timer_port;
+    std::unique_ptr<SmpController> smp;
+    CycleTable cycle_table;
+    uint32_t quantum = DEFAULT_QUANTUM;
+    uint64_t now = 0;
+
+    uint64_t until(uint64_t max_cycles) const {
+        return max_cycles < UINT64_MAX - now ? now + max_cycles : UINT64_MAX;
+    }
+
+    void end_quantum(uint64_t target) {
+        now = target;
+        uint32_t ipis = smp->take_ipis();
+        for (size_t i = 0; i < nodes.size(); i++)
+            if (ipis & (1u << i)) nodes[i]->cpu->raise_interrupt(SmpController::IPI_INTERRUPT);
+    }
+
+    void run_core(size_t i, uint64_t target) {
+        Node& n = *nodes[i];
+        smp->set_current(int(i));
+        if (core_type == CoreType::Jit) run_node(n, static_cast<JitCPU&>(*n.cpu), target);
+        else if (core_type == CoreType::Threaded) run_node(n, static_cast<ThreadedCPU&>(*n.cpu), target);
+        else if (core_type == CoreType::Fast) run_node(n, static_cast<FastCPU&>(*n.cpu), target);
+        else run_node(n, static_cast<CPU&>(*n.cpu), target);
+    }
+
+    // Computer::run_batched for one core, up to `target` cycles. The
+    // gate CPU has no batches, so every step is an ordinary one.
+    template <typename C>
+    static uint32_t batch(C& core, uint32_t budget, uint32_t& used) { return core.run_batch(budget, used); }
+    static uint32_t batch(CPU&, uint32_t, uint32_t&) { return 0; }
+
+    template <typename C>
+    void run_node(Node& n, C& core, uint64_t target) {
+        while (n.cycles < target && !core.is_halted()) {
+            uint64_t quiet = uint64_t(n.sched.quiet_ticks()) + 1;
+            uint32_t budget = uint32_t(std::min<uint64_t>({target - n.cycles, quiet, 1u << 30}));
+            uint32_t spent = 0;
+            n.steps += batch(core, budget, spent);
+            n.cycles += spent;
+            n.sched.advance(spent);
+            if (spent < budget && !core.is_halted()) {
+                core.step();
+                uint32_t c = core.step_cycles();
+                n.steps++;
+                n.cycles += c;
+                n.sched.advance(c);
+            }
+        }
+        if (n.cycles < target) {   // halted: time still passes for its timer
+            n.sched.advance(uint32_t(target - n.cycles));
+            n.cycles = target;
+        }
+    }
+};
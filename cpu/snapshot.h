@@ -0,0 +1,273 @@
+#pragma once
+#include "computer.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SEEDISA_SNAPSHOT_MMAP 1
+#else
+#define SEEDISA_SNAPSHOT_MMAP 0
+#endif
+
+// Snapshot — saves a Computer to a file and restores it.
+//
+// A snapshot holds the CPU's architectural state (CoreState), the timer,
+// both UART buffers, the DMA, the interrupt controller's registers, the
+// bank windows and RAM. A Full snapshot holds every allocated frame of
+// RAM; a Delta holds only the frames written since the previous
+// snapshot of the same Computer (see Bus dirty tracking), so periodic
+// checkpoints cost what the program changed, not what it has in memory.
+// Saving either kind starts a new dirty interval.
+//
+// Restoring a Full snapshot replaces all of RAM; restoring a Delta
+// applies its frames over what's there, so a chain is restored as its
+// Full snapshot followed by each Delta in order. Restoring also starts
+// a new dirty interval, so checkpoints can continue from there.
+//
+// Restore maps the file rather than reading it (where mmap exists):
+// RAM frames point straight into the mapping and are copied on first
+// write like any shared page, so a frame costs nothing until the
+// program touches it.
+//
+// Save writes VERSION; restore also takes every older version, which
+// lack the devices added since: version 1 has no DMA and no interrupt
+// controller, version 2 no interrupt controller. Those restore to their
+// reset state.
+//
+// File layout, little-endian:
+//   0   "SEEDSNAP"
+//   8   u32 version (1 to VERSION)
+//   12  u32 kind (0 Full, 1 Delta)
+//   16  u32 core type it was saved from (informational; any core restores it)
+//   20  u32 number of frames n
+//   24  CPU: R0-R3, u16 PC, u16 SP, flags (bit 0 Z, 1 C, 2 int_enabled,
+//       3 halted), int_pending
+//   34  timer: reload, counter, flags (bit 0 enabled, 1 fired)
+//   37  bank windows: frame shown in each of the 15 windows
+//   52  UART: u32 length + RX bytes, u32 length + TX bytes
+//   ..  DMA (version 2 up): u16 source, u16 destination, u16 length,
+//       fill, control, u32 cycles left
+//   ..  interrupt controller (version 3 up): control, mask, in service,
+//       8 priorities
+//   ..  n frame numbers, one byte each
+//   then, from the next 4 KB boundary, n frames of 4 KB
+
+class Snapshot {
+public:
+    static constexpr uint32_t VERSION = 3;
+    static constexpr uint32_t ALIGN = Bus::FRAME_SIZE;
+
+    enum class Kind : uint32_t { Full, Delta };
+
+    static bool save(Computer& c, const std::string& path, Kind kind = Kind::Full) {
+        Bus& bus = c.get_bus();
+        const Memory& ram = bus.get_ram();
+        std::vector<uint8_t> frames;
+        for (uint32_t f = 0; f < Bus::NUM_FRAMES; f++) {
+            bool keep = kind == Kind::Full ? ram.is_allocated(f) : bus.is_dirty(f);
+            if (keep) frames.push_back(uint8_t(f));
+        }
+
+        std::vector<uint8_t> head(MAGIC, MAGIC + 8);
+        put32(head, VERSION);
+        put32(head, uint32_t(kind));
+        put32(head, uint32_t(c.get_core_type()));
+        put32(head, uint32_t(frames.size()));
+
+        CoreState s = c.get_cpu().get_state();
+        head.insert(head.end(), s.regs, s.regs + 4);
+        put16(head, s.pc);
+        put16(head, s.sp);
+        head.push_back(s.zero | s.carry << 1 | s.int_enabled << 2 | s.halted << 3);
+        head.push_back(s.int_pending);
+
+        Timer::State t = c.get_timer().get_state();
+        head.push_back(t.reload);
+        head.push_back(t.counter);
+        head.push_back(t.enabled | t.fired << 1);
+
+        for (uint32_t w = 0; w < Bus::NUM_WINDOWS; w++) head.push_back(uint8_t(bus.window_frame(w)));
+
+        UART::State u = c.get_uart().get_state();
+        put_string(head, u.rx);
+        put_string(head, u.tx);
+
+        DMA::State d = c.get_dma().get_state();
+        put16(head, d.src);
+        put16(head, d.dst);
+        put16(head, d.length);
+        head.push_back(d.fill);
+        head.push_back(d.control);
+        put32(head, d.left);
+
+        InterruptController::State ic = c.get_intc().get_state();
+        head.push_back(ic.control);
+        head.push_back(ic.mask);
+        head.push_back(ic.in_service);
+        head.insert(head.end(), ic.prio, ic.prio + MAX_INTERRUPTS);
+
+        head.insert(head.end(), frames.begin(), frames.end());
+        head.resize(align_up(head.size()), 0);
+
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) return false;
+        bool ok = std::fwrite(head.data(), 1, head.size(), f) == head.size();
+        for (uint8_t frame : frames)
+            ok = ok && std::fwrite(ram.page_for_read(frame), 1, ALIGN, f) == ALIGN;
+        ok = std::fclose(f) == 0 && ok;
+        if (ok) bus.clear_dirty();
+        return ok;
+    }
+
+    // Fails (returns false, leaving `c` as it was) if the file can't be
+    // read or isn't a snapshot of version 1 to VERSION
+    static bool restore(Computer& c, const std::string& path) {
+        size_t size = 0;
+        std::shared_ptr<uint8_t> file = open_file(path, size);
+        if (!file) return false;
+
+        Reader in{file.get(), size};
+        uint32_t version = 0, kind = 0, core = 0, n = 0;
+        if (!in.take(8) || std::memcmp(file.get(), MAGIC, 8) != 0) return false;
+        if (!in.get32(version) || version < 1 || version > VERSION) return false;
+        if (!in.get32(kind) || kind > uint32_t(Kind::Delta)) return false;
+        if (!in.get32(core) || !in.get32(n) || n > Bus::NUM_FRAMES) return false;
+
+        CoreState s;
+        uint8_t flags = 0, timer_flags = 0;
+        Timer::State t;
+        uint8_t windows[Bus::NUM_WINDOWS];
+        UART::State u;
+        DMA::State d;
+        InterruptController::State ic;
+        bool ok = in.get(s.regs, 4) && in.get16(s.pc) && in.get16(s.sp) && in.get(&flags, 1)
+               && in.get(&s.int_pending, 1) && in.get(&t.reload, 1) && in.get(&t.counter, 1)
+               && in.get(&timer_flags, 1) && in.get(windows, Bus::NUM_WINDOWS)
+               && in.get_string(u.rx) && in.get_string(u.tx);
+        if (ok && version >= 2)
+            ok = in.get16(d.src) && in.get16(d.dst) && in.get16(d.length) && in.get(&d.fill, 1)
+              && in.get(&d.control, 1) && in.get32(d.left);
+        if (ok && version >= 3)
+            ok = in.get(&ic.control, 1) && in.get(&ic.mask, 1) && in.get(&ic.in_service, 1)
+              && in.get(ic.prio, MAX_INTERRUPTS);
+        const uint8_t* frames = in.at;
+        if (!ok || !in.take(n)) return false;
+        size_t data = align_up(in.at - file.get());
+        if (data + size_t(n) * ALIGN > size) return false;
+
+        s.zero = flags & 1; s.carry = flags & 2; s.int_enabled = flags & 4; s.halted = flags & 8;
+        t.enabled = timer_flags & 1; t.fired = timer_flags & 2;
+
+        Bus& bus = c.get_bus();
+        for (uint32_t w = 0; w < Bus::NUM_WINDOWS; w++) bus.map_window(w, windows[w]);
+        if (kind == uint32_t(Kind::Full)) {
+            bool listed[Bus::NUM_FRAMES] = {};
+            for (uint32_t i = 0; i < n; i++) listed[frames[i]] = true;
+            for (uint32_t f = 0; f < Bus::NUM_FRAMES; f++)
+                if (!listed[f] && bus.get_ram().is_allocated(f)) bus.replace_frame(f, nullptr);
+        }
+        for (uint32_t i = 0; i < n; i++)   // aliases of `file`: the mapping lives while any frame does
+            bus.replace_frame(frames[i], std::shared_ptr<uint8_t>(file, file.get() + data + size_t(i) * ALIGN));
+        bus.clear_dirty();
+
+        c.get_cpu().set_state(s);
+        c.get_timer().set_state(t);
+        c.get_uart().set_state(u);
+        c.get_dma().set_state(d);
+        c.get_intc().set_state(ic);
+        return true;
+    }
+
+private:
+    static constexpr uint8_t MAGIC[8] = {'S', 'E', 'E', 'D', 'S', 'N', 'A', 'P'};
+
+    static size_t align_up(size_t n) { return (n + ALIGN - 1) & ~size_t(ALIGN - 1); }
+
+    static void put16(std::vector<uint8_t>& out, uint16_t v) {
+        out.push_back(v & 0xFF);
+        out.push_back(v >> 8);
+    }
+
+    static void put32(std::vector<uint8_t>& out, uint32_t v) {
+        for (int i = 0; i < 4; i++) out.push_back((v >> (8 * i)) & 0xFF);
+    }
+
+    static void put_string(std::vector<uint8_t>& out, const std::string& s) {
+        put32(out, uint32_t(s.size()));
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    // Bounds-checked little-endian reads from the front of the file
+    struct Reader {
+        const uint8_t* at;
+        size_t left;
+
+        bool take(size_t n) {
+            if (n > left) return false;
+            at += n; left -= n;
+            return true;
+        }
+        bool get(uint8_t* out, size_t n) {
+            if (n > left) return false;
+            std::memcpy(out, at, n);
+            return take(n);
+        }
+        bool get16(uint16_t& v) {
+            uint8_t b[2];
+            if (!get(b, 2)) return false;
+            v = b[0] | b[1] << 8;
+            return true;
+        }
+        bool get32(uint32_t& v) {
+            uint8_t b[4];
+            if (!get(b, 4)) return false;
+            v = b[0] | b[1] << 8 | b[2] << 16 | uint32_t(b[3]) << 24;
+            return true;
+        }
+        bool get_string(std::string& s) {
+            uint32_t n = 0;
+            if (!get32(n) || n > left) return false;
+            s.assign(reinterpret_cast<const char*>(at), n);
+            return take(n);
+        }
+    };
+
+    // The whole file, privately mapped (writable: a frame nobody else
+    // shares is written in place, and the kernel copies that page), or
+    // read into memory where there's no mmap. Null on failure.
+    static std::shared_ptr<uint8_t> open_file(const std::string& path, size_t& size) {
+#if SEEDISA_SNAPSHOT_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+        struct stat st;
+        void* base = MAP_FAILED;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            size = size_t(st.st_size);
+            base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (base == MAP_FAILED) return nullptr;
+        size_t len = size;
+        return std::shared_ptr<uint8_t>(static_cast<uint8_t*>(base), [len](uint8_t* p) { ::munmap(p, len); });
+#else
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return nullptr;
+        std::vector<uint8_t> bytes;
+        uint8_t buf[ALIGN];
+        for (size_t got; (got = std::fread(buf, 1, sizeof buf, f)) > 0; ) bytes.insert(bytes.end(), buf, buf + got);
+        std::fclose(f);
+        if (bytes.empty()) return nullptr;
+        size = bytes.size();
+        std::shared_ptr<uint8_t> out(new uint8_t[size], std::default_delete<uint8_t[]>());
+        std::memcpy(out.get(), bytes.data(), size);
+        return out;
+#endif
+    }
+};
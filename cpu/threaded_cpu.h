@@ -0,0 +1,287 @@
+#pragma once
+#include "fast_cpu.h"
+#include "../memory/bus.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+
+// Threaded-code dispatch uses GCC/Clang's labels-as-values where available.
+// Elsewhere the same handler bodies become cases of a switch in a loop.
+// Define SEEDISA_COMPUTED_GOTO=0 to force the switch version.
+#ifndef SEEDISA_COMPUTED_GOTO
+#if defined(__GNUC__)
+#define SEEDISA_COMPUTED_GOTO 1
+#else
+#define SEEDISA_COMPUTED_GOTO 0
+#endif
+#endif
+
+// ThreadedCPU — FastCPU with a threaded-code execution loop.
+//
+// Guest code is translated, the first time each PC runs, into a Slot:
+// the address of the handler for that exact instruction variant (LDI,
+// LDR, JNZ, ...) plus its pre-extracted operands. run_batch() then
+// executes by jumping from slot to slot — one indirect jump per
+// instruction, no fetch, no decode, no opcode compare chain.
+//
+// Slots live in 256-entry pages allocated when code on that page first
+// runs. They stay coherent through a Bus code watcher, exactly like the
+// gate-level CPU's decode cache.
+//
+// A batch leaves (before executing) anything that could have effects
+// the batch can't see: an I/O access, a stack or IVT access that would
+// land in the I/O page, or fetching from the I/O page. It also stops
+// after STI, RTI and HLT, since those can change whether an interrupt
+// should be taken. The caller single-steps whatever stopped the batch.
+// step() is FastCPU's plain interpreter.
+
+class ThreadedCPU final : public FastCPU {
+public:
+    ThreadedCPU(Bus& bus) : FastCPU(bus) {
+        code_watch = bus.add_code_watcher([this](uint32_t addr) { invalidate(addr); });
+        remap_watch = bus.add_remap_watcher([this](uint32_t addr, uint32_t length) { invalidate_range(addr, length); });
+    }
+
+    ~ThreadedCPU() override {
+        bus.remove_watcher(code_watch);
+        bus.remove_watcher(remap_watch);
+    }
+
+    ThreadedCPU(const ThreadedCPU&) = delete;
+    ThreadedCPU& operator=(const ThreadedCPU&) = delete;
+
+    // Same contract as FastCPU::run_batch: runs while fewer than `budget`
+    // cycles have passed, returns how many instructions completed and
+    // adds their cycles to `used`. Never takes an interrupt: with one
+    // deliverable, returns 0.
+    uint32_t run_batch(uint32_t budget, uint32_t& used) {
+        if (halted || budget == 0) return 0;
+        if (interrupt_ready()) return 0;
+
+        uint32_t n = 0, spent = 0;
+        Slot* s;
+
+#if SEEDISA_COMPUTED_GOTO
+        static const Handler table[] = {
+            &&h_translate, &&h_exit,
+            &&h_nop, &&h_cli, &&h_sti, &&h_rti, &&h_push, &&h_pop, &&h_ret, &&h_swi, &&h_jc, &&h_jnc,
+            &&h_ldi, &&h_ld, &&h_ldr, &&h_st, &&h_str,
+            &&h_add, &&h_sub, &&h_and_, &&h_or_, &&h_mov, &&h_cmp,
+            &&h_jmp, &&h_jz, &&h_jnz, &&h_addi, &&h_call, &&h_hlt,
+        };
+        handlers = table;
+#define HANDLER(name) h_##name:
+#define DISPATCH() goto *s->handler
+#else
+#define HANDLER(name) case H_##name:
+#define DISPATCH() continue
+#endif
+// Instruction finished: count it and its cycles
+#define COUNT() (n++, spent += s->cycles)
+// ...then stop if the budget is spent, or jump to the next slot.
+// (A plain block, not do/while, so the switch version's `continue` reaches the loop.)
+#define NEXT() { COUNT(); if (spent >= budget) goto done; s = &slot(pc); DISPATCH(); }
+
+        s = &slot(pc);
+#if SEEDISA_COMPUTED_GOTO
+        DISPATCH();
+#else
+        for (;;) switch (s->handler) {
+#endif
+        HANDLER(translate)
+            if (pc + 2u >= Bus::IO_BASE) goto done;
+            translate(pc, *s);
+            DISPATCH();
+
+        HANDLER(exit)
+            goto done;
+
+        HANDLER(nop) pc += 3; NEXT();
+        HANDLER(cli) int_enabled = false; pc += 3; NEXT();
+        HANDLER(sti) int_enabled = true; pc += 3; COUNT(); goto done;
+        HANDLER(rti)
+            if (sp + 3u > Bus::IO_BASE) goto done;
+            pc += 3;
+            return_from_interrupt();
+            COUNT(); goto done;
+        HANDLER(push)
+            if (sp < 1 || sp > Bus::IO_BASE) goto done;
+            push_byte(regs[s->rd]); pc += 3; NEXT();
+        HANDLER(pop)
+            if (sp + 1u > Bus::IO_BASE) goto done;
+            regs[s->rd] = pop_byte(); pc += 3; NEXT();
+        HANDLER(ret)
+            if (sp + 2u > Bus::IO_BASE) goto done;
+            pc = pop16(); NEXT();
+        HANDLER(swi)
+            if (sp < 3 || sp > Bus::IO_BASE) goto done;
+            pc += 3;
+            enter_interrupt(s->imm & 0xFF);
+            NEXT();
+        HANDLER(jc) pc = carry ? s->imm : pc + 3; NEXT();
+        HANDLER(jnc) pc = !carry ? s->imm : pc + 3; NEXT();
+
+        HANDLER(ldi) regs[s->rd] = s->imm & 0xFF; pc += 3; NEXT();
+        HANDLER(ld) regs[s->rd] = bus.read_byte(s->imm); pc += 3; NEXT();
+        HANDLER(ldr) {
+            uint16_t addr = (regs[2] << 8) | regs[3];
+            if (addr >= Bus::IO_BASE) goto done;
+            regs[s->rd] = bus.read_byte(addr); pc += 3; NEXT();
+        }
+        HANDLER(st) {
+            uint16_t addr = s->imm;
+            pc += 3;
+            bus.write_byte(addr, regs[s->rd]);
+            NEXT();
+        }
+        HANDLER(str) {
+            uint16_t addr = (regs[2] << 8) | regs[3];
+            if (addr >= Bus::IO_BASE) goto done;
+            pc += 3;
+            bus.write_byte(addr, regs[s->rd]);
+            NEXT();
+        }
+
+        HANDLER(add) {
+            unsigned w = regs[s->rd] + regs[s->rs];
+            regs[s->rd] = w & 0xFF; alu_flags(w, regs[s->rd]);
+            pc += 3; NEXT();
+        }
+        HANDLER(sub) {
+            unsigned w = regs[s->rd] + (uint8_t)~regs[s->rs] + 1;
+            regs[s->rd] = w & 0xFF; alu_flags(w, regs[s->rd]);
+            pc += 3; NEXT();
+        }
+        HANDLER(and_) regs[s->rd] &= regs[s->rs]; alu_flags(0, regs[s->rd]); pc += 3; NEXT();
+        HANDLER(or_) regs[s->rd] |= regs[s->rs]; alu_flags(0, regs[s->rd]); pc += 3; NEXT();
+        HANDLER(mov) regs[s->rd] = regs[s->rs]; pc += 3; NEXT();
+        HANDLER(cmp) {
+            unsigned w = regs[s->rd] + (uint8_t)~regs[s->rs] + 1;
+            alu_flags(w, w & 0xFF);
+            pc += 3; NEXT();
+        }
+        HANDLER(jmp) pc = s->imm; NEXT();
+        HANDLER(jz) pc = zero ? s->imm : pc + 3; NEXT();
+        HANDLER(jnz) pc = !zero ? s->imm : pc + 3; NEXT();
+        HANDLER(addi) {
+            unsigned w = regs[s->rd] + (s->imm & 0xFF);
+            regs[s->rd] = w & 0xFF; alu_flags(w, regs[s->rd]);
+            pc += 3; NEXT();
+        }
+        HANDLER(call) {
+            if (sp < 2 || sp > Bus::IO_BASE) goto done;
+            uint16_t target = s->imm;
+            push16(pc + 3);
+            pc = target;
+            NEXT();
+        }
+        HANDLER(hlt) halted = true; pc += 3; COUNT(); goto done;
+#if !SEEDISA_COMPUTED_GOTO
+        }
+#endif
+
+#undef NEXT
+#undef COUNT
+#undef DISPATCH
+#undef HANDLER
+    done:
+        used += spent;
+        return n;
+    }
+
+    // New costs are baked into every slot: translate again
+    void set_cycle_table(const CycleTable& t) override {
+        FastCPU::set_cycle_table(t);
+        for (auto& page : pages) page.reset();
+    }
+
+private:
+    // Handler ids, in the order of the computed-goto table
+    enum HandlerId : uint8_t {
+        H_translate, H_exit,
+        H_nop, H_cli, H_sti, H_rti, H_push, H_pop, H_ret, H_swi, H_jc, H_jnc,
+        H_ldi, H_ld, H_ldr, H_st, H_str,
+        H_add, H_sub, H_and_, H_or_, H_mov, H_cmp,
+        H_jmp, H_jz, H_jnz, H_addi, H_call, H_hlt,
+    };
+
+#if SEEDISA_COMPUTED_GOTO
+    using Handler = const void*;
+    Handler handler_for(HandlerId id) const { return handlers[id]; }
+#else
+    using Handler = HandlerId;
+    Handler handler_for(HandlerId id) const { return id; }
+#endif
+
+    struct Slot {
+        Handler handler;
+        uint16_t imm;
+        uint8_t rd;
+        uint8_t rs;
+        uint16_t cycles;   // from the cycle table
+    };
+
+    static constexpr int PAGE_SLOTS = 256;
+
+    const Handler* handlers = nullptr;   // set on first run_batch()
+    std::array<std::unique_ptr<Slot[]>, 0x10000 / PAGE_SLOTS> pages;
+    Bus::WatcherId code_watch, remap_watch;
+
+    Slot& slot(uint16_t addr) {
+        auto& page = pages[addr / PAGE_SLOTS];
+        if (!page) {
+            page.reset(new Slot[PAGE_SLOTS]);
+            for (int i = 0; i < PAGE_SLOTS; i++) page[i] = {handler_for(H_translate), 0, 0, 0, 0};
+        }
+        return page[addr % PAGE_SLOTS];
+    }
+
+    // Pick the handler for the instruction at addr and fill in its slot
+    void translate(uint16_t addr, Slot& s) {
+        uint8_t b[3];
+        bus.fetch(addr, b, 3);
+        uint8_t b2 = b[2];
+        uint16_t imm = b[0] | (b[1] << 8);
+        uint8_t op = b2 >> 4;
+        uint8_t rd = (b2 >> 2) & 3;
+        uint8_t rs = b2 & 3;
+
+        static const HandlerId misc[4][4] = {
+            {H_nop, H_cli, H_sti, H_rti},   // rs=0, by rd
+            {H_push, H_push, H_push, H_push},
+            {H_pop, H_pop, H_pop, H_pop},
+            {H_ret, H_swi, H_jc, H_jnc},    // rs=3, by rd
+        };
+        static const HandlerId ops[16] = {
+            H_nop, H_ldi, H_ld, H_st, H_add, H_sub, H_and_, H_or_,
+            H_mov, H_cmp, H_jmp, H_jz, H_jnz, H_addi, H_call, H_hlt,
+        };
+
+        HandlerId id = op == 0 ? misc[rs][rd] : ops[op];
+        if (op == 0x2 && rs == 1) id = H_ldr;
+        if (op == 0x3 && rs == 1) id = H_str;
+
+        // Anything that always touches I/O goes through step()
+        if ((id == H_ld || id == H_st) && imm >= Bus::IO_BASE) id = H_exit;
+        if (id == H_swi && (imm & 0xFF) >= MAX_INTERRUPTS) id = H_exit;   // vector read past the IVT
+
+        s = {handler_for(id), imm, rd, rs, cycles->inst[b2]};
+        bus.mark_code(addr, 3);
+    }
+
+    // A byte changed: every slot whose 3 bytes cover it goes back to translate
+    void invalidate(uint32_t addr) {
+        for (uint32_t back = 0; back < 3; back++) {
+            uint16_t a = (addr - back) & 0xFFFF;
+            auto& page = pages[a / PAGE_SLOTS];
+            if (page) page[a % PAGE_SLOTS].handler = handler_for(H_translate);
+        }
+    }
+
+    // A bank switch: drop every slot in the range, plus the ones
+    // just before it whose instruction runs into it
+    void invalidate_range(uint32_t addr, uint32_t length) {
+        for (uint32_t a = addr; a < addr + length; a += PAGE_SLOTS) pages[(a & 0xFFFF) / PAGE_SLOTS].reset();
+        invalidate(addr);
+    }
+};
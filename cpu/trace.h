@@ -0,0 +1,244 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// TraceRecord — one step of an execution trace, fixed size.
+//
+// A step either executes the instruction at pc or takes an interrupt
+// there (kind INTERRUPT, inst[0] the interrupt number). The rest is the
+// state the step left behind: registers, which of them it changed,
+// flags, SP, and the bytes it wrote (RAM or I/O, in order; an
+// instruction or interrupt entry writes at most three).
+
+struct TraceRecord {
+    static constexpr uint8_t INSTRUCTION = 0;
+    static constexpr uint8_t INTERRUPT = 1;
+    static constexpr size_t SIZE = 20;   // bytes per record in a trace file, before compression
+
+    uint16_t pc = 0;
+    uint8_t inst[3] = {};       // raw instruction bytes
+    uint8_t kind = INSTRUCTION;
+    uint8_t regs[4] = {};       // R0-R3 after the step
+    uint8_t regs_changed = 0;   // bit n: the step changed Rn
+    uint8_t flags = 0;          // after: bit 0 Z, 1 C, 2 int_enabled, 3 halted
+    uint16_t sp = 0;            // after
+    uint16_t mem_addr = 0;      // address of the first byte written
+    uint8_t mem_len = 0;        // bytes written, 0-3
+    uint8_t mem[3] = {};
+
+    // Little-endian, field by field, in declaration order
+    void pack(uint8_t* out) const {
+        out[0] = pc & 0xFF; out[1] = pc >> 8;
+        std::memcpy(out + 2, inst, 3);
+        out[5] = kind;
+        std::memcpy(out + 6, regs, 4);
+        out[10] = regs_changed; out[11] = flags;
+        out[12] = sp & 0xFF; out[13] = sp >> 8;
+        out[14] = mem_addr & 0xFF; out[15] = mem_addr >> 8;
+        out[16] = mem_len;
+        std::memcpy(out + 17, mem, 3);
+    }
+
+    void unpack(const uint8_t* in) {
+        pc = in[0] | in[1] << 8;
+        std::memcpy(inst, in + 2, 3);
+        kind = in[5];
+        std::memcpy(regs, in + 6, 4);
+        regs_changed = in[10]; flags = in[11];
+        sp = in[12] | in[13] << 8;
+        mem_addr = in[14] | in[15] << 8;
+        mem_len = in[16];
+        std::memcpy(mem, in + 17, 3);
+    }
+};
+
+// SpscRing — a fixed-size lock-free queue for one producer thread and
+// one consumer thread. push() and pop() never block: push() fails when
+// the ring is full, pop() when it's empty. The capacity is rounded up to
+// a power of two.
+
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        buf.resize(n);
+        mask = n - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side
+    bool push(const T& v) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail_cache > mask) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (h - tail_cache > mask) return false;
+        }
+        buf[h & mask] = v;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& v) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head_cache) {
+            head_cache = head.load(std::memory_order_acquire);
+            if (t == head_cache) return false;
+        }
+        v = buf[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    std::vector<T> buf;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> head{0};   // next slot to fill
+    size_t tail_cache = 0;                     // producer's last look at tail
+    alignas(64) std::atomic<size_t> tail{0};   // next slot to drain
+    size_t head_cache = 0;                     // consumer's last look at head
+};
+
+// Tracer — streams TraceRecords to a file from a background thread.
+//
+// The emulator thread calls record(), which only ever copies the record
+// into an SpscRing: if the writer has fallen so far behind that the
+// ring is full, the record is dropped and counted instead of waiting.
+// The writer thread drains the ring, compresses and writes the file.
+// stop() (or the destructor) writes out what's left and closes it.
+//
+// File format: "SEEDTRC1", then one entry per record. Each record is
+// XORed with the one before it (as packed by TraceRecord::pack); the
+// entry is a 3-byte mask of which of the 20 XORed bytes are nonzero,
+// followed by those bytes. Consecutive steps mostly differ in a few
+// bytes, so entries are typically a third of a raw record.
+
+class Tracer {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    explicit Tracer(const std::string& path, size_t capacity = DEFAULT_CAPACITY)
+        : ring(capacity), file(std::fopen(path.c_str(), "wb")) {
+        if (!file) return;
+        std::fwrite(MAGIC, 1, 8, file);
+        writer = std::thread([this] { write_loop(); });
+    }
+
+    ~Tracer() { stop(); }
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    // The file opened; if not, records are all dropped
+    bool ok() const { return file != nullptr; }
+
+    // Called by the emulator thread; never blocks
+    void record(const TraceRecord& r) {
+        if (!file || stopping.load(std::memory_order_relaxed) || !ring.push(r))
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Records lost to a full ring (or a file that didn't open)
+    uint64_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+
+    // Records written to the file so far
+    uint64_t written() const { return written_count.load(std::memory_order_relaxed); }
+
+    // Flush everything recorded so far and close the file. Returns
+    // whether every write succeeded.
+    bool stop() {
+        if (!file) return false;
+        stopping.store(true, std::memory_order_release);
+        if (writer.joinable()) writer.join();
+        bool ok = !write_failed && std::fclose(file) == 0;
+        file = nullptr;
+        return ok;
+    }
+
+    // Decode a whole trace file (for analysis tools and tests)
+    static bool read_file(const std::string& path, std::vector<TraceRecord>& out) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        uint8_t magic[8];
+        bool ok = std::fread(magic, 1, 8, f) == 8 && std::memcmp(magic, MAGIC, 8) == 0;
+        uint8_t prev[TraceRecord::SIZE] = {};
+        uint8_t mask[3];
+        while (ok && std::fread(mask, 1, 3, f) == 3) {
+            for (size_t i = 0; ok && i < TraceRecord::SIZE; i++) {
+                if (!(mask[i / 8] >> (i % 8) & 1)) continue;
+                int c = std::fgetc(f);
+                if (c == EOF) ok = false;
+                else prev[i] ^= uint8_t(c);
+            }
+            TraceRecord r;
+            r.unpack(prev);
+            if (ok) out.push_back(r);
+        }
+        std::fclose(f);
+        return ok;
+    }
+
+private:
+    static constexpr char MAGIC[8] = {'S', 'E', 'E', 'D', 'T', 'R', 'C', '1'};
+
+    SpscRing<TraceRecord> ring;
+    FILE* file;
+    std::thread writer;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> dropped_count{0};
+    std::atomic<uint64_t> written_count{0};
+    bool write_failed = false;                 // writer thread only, read after join
+    uint8_t prev[TraceRecord::SIZE] = {};      // writer thread only
+
+    void write_loop() {
+        std::vector<uint8_t> out;
+        while (true) {
+            // Read the flag before draining, so nothing pushed before
+            // stop() is left behind
+            bool last = stopping.load(std::memory_order_acquire);
+            TraceRecord r;
+            uint64_t n = 0;
+            while (ring.pop(r)) {
+                encode(r, out);
+                n++;
+                if (out.size() >= 1 << 16) flush(out);
+            }
+            flush(out);
+            written_count.fetch_add(n, std::memory_order_relaxed);
+            if (last) return;
+            if (n == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    void encode(const TraceRecord& r, std::vector<uint8_t>& out) {
+        uint8_t cur[TraceRecord::SIZE];
+        r.pack(cur);
+        size_t at = out.size();
+        out.resize(at + 3, 0);
+        for (size_t i = 0; i < TraceRecord::SIZE; i++) {
+            uint8_t x = cur[i] ^ prev[i];
+            if (!x) continue;
+            out[at + i / 8] |= 1 << (i % 8);
+            out.push_back(x);
+        }
+        std::memcpy(prev, cur, sizeof prev);
+    }
+
+    void flush(std::vector<uint8_t>& out) {
+        if (out.empty()) return;
+        if (std::fwrite(out.data(), 1, out.size(), file) != out.size()) write_failed = true;
+        out.clear();
+    }
+};
@@ -0,0 +1,174 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <sys/mman.h>
+#define SEEDISA_JIT_X86_64 1
+#else
+#define SEEDISA_JIT_X86_64 0
+#endif
+
+// CodeBuffer — one block of memory the host CPU can execute.
+// Linux x86-64 only; elsewhere (or if the mapping is refused) ok() is false.
+
+class CodeBuffer {
+public:
+    explicit CodeBuffer(size_t size) : cap(size) {
+#if SEEDISA_JIT_X86_64
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE | PROT_EXEC,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED) mem = static_cast<uint8_t*>(p);
+#endif
+    }
+
+    ~CodeBuffer() {
+#if SEEDISA_JIT_X86_64
+        if (mem) munmap(mem, cap);
+#endif
+    }
+
+    CodeBuffer(const CodeBuffer&) = delete;
+    CodeBuffer& operator=(const CodeBuffer&) = delete;
+
+    bool ok() const { return mem != nullptr; }
+    uint8_t* data() const { return mem; }
+    size_t size() const { return cap; }
+
+private:
+    uint8_t* mem = nullptr;
+    size_t cap;
+};
+
+// X86Emitter — just enough of an x86-64 assembler for the JIT.
+//
+// Register conventions inside generated code:
+//   rbx       pointer to the JIT's state struct (addressed as [rbx+disp8])
+//   rbp       remaining cycle budget (ebp)
+//   r12b-r15b guest R0-R3
+//   eax, ecx, edx, esi, edi  scratch / helper-call arguments
+// All of rbx, rbp, r12-r15 are callee-saved, so helper calls keep them.
+
+namespace x86 {
+enum Reg32 { EAX = 0, ECX = 1, EDX = 2, ESI = 6, EDI = 7 };
+enum Cond { C = 0x2, NC = 0x3, Z = 0x4, NZ = 0x5 };   // B/AE/E/NE
+enum AluOp { ADD = 0x00, OR = 0x08, AND = 0x20, SUB = 0x28, CMP = 0x38 };
+}
+
+class X86Emitter {
+public:
+    X86Emitter(uint8_t* start, uint8_t* end) : p(start), limit(end) {}
+
+    uint8_t* here() const { return p; }
+    size_t space() const { return limit - p; }
+
+    // --- Raw bytes ---
+
+    void u8(uint8_t v) { *p++ = v; }
+    void u16(uint16_t v) { std::memcpy(p, &v, 2); p += 2; }
+    void u32(uint32_t v) { std::memcpy(p, &v, 4); p += 4; }
+    void u64(uint64_t v) { std::memcpy(p, &v, 8); p += 8; }
+
+    static uint8_t modrm(int mod, int reg, int rm) { return (mod << 6) | ((reg & 7) << 3) | (rm & 7); }
+
+    // Guest register n lives in r12b+n (needs REX.B / REX.R, low bits 4..7)
+    static int g(int n) { return 4 + n; }
+
+    // --- Guest registers ---
+
+    void mov_g_imm8(int d, uint8_t imm) { u8(0x41); u8(0xB0 + g(d)); u8(imm); }
+    void mov_g_g(int d, int s) { u8(0x45); u8(0x88); u8(modrm(3, g(s), g(d))); }
+    void alu_g_g(x86::AluOp op, int d, int s) { u8(0x45); u8(op); u8(modrm(3, g(s), g(d))); }
+    void add_g_imm8(int d, uint8_t imm) { u8(0x41); u8(0x80); u8(modrm(3, 0, g(d))); u8(imm); }
+    void mov_g_al(int d) { u8(0x41); u8(0x88); u8(modrm(3, x86::EAX, g(d))); }
+    void movzx_r32_g(x86::Reg32 r, int s) { u8(0x41); u8(0x0F); u8(0xB6); u8(modrm(3, r, g(s))); }
+
+    // Load/store all four guest registers from/to [rbx+disp]
+    void load_guest_regs(uint8_t disp) {
+        for (int n = 0; n < 4; n++) { u8(0x44); u8(0x0F); u8(0xB6); u8(modrm(1, g(n), 3)); u8(disp + n); }
+    }
+    void store_guest_regs(uint8_t disp) {
+        for (int n = 0; n < 4; n++) { u8(0x44); u8(0x88); u8(modrm(1, g(n), 3)); u8(disp + n); }
+    }
+
+    // --- State struct at [rbx+disp8] ---
+
+    void setcc_state(x86::Cond cc, uint8_t disp) { u8(0x0F); u8(0x90 | cc); u8(modrm(1, 0, 3)); u8(disp); }
+    void mov_state8_imm(uint8_t disp, uint8_t imm) { u8(0xC6); u8(modrm(1, 0, 3)); u8(disp); u8(imm); }
+    void mov_state16_imm(uint8_t disp, uint16_t imm) { u8(0x66); u8(0xC7); u8(modrm(1, 0, 3)); u8(disp); u16(imm); }
+    void mov_state16_ax(uint8_t disp) { u8(0x66); u8(0x89); u8(modrm(1, x86::EAX, 3)); u8(disp); }
+    void mov_state64_rax(uint8_t disp) { u8(0x48); u8(0x89); u8(modrm(1, x86::EAX, 3)); u8(disp); }
+    void cmp_state8_imm(uint8_t disp, uint8_t imm) { u8(0x80); u8(modrm(1, 7, 3)); u8(disp); u8(imm); }
+    void add_state32_imm(uint8_t disp, uint32_t imm) { u8(0x81); u8(modrm(1, 0, 3)); u8(disp); u32(imm); }
+    void sub_state32_imm(uint8_t disp, uint32_t imm) { u8(0x81); u8(modrm(1, 5, 3)); u8(disp); u32(imm); }
+    void mov_ebp_state(uint8_t disp) { u8(0x8B); u8(modrm(1, 5, 3)); u8(disp); }
+    void mov_state_ebp(uint8_t disp) { u8(0x89); u8(modrm(1, 5, 3)); u8(disp); }
+
+    // --- Scratch registers ---
+
+    void mov_r32_imm(x86::Reg32 r, uint32_t imm) { u8(0xB8 + r); u32(imm); }
+    void mov_esi_eax() { u8(0x89); u8(modrm(3, x86::EAX, x86::ESI)); }
+    void mov_rax_imm64(uint64_t imm) { u8(0x48); u8(0xB8); u64(imm); }
+    void shl_eax_8() { u8(0xC1); u8(0xE0); u8(8); }
+    void or_eax_ecx() { u8(0x09); u8(modrm(3, x86::ECX, x86::EAX)); }
+    void cmp_eax_imm32(uint32_t imm) { u8(0x3D); u32(imm); }
+    void cmp_eax_imm8(int8_t imm) { u8(0x83); u8(modrm(3, 7, x86::EAX)); u8(imm); }
+    void sub_ebp_imm32(uint32_t imm) { u8(0x81); u8(modrm(3, 5, 5)); u32(imm); }
+    void add_ebp_imm32(uint32_t imm) { u8(0x81); u8(modrm(3, 0, 5)); u32(imm); }
+
+    // Call a C function with rdi = state pointer (esi/edx already set)
+    void call_helper(const void* fn) {
+        u8(0x48); u8(0x89); u8(modrm(3, 3, x86::EDI));   // mov rdi, rbx
+        mov_rax_imm64(reinterpret_cast<uint64_t>(fn));
+        u8(0xFF); u8(modrm(3, 2, x86::EAX));              // call rax
+    }
+
+    // --- Control flow. Each returns the address of its rel32 for patching. ---
+
+    uint8_t* jmp_rel32(const uint8_t* target) { u8(0xE9); return rel32(target); }
+    uint8_t* jcc_rel32(x86::Cond cc, const uint8_t* target) { u8(0x0F); u8(0x80 | cc); return rel32(target); }
+
+    static void patch_rel32(uint8_t* site, const uint8_t* target) {
+        int32_t rel = static_cast<int32_t>(target - (site + 4));
+        std::memcpy(site, &rel, 4);
+    }
+
+    // --- Entry / exit ---
+
+    // void enter(State* rdi, const void* rsi): save callee-saved registers,
+    // load guest registers and budget, jump to the block
+    void trampoline(uint8_t regs_disp, uint8_t left_disp) {
+        u8(0x53); u8(0x55);                                 // push rbx; push rbp
+        u8(0x41); u8(0x54); u8(0x41); u8(0x55);             // push r12; push r13
+        u8(0x41); u8(0x56); u8(0x41); u8(0x57);             // push r14; push r15
+        u8(0x48); u8(0x83); u8(0xEC); u8(0x08);             // sub rsp, 8 (keep 16-byte alignment)
+        u8(0x48); u8(0x89); u8(modrm(3, x86::EDI, 3));      // mov rbx, rdi
+        load_guest_regs(regs_disp);
+        mov_ebp_state(left_disp);
+        u8(0xFF); u8(modrm(3, 4, x86::ESI));                // jmp rsi
+    }
+
+    // Every block exit ends up here: write guest registers and budget
+    // back, restore the host's registers, return to the caller of enter()
+    void epilogue(uint8_t regs_disp, uint8_t left_disp) {
+        store_guest_regs(regs_disp);
+        mov_state_ebp(left_disp);
+        u8(0x48); u8(0x83); u8(0xC4); u8(0x08);             // add rsp, 8
+        u8(0x41); u8(0x5F); u8(0x41); u8(0x5E);             // pop r15; pop r14
+        u8(0x41); u8(0x5D); u8(0x41); u8(0x5C);             // pop r13; pop r12
+        u8(0x5D); u8(0x5B);                                 // pop rbp; pop rbx
+        u8(0xC3);                                           // ret
+    }
+
+private:
+    uint8_t* p;
+    uint8_t* limit;
+
+    uint8_t* rel32(const uint8_t* target) {
+        uint8_t* site = p;
+        u32(0);
+        patch_rel32(site, target);
+        return site;
+    }
+};
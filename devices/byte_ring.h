@@ -0,0 +1,110 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+// ByteRing — a fixed-capacity FIFO of bytes.
+//
+// The capacity is rounded up to a power of two and never grows: write()
+// takes what fits and says how much that was. Besides copying in and
+// out, the free space and the queued bytes can be used in place:
+// writable() and readable() hand out the longest contiguous run, and
+// commit() and consume() say how much of it was filled or used. A
+// caller that wants everything calls them again for the part that
+// wrapped round. Single-threaded (SpscRing in cpu/trace.h is the one
+// for two threads).
+
+class ByteRing {
+public:
+    explicit ByteRing(size_t capacity) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        buf.reset(new uint8_t[n]);   // not zeroed: untouched space costs no memory
+        mask = n - 1;
+    }
+
+    size_t capacity() const { return mask + 1; }
+    size_t size() const { return size_t(tail - head); }
+    size_t space() const { return capacity() - size(); }
+    bool empty() const { return head == tail; }
+    bool full() const { return size() == capacity(); }
+
+    void clear() { head = tail = 0; }
+
+    bool push(uint8_t v) {
+        if (full()) return false;
+        buf[tail++ & mask] = v;
+        return true;
+    }
+
+    bool pop(uint8_t& v) {
+        if (empty()) return false;
+        v = buf[head++ & mask];
+        return true;
+    }
+
+    // Append up to `length` bytes; returns how many fitted
+    size_t write(const uint8_t* data, size_t length) {
+        size_t done = 0;
+        while (done < length) {
+            uint8_t* to;
+            size_t n = std::min(writable(to), length - done);
+            if (n == 0) break;
+            std::memcpy(to, data + done, n);
+            commit(n);
+            done += n;
+        }
+        return done;
+    }
+
+    // Remove up to `length` bytes into `out`; returns how many
+    size_t read(uint8_t* out, size_t length) {
+        size_t done = 0;
+        while (done < length) {
+            const uint8_t* from;
+            size_t n = std::min(readable(from), length - done);
+            if (n == 0) break;
+            std::memcpy(out + done, from, n);
+            consume(n);
+            done += n;
+        }
+        return done;
+    }
+
+    // --- In place ---
+
+    // The oldest queued bytes, as one contiguous run
+    size_t readable(const uint8_t*& data) const {
+        size_t at = head & mask;
+        data = buf.get() + at;
+        return std::min(size(), capacity() - at);
+    }
+
+    void consume(size_t n) { head += std::min(n, size()); }
+
+    // Free space after the newest byte, as one contiguous run
+    size_t writable(uint8_t*& data) {
+        size_t at = tail & mask;
+        data = buf.get() + at;
+        return std::min(space(), capacity() - at);
+    }
+
+    void commit(size_t n) { tail += std::min(n, space()); }
+
+    // Everything queued, oldest first, without removing it
+    std::string contents() const {
+        std::string out;
+        out.reserve(size());
+        for (uint64_t i = head; i != tail; i++) out += static_cast<char>(buf[i & mask]);
+        return out;
+    }
+
+private:
+    std::unique_ptr<uint8_t[]> buf;
+    size_t mask = 0;
+    uint64_t head = 0;   // next byte to read
+    uint64_t tail = 0;   // next byte to write
+};
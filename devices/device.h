@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+
+// Device — anything with memory-mapped registers.
+//
+// A device is mapped into the I/O region with Bus::map_device(); the bus
+// then calls read_reg/write_reg with the offset of the accessed byte
+// from the start of the device's range.
+
+class Device {
+public:
+    virtual ~Device() = default;
+
+    virtual uint8_t read_reg(uint8_t reg) = 0;
+    virtual void write_reg(uint8_t reg, uint8_t val) = 0;
+};
+
+// Clocked — a device that does things as time passes, on its own.
+//
+// Time is counted in CPU cycles. Run loops don't tick a clocked device
+// every cycle: they ask how many can pass before it next needs attention
+// (raises an interrupt, or changes anything else the guest could see),
+// run that long, then let the cycles pass in one advance() call.
+//
+// Letting time pass mustn't move that deadline: quiet_ticks() after
+// advance(n) is n less than before. When anything else changes it (a
+// register write, the event itself happening, set_state), the device
+// calls moved() so its Scheduler asks again.
+
+class Clocked {
+public:
+    virtual ~Clocked() = default;
+
+    // Cycles that can pass without anything happening (UINT32_MAX: no
+    // event coming)
+    virtual uint32_t quiet_ticks() const = 0;
+
+    // Let n cycles pass. Same result as n single cycles.
+    virtual void advance(uint32_t n) = 0;
+
+protected:
+    void moved() { if (stale) *stale = true; }
+
+private:
+    friend class Scheduler;
+    bool* stale = nullptr;   // the Scheduler's, once added to one
+};
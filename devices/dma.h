@@ -0,0 +1,137 @@
+#pragma once
+#include "../cpu/core.h"
+#include "../memory/bus.h"
+#include "device.h"
+#include <cstdint>
+#include <vector>
+
+// DMA — moves blocks of memory for the CPU.
+//
+// Registers (I/O offsets from DMA base):
+//   0-1: source address (lo, hi)
+//   2-3: destination address (lo, hi)
+//   4-5: length in bytes (lo, hi)
+//   6:   fill value
+//   7:   control/status — bit 0: start (reads: busy), bit 1: fill
+//        instead of copy, bit 2: raise interrupt 3 when done, bit 3:
+//        paced, bit 7: done (reads only)
+//
+// Writing control with bit 0 set starts a transfer: copy `length` bytes
+// from source to destination (as if through a buffer, so overlapping
+// ranges behave like memmove), or fill `length` bytes at destination
+// with the fill value. Any other write to control just clears done.
+// Addresses wrap at 64 KB. The transfer goes through the Bus in bursts,
+// so it sees I/O, banking, watchpoints and code caches like the CPU. It
+// stays out of the bus's write log: a trace shows the CPU's writes only.
+//
+// Unpaced, the whole transfer happens during the store that starts it.
+// Paced, it takes one cycle per byte: busy until then, and the guest
+// sees the destination change all at once when it completes. Starting
+// while busy does nothing. Completing sets done and, with bit 2 set,
+// raises interrupt 3.
+
+class DMA : public Device, public Clocked {
+public:
+    static constexpr uint8_t START = 1, FILL = 2, IRQ = 4, PACED = 8, DONE = 0x80;
+    static constexpr uint8_t INTERRUPT = 3;
+
+    DMA(Bus& bus, Core& cpu) : bus(bus), cpu(cpu) {}
+
+    void write_reg(uint8_t reg, uint8_t val) override {
+        switch (reg) {
+            case 0: src = (src & 0xFF00) | val; return;
+            case 1: src = (src & 0x00FF) | val << 8; return;
+            case 2: dst = (dst & 0xFF00) | val; return;
+            case 3: dst = (dst & 0x00FF) | val << 8; return;
+            case 4: length = (length & 0xFF00) | val; return;
+            case 5: length = (length & 0x00FF) | val << 8; return;
+            case 6: fill = val; return;
+            case 7:
+                if (busy()) return;
+                control = val & (FILL | IRQ | PACED);
+                if (!(val & START)) return;
+                if (control & PACED && length > 0) {
+                    left = length;
+                    moved();
+                } else {
+                    finish();
+                }
+                return;
+        }
+    }
+
+    uint8_t read_reg(uint8_t reg) override {
+        switch (reg) {
+            case 0: return src & 0xFF;
+            case 1: return src >> 8;
+            case 2: return dst & 0xFF;
+            case 3: return dst >> 8;
+            case 4: return length & 0xFF;
+            case 5: return length >> 8;
+            case 6: return fill;
+            case 7: return control | (busy() ? START : 0);
+        }
+        return 0;
+    }
+
+    bool busy() const { return left > 0; }
+
+    // --- Batched time (Clocked) ---
+
+    // A paced transfer completes (and may interrupt) on its last cycle
+    uint32_t quiet_ticks() const override {
+        return busy() ? left - 1 : UINT32_MAX;
+    }
+
+    void advance(uint32_t n) override {
+        if (!busy()) return;
+        if (n < left) { left -= n; return; }
+        left = 0;
+        moved();
+        finish();
+    }
+
+    // --- State (for forks and snapshots) ---
+
+    struct State {
+        uint16_t src = 0;
+        uint16_t dst = 0;
+        uint16_t length = 0;
+        uint8_t fill = 0;
+        uint8_t control = 0;
+        uint32_t left = 0;   // cycles until a paced transfer completes
+    };
+
+    State get_state() const { return {src, dst, length, fill, control, left}; }
+
+    void set_state(const State& s) {
+        src = s.src; dst = s.dst; length = s.length;
+        fill = s.fill; control = s.control; left = s.left;
+        moved();
+    }
+
+private:
+    Bus& bus;
+    Core& cpu;
+    uint16_t src = 0;
+    uint16_t dst = 0;
+    uint16_t length = 0;
+    uint8_t fill = 0;
+    uint8_t control = 0;
+    uint32_t left = 0;
+    std::vector<uint8_t> buf;
+
+    void finish() {
+        left = 1;   // busy while the bus calls back into our registers
+        if (length > 0) {
+            buf.assign(length, fill);
+            if (!(control & FILL)) bus.read(src, buf.data(), length);
+            bus.pause_write_log();
+            bus.write(dst, buf.data(), length);
+            bus.resume_write_log();
+        }
+        left = 0;
+        control |= DONE;
+        if (control & IRQ) cpu.raise_interrupt(INTERRUPT);
+    }
+};
@@ -0,0 +1,192 @@
+#pragma once
+#include "../cpu/core.h"
+#include "device.h"
+#include <cstdint>
+
+// LatencyHistogram — how long something waited, in power-of-two buckets.
+// Bucket 0 counts waits of 0, bucket k waits of 2^(k-1) to 2^k - 1.
+struct LatencyHistogram {
+    static constexpr int BUCKETS = 65;
+
+    uint64_t buckets[BUCKETS] = {};
+    uint64_t samples = 0;
+    uint64_t total = 0;
+    uint64_t max = 0;
+
+    void add(uint64_t v) {
+        buckets[bucket(v)]++;
+        samples++;
+        total += v;
+        if (v > max) max = v;
+    }
+
+    double mean() const { return samples ? double(total) / double(samples) : 0.0; }
+
+    static int bucket(uint64_t v) { return v ? 64 - __builtin_clzll(v) : 0; }
+
+    // Smallest wait that falls in bucket k
+    static uint64_t bucket_floor(int k) { return k ? uint64_t(1) << (k - 1) : 0; }
+};
+
+// InterruptController — masking, priorities and nesting for the CPU's
+// interrupt lines, and a record of how long each interrupt waited.
+//
+// Registers (I/O offsets from controller base):
+//   0:    control — bit 0: enable
+//   1:    mask — bit n set: line n stays pending, not taken
+//   2:    in service (reads) — bit n: the handler for line n hasn't
+//         sent EOI; any write is an EOI for the most urgent of them
+//   3:    pending (reads only) — lines raised and not yet taken
+//   4-11: priority of line 0-7 (0 most urgent, 7 least; ties go to
+//         the lower line). Reset: line n has priority n.
+//
+// Disabled (as at reset), the CPU takes the lowest pending line, as it
+// does with no controller at all. Enabled, it takes the most urgent
+// unmasked pending line, and only if that is strictly more urgent than
+// every line in service. So a handler that runs STI can be interrupted
+// by more urgent lines only; it writes EOI before RTI to let its own
+// and less urgent lines in again. Enabling starts with nothing in
+// service.
+//
+// Picking a line costs two table lookups whatever is pending: best[]
+// holds the most urgent line of every set of lines, and urgent[] the
+// lines more urgent than each priority. Both are rebuilt only when a
+// priority changes.
+//
+// Whether enabled or not, each line's wait from raise_interrupt() to
+// the step that enters its handler is added to two histograms, one in
+// steps and one in cycles, read from the counts the controller is given.
+// A line raised again while pending keeps its first raise time. The
+// histograms aren't part of State: forks and snapshots start empty.
+
+class InterruptController : public Device, public InterruptRouter {
+public:
+    static constexpr uint8_t ENABLE = 1;
+
+    InterruptController(Core& cpu, const uint64_t& steps, const uint64_t& cycles)
+        : cpu(cpu), steps(steps), cycles(cycles) {
+        for (int i = 0; i < MAX_INTERRUPTS; i++) prio[i] = uint8_t(i);
+        rebuild();
+        cpu.set_interrupt_router(this);
+    }
+
+    InterruptController(const InterruptController&) = delete;
+    InterruptController& operator=(const InterruptController&) = delete;
+
+    void write_reg(uint8_t reg, uint8_t val) override {
+        if (reg == 0) {
+            if (val & ENABLE && !(control & ENABLE)) in_service = 0;
+            control = val & ENABLE;
+        } else if (reg == 1) {
+            mask = val;
+        } else if (reg == 2) {
+            if (in_service) in_service &= ~(1 << best[in_service]);
+        } else if (reg >= 4 && reg < 4 + MAX_INTERRUPTS) {
+            prio[reg - 4] = val & 7;
+            rebuild();
+        }
+        update_allowed();
+    }
+
+    uint8_t read_reg(uint8_t reg) override {
+        if (reg == 0) return control;
+        if (reg == 1) return mask;
+        if (reg == 2) return in_service;
+        if (reg == 3) return cpu.get_state().int_pending;
+        if (reg >= 4 && reg < 4 + MAX_INTERRUPTS) return prio[reg - 4];
+        return 0;
+    }
+
+    // --- InterruptRouter ---
+
+    void raised(uint8_t line) override {
+        raised_step[line] = steps;
+        raised_cycle[line] = cycles;
+        stamped |= 1 << line;
+    }
+
+    int select(uint8_t pending) const override {
+        if (!(control & ENABLE)) return __builtin_ctz(pending);
+        return best[pending & ~mask & allowed];
+    }
+
+    void taken(uint8_t line) override {
+        if (stamped & (1 << line)) {
+            stamped &= ~(1 << line);
+            latency_steps[line].add(steps - raised_step[line]);
+            latency_cycles[line].add(cycles - raised_cycle[line]);
+        }
+        if (control & ENABLE) {
+            in_service |= 1 << line;
+            update_allowed();
+        }
+    }
+
+    // --- Latency ---
+
+    const LatencyHistogram& get_latency_steps(int line) const { return latency_steps[line]; }
+    const LatencyHistogram& get_latency_cycles(int line) const { return latency_cycles[line]; }
+
+    void clear_latency() {
+        for (int i = 0; i < MAX_INTERRUPTS; i++) latency_steps[i] = latency_cycles[i] = LatencyHistogram();
+    }
+
+    // --- State (for forks and snapshots) ---
+
+    struct State {
+        uint8_t control = 0;
+        uint8_t mask = 0;
+        uint8_t in_service = 0;
+        uint8_t prio[MAX_INTERRUPTS] = {0, 1, 2, 3, 4, 5, 6, 7};
+    };
+
+    State get_state() const {
+        State s;
+        s.control = control; s.mask = mask; s.in_service = in_service;
+        for (int i = 0; i < MAX_INTERRUPTS; i++) s.prio[i] = prio[i];
+        return s;
+    }
+
+    void set_state(const State& s) {
+        control = s.control & ENABLE; mask = s.mask; in_service = s.in_service;
+        for (int i = 0; i < MAX_INTERRUPTS; i++) prio[i] = s.prio[i] & 7;
+        rebuild();
+        update_allowed();
+    }
+
+private:
+    Core& cpu;
+    const uint64_t& steps;
+    const uint64_t& cycles;
+    uint8_t control = 0;
+    uint8_t mask = 0;
+    uint8_t in_service = 0;
+    uint8_t allowed = 0xFF;   // lines more urgent than everything in service
+    uint8_t prio[MAX_INTERRUPTS];
+    int8_t best[256];         // by set of lines: the most urgent, -1 for none
+    uint8_t urgent[9];        // by priority: the lines more urgent than it
+    uint8_t stamped = 0;      // lines with a raise time to measure from
+    uint64_t raised_step[MAX_INTERRUPTS] = {};
+    uint64_t raised_cycle[MAX_INTERRUPTS] = {};
+    LatencyHistogram latency_steps[MAX_INTERRUPTS];
+    LatencyHistogram latency_cycles[MAX_INTERRUPTS];
+
+    // A set's lowest line against the best of the rest, which are all
+    // higher lines, so ties keep the lower one
+    void rebuild() {
+        best[0] = -1;
+        for (int set = 1; set < 256; set++) {
+            int low = __builtin_ctz(set), rest = best[set & (set - 1)];
+            best[set] = int8_t(rest < 0 || prio[low] <= prio[rest] ? low : rest);
+        }
+        for (int p = 0; p <= 8; p++) {
+            urgent[p] = 0;
+            for (int i = 0; i < MAX_INTERRUPTS; i++)
+                if (prio[i] < p) urgent[p] |= 1 << i;
+        }
+    }
+
+    void update_allowed() {
+        allowed = in_service ? urgent[prio[best[in_service]]] : 0xFF;
+    }
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include "device.h"
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Scheduler — keeps the clocked devices' next deadlines in order.
+//
+// Deadlines are absolute cycle counts, in a priority queue, so the run
+// loop finds out how long the CPU can run undisturbed by looking at the
+// front. Time passing doesn't move a deadline, so advance() leaves the
+// queue alone; a device that changes its own (Clocked::moved) marks it
+// stale, and it's rebuilt the next time someone asks for it. A run of
+// batches that touches no device register asks each device only once.
+
+class Scheduler {
+public:
+    Scheduler() = default;
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    void add(Clocked& dev) {
+        devices.push_back(&dev);
+        dev.stale = &stale;
+        stale = true;
+    }
+
+    // Cycles until the first deadline (UINT32_MAX: none)
+    uint32_t quiet_ticks() {
+        if (stale) rebuild();
+        if (deadlines.empty()) return UINT32_MAX;
+        uint64_t at = deadlines.top().first;
+        if (at <= now) return 0;
+        return at - now < UINT32_MAX ? uint32_t(at - now) : UINT32_MAX;
+    }
+
+    // Let n cycles pass for every device
+    void advance(uint32_t n) {
+        if (n == 0) return;
+        now += n;
+        for (Clocked* d : devices) d->advance(n);
+    }
+
+private:
+    using Deadline = std::pair<uint64_t, size_t>;   // cycle, device index
+
+    std::vector<Clocked*> devices;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines;
+    uint64_t now = 0;
+    bool stale = false;
+
+    void rebuild() {
+        stale = false;
+        deadlines = {};
+        for (size_t i = 0; i < devices.size(); i++) {
+            uint32_t q = devices[i]->quiet_ticks();
+            if (q != UINT32_MAX) deadlines.push({now + q, i});
+        }
+    }
+};
@@ -0,0 +1,163 @@
+#pragma once
+#include "../memory/bus.h"
+#include "device.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// SmpController — what each core of a multi-core system sees of the
+// others: who it is, a way to interrupt them, and atomic memory ops.
+//
+// Registers (I/O offsets from controller base):
+//   0:   core ID (reads only) — the reading core's number, 0 up
+//   1:   number of cores (reads only)
+//   2:   IPI (writes only) — write n to interrupt core n
+//   4-5: atomic address (lo, hi)
+//   6:   compare value
+//   7:   new value
+//   8:   CAS (reads only) — if the byte at the address holds the
+//        compare value, store the new value; returns what it held
+//   9:   TAS (reads only) — store 1 at the address (whatever the new
+//        value register holds); returns what it held
+//
+// Registers 4-7 are each core's own. CAS and TAS are atomic against
+// every other core, including cores on other host threads, so a lock is
+//
+//     acquire: LD R0, [TAS] / CMP R0, 0 / JNZ acquire
+//     release: ST 0 to the lock byte
+//
+// Memory model: with the cores on one host thread, one core's accesses
+// all happen between two of another's. With a thread per core, the bus
+// (see Bus, Threads) makes every load an acquire and every store a
+// release, and CAS and TAS are sequentially consistent. A core's
+// stores reach the others in the order it made them, but its load may
+// be answered before its own earlier store to another address is seen
+// (as on x86). That makes the lock above sound: whatever a core stored
+// holding it is visible to the next core whose TAS sees the release.
+//
+// An IPI raises interrupt IPI_INTERRUPT on the target core, but not at
+// once: sends are collected, and the system delivers them between
+// quanta (take_ipis), the same way whether the cores share a host
+// thread or not. Sending to a core that doesn't exist does nothing.
+//
+// Which core is accessing is per host thread and per controller
+// (set_current), so the system sets it before running each core.
+
+class SmpController : public Device {
+public:
+    static constexpr int MAX_CORES = 32;
+    static constexpr uint8_t IPI_INTERRUPT = 4;
+
+    SmpController(Bus& bus, int num_cores) : bus(bus), cores(num_cores), atomics(num_cores) {}
+
+    ~SmpController() override {
+        for (size_t i = 0; i < running.size(); i++)
+            if (running[i].id == id) { running.erase(running.begin() + i); break; }
+    }
+
+    SmpController(const SmpController&) = delete;
+    SmpController& operator=(const SmpController&) = delete;
+
+    void write_reg(uint8_t reg, uint8_t val) override {
+        Atomic& a = atomics[current()];
+        switch (reg) {
+            case 2: if (val < cores) ipis.fetch_or(1u << val); return;
+            case 4: a.addr = (a.addr & 0xFF00) | val; return;
+            case 5: a.addr = (a.addr & 0x00FF) | val << 8; return;
+            case 6: a.expected = val; return;
+            case 7: a.desired = val; return;
+        }
+    }
+
+    uint8_t read_reg(uint8_t reg) override {
+        Atomic& a = atomics[current()];
+        switch (reg) {
+            case 0: return uint8_t(current());
+            case 1: return uint8_t(cores);
+            case 4: return a.addr & 0xFF;
+            case 5: return a.addr >> 8;
+            case 6: return a.expected;
+            case 7: return a.desired;
+            case 8: return bus.compare_exchange(a.addr, a.expected, a.desired);
+            case 9: return bus.exchange(a.addr, 1);
+        }
+        return 0;
+    }
+
+    // The core running on this host thread (0 until set here)
+    void set_current(int core) {
+        for (Running& r : running)
+            if (r.id == id) { r.core = core; return; }
+        running.push_back({id, core});
+    }
+
+    int current() const {
+        for (const Running& r : running)
+            if (r.id == id) return r.core;
+        return 0;
+    }
+
+    // The IPIs sent since last time: bit n for core n
+    uint32_t take_ipis() { return ipis.exchange(0); }
+
+private:
+    struct Atomic {
+        uint16_t addr = 0;
+        uint8_t expected = 0;
+        uint8_t desired = 0;
+    };
+
+    Bus& bus;
+    int cores;
+    std::vector<Atomic> atomics;   // by core
+    std::atomic<uint32_t> ipis{0};
+
+    // Per host thread: each controller's current core there. Entries are
+    // keyed by an id no other controller ever gets, since only the
+    // destroying thread's entry goes with the controller: another
+    // thread's stale one must not match a new controller at this address.
+    struct Running {
+        uint64_t id;
+        int core;
+    };
+    static inline thread_local std::vector<Running> running;
+    static inline std::atomic<uint64_t> next_id{0};
+    const uint64_t id = next_id++;
+};
+
+// CoreLocal — one I/O range, a device per core behind it: each access
+// goes to the device of the core making it (SmpController::current).
+class CoreLocal : public Device {
+public:
+    CoreLocal(const SmpController& smp, std::vector<Device*> devices) : smp(smp), devices(std::move(devices)) {}
+
+    uint8_t read_reg(uint8_t reg) override { return devices[smp.current()]->read_reg(reg); }
+    void write_reg(uint8_t reg, uint8_t val) override { devices[smp.current()]->write_reg(reg, val); }
+
+private:
+    const SmpController& smp;
+    std::vector<Device*> devices;
+};
+
+// Serialized — a device several host threads may access, one at a time.
+// Host-side calls on the device itself should happen between runs.
+class Serialized : public Device {
+public:
+    explicit Serialized(Device& dev) : dev(dev) {}
+
+    uint8_t read_reg(uint8_t reg) override {
+        std::lock_guard<std::mutex> lock(m);
+        return dev.read_reg(reg);
+    }
+
+    void write_reg(uint8_t reg, uint8_t val) override {
+        std::lock_guard<std::mutex> lock(m);
+        dev.write_reg(reg, val);
+    }
+
+private:
+    Device& dev;
+    std::mutex m;
+};
@@ -1,18 +1,20 @@
 #pragma once
-#include "../cpu/cpu.h"
+#include "../cpu/core.h"
+#include "device.h"
 #include <cstdint>
 
-// Timer device. Counts down each tick, fires interrupt 1 at zero.
+// Timer device. Counts down each tick (one per CPU cycle), fires
+// interrupt 1 at zero.
 //
 // Registers (I/O offsets from timer base):
 //   0: reload value — counter resets to this after firing
 //   1: status/control — bit 0: fired (write 0 to clear), bit 1: enable
 
-class Timer {
+class Timer : public Device, public Clocked {
 public:
-    Timer(CPU& cpu) : cpu(cpu) {}
+    Timer(Core& cpu) : cpu(cpu) {}
 
-    void write_reg(uint8_t reg, uint8_t val) {
+    void write_reg(uint8_t reg, uint8_t val) override {
         if (reg == 0) {
             reload = val;
             counter = val;
@@ -20,28 +22,59 @@ public:
             if (!(val & 1)) fired = false;   // write bit 0 = 0 to ack
             enabled = (val >> 1) & 1;         // bit 1 = enable
         }
+        moved();
     }
 
-    uint8_t read_reg(uint8_t reg) {
+    uint8_t read_reg(uint8_t reg) override {
         if (reg == 0) return counter;
         if (reg == 1) return (fired ? 1 : 0) | (enabled ? 2 : 0);
         return 0;
     }
 
-    void tick() {
-        if (!enabled) return;
-        if (counter > 0) counter--;
-        if (counter == 0) {
-            if (!fired) {
-                fired = true;
-                cpu.raise_interrupt(1);
-            }
-            counter = reload;
+    // --- Batched time (Clocked) ---
+
+    // How many ticks can pass before one of them raises an interrupt.
+    // A fired-but-unacknowledged timer never raises again on its own.
+    uint32_t quiet_ticks() const override {
+        if (!enabled || fired) return UINT32_MAX;
+        return counter > 0 ? counter - 1 : 0;
+    }
+
+    // Apply n ticks at once. Same result as n single ticks.
+    void advance(uint32_t n) override {
+        if (!enabled || n == 0) return;
+        if (n < counter) { counter -= n; return; }
+
+        // Reach zero (a counter already at zero gets there in one tick)
+        n -= counter > 0 ? counter : 1;
+        if (!fired) {
+            fired = true;
+            cpu.raise_interrupt(1);
+            moved();
         }
+        counter = reload;
+        if (reload > 0 && n > 0) counter = reload - (n % reload);
+    }
+
+    // --- State (for forks and snapshots) ---
+
+    struct State {
+        uint8_t reload = 0;
+        uint8_t counter = 0;
+        bool enabled = false;
+        bool fired = false;
+    };
+
+    State get_state() const { return {reload, counter, enabled, fired}; }
+
+    void set_state(const State& s) {
+        reload = s.reload; counter = s.counter;
+        enabled = s.enabled; fired = s.fired;
+        moved();
     }
 
 private:
-    CPU& cpu;
+    Core& cpu;
     uint8_t reload = 0;
     uint8_t counter = 0;
     bool enabled = false;
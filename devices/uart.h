@@ -1,41 +1,61 @@
 #pragma once
-#include "../cpu/cpu.h"
+#include "../cpu/core.h"
+#include "byte_ring.h"
+#include "device.h"
+#include <cstddef>
 #include <cstdint>
-#include <queue>
 #include <string>
 
 // UART — simple serial character I/O device.
 //
 // Registers (I/O offsets from UART base):
 //   0: data — write to transmit, read to receive
-//   1: status — bit 0: RX data available, bit 1: TX ready (always 1)
+//   1: status — bit 0: RX data available, bit 1: TX ready (room in TX)
 //
-// When a character is pushed into the RX buffer from the outside,
-// the device raises interrupt 2 so the CPU knows to read it.
-// Reading the data register when RX has data implicitly consumes
-// one character; if the buffer becomes empty, bit 0 clears.
+// Both directions are ByteRings of fixed capacity. Reading the data
+// register when RX has data implicitly consumes one character; if the
+// buffer becomes empty, bit 0 clears. A character written while TX is
+// full, or sent by the host while RX is full, is dropped and counted.
+//
+// Each host call that puts characters into RX raises interrupt 2 once,
+// however many it put there, and the CPU's pending bit merges calls the
+// guest hasn't got round to yet, so a burst costs the guest one
+// interrupt. Its handler should read while status bit 0 is set.
+//
+// Every host input path (send, send_quiet, the send_char/send_string
+// forms, commit_input) goes through one place, which tells the input
+// listener, if one is set, before the bytes go in.
 
-class UART {
+// UartInputListener — hears about each host input to a UART: the bytes
+// offered, and whether they come with the interrupt. Sending the same
+// bytes the same way to a UART in the same state has the same effect.
+class UartInputListener {
 public:
-    UART(CPU& cpu) : cpu(cpu) {}
+    virtual ~UartInputListener() = default;
 
-    void write_reg(uint8_t reg, uint8_t val) {
-        if (reg == 0) {
-            tx_buf.push(val);
-        }
+    virtual void input(const uint8_t* data, size_t length, bool quiet) = 0;
+};
+
+class UART : public Device {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;   // bytes, each direction
+
+    UART(Core& cpu, size_t capacity = DEFAULT_CAPACITY) : cpu(cpu), rx_buf(capacity), tx_buf(capacity) {}
+
+    void write_reg(uint8_t reg, uint8_t val) override {
+        if (reg == 0 && !tx_buf.push(val)) tx_dropped++;
     }
 
-    uint8_t read_reg(uint8_t reg) {
+    uint8_t read_reg(uint8_t reg) override {
         if (reg == 0) {
-            if (rx_buf.empty()) return 0;
-            uint8_t ch = rx_buf.front();
-            rx_buf.pop();
+            uint8_t ch = 0;
+            rx_buf.pop(ch);
             return ch;
         }
         if (reg == 1) {
             uint8_t status = 0;
             if (!rx_buf.empty()) status |= 1;  // bit 0: RX ready
-            status |= 2;                        // bit 1: TX ready (always)
+            if (!tx_buf.full()) status |= 2;   // bit 1: TX ready
             return status;
         }
         return 0;
@@ -43,48 +63,109 @@ public:
 
     // --- Host-side API (used by test harness / emulator) ---
 
-    // Push a single character into RX (raises interrupt 2)
-    void send_char(uint8_t ch) {
-        rx_buf.push(ch);
-        cpu.raise_interrupt(2);
-    }
+    // Put up to `length` bytes into RX and raise interrupt 2 (once, if
+    // any fitted). Returns how many fitted.
+    size_t send(const uint8_t* data, size_t length) { return receive(data, length, false); }
+
+    // Same without the interrupt (for polled I/O)
+    size_t send_quiet(const uint8_t* data, size_t length) { return receive(data, length, true); }
+
+    void send_char(uint8_t ch) { send(&ch, 1); }
+    void send_char_quiet(uint8_t ch) { send_quiet(&ch, 1); }
 
-    // Push a whole string into RX (one interrupt per char)
     void send_string(const std::string& s) {
-        for (uint8_t ch : s) send_char(ch);
+        send(reinterpret_cast<const uint8_t*>(s.data()), s.size());
     }
 
-    // Push characters without raising interrupts (for polled I/O)
-    void send_char_quiet(uint8_t ch) {
-        rx_buf.push(ch);
+    void send_string_quiet(const std::string& s) {
+        send_quiet(reinterpret_cast<const uint8_t*>(s.data()), s.size());
     }
 
-    void send_string_quiet(const std::string& s) {
-        for (uint8_t ch : s) rx_buf.push(ch);
+    // Fill RX in place: free space as one contiguous run, then
+    // commit_input() with how much of it was filled (raises interrupt 2
+    // if any, unless quiet)
+    size_t input_space(uint8_t*& data) { return rx_buf.writable(data); }
+
+    void commit_input(size_t n, bool quiet = false) {
+        uint8_t* data;
+        rx_buf.writable(data);
+        if (listener && n > 0) listener->input(data, n, quiet);
+        rx_buf.commit(n);
+        if (n > 0 && !quiet) cpu.raise_interrupt(2);
     }
 
-    // Pull one character from TX output
+    // Null for none. Not part of State: a fork has no listener.
+    void set_input_listener(UartInputListener* l) { listener = l; }
+
     bool has_output() const { return !tx_buf.empty(); }
+    size_t output_size() const { return tx_buf.size(); }
+
+    // Read TX in place: the oldest output as one contiguous run, then
+    // consume_output() with how much of it was used
+    size_t output(const uint8_t*& data) const { return tx_buf.readable(data); }
+    void consume_output(size_t n) { tx_buf.consume(n); }
+
+    // Move up to `length` bytes of output into `out`; returns how many
+    size_t recv(uint8_t* out, size_t length) { return tx_buf.read(out, length); }
 
+    // Pull one character from TX output
     uint8_t recv_char() {
-        if (tx_buf.empty()) return 0;
-        uint8_t ch = tx_buf.front();
-        tx_buf.pop();
+        uint8_t ch = 0;
+        tx_buf.pop(ch);
         return ch;
     }
 
     // Drain the entire TX buffer as a string
     std::string recv_string() {
         std::string out;
-        while (!tx_buf.empty()) {
-            out += static_cast<char>(tx_buf.front());
-            tx_buf.pop();
+        out.reserve(tx_buf.size());
+        const uint8_t* data;
+        while (size_t n = tx_buf.readable(data)) {
+            out.append(reinterpret_cast<const char*>(data), n);
+            tx_buf.consume(n);
         }
         return out;
     }
 
+    // Characters lost to a full buffer so far
+    uint64_t get_rx_dropped() const { return rx_dropped; }
+    uint64_t get_tx_dropped() const { return tx_dropped; }
+
+    size_t capacity() const { return rx_buf.capacity(); }
+
+    // --- State (for forks and snapshots) ---
+
+    // Both buffers, oldest character first
+    struct State {
+        std::string rx;
+        std::string tx;
+    };
+
+    State get_state() const {
+        return {rx_buf.contents(), tx_buf.contents()};
+    }
+
+    // Anything past the capacity is left out
+    void set_state(const State& s) {
+        rx_buf.clear();
+        tx_buf.clear();
+        rx_buf.write(reinterpret_cast<const uint8_t*>(s.rx.data()), s.rx.size());
+        tx_buf.write(reinterpret_cast<const uint8_t*>(s.tx.data()), s.tx.size());
+    }
+
 private:
-    CPU& cpu;
-    std::queue<uint8_t> rx_buf;
-    std::queue<uint8_t> tx_buf;
+    Core& cpu;
+    ByteRing rx_buf;
+    ByteRing tx_buf;
+    uint64_t rx_dropped = 0;
+    uint64_t tx_dropped = 0;
+    UartInputListener* listener = nullptr;
+
+    size_t receive(const uint8_t* data, size_t length, bool quiet) {
+        if (listener && length > 0) listener->input(data, length, quiet);
+        size_t n = rx_buf.write(data, length);
+        rx_dropped += length - n;
+        if (n > 0 && !quiet) cpu.raise_interrupt(2);
+        return n;
+    }
 };
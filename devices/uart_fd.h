@@ -0,0 +1,97 @@
+#pragma once
+#include "uart.h"
+#include <cstddef>
+#include <cstdint>
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#define SEEDISA_UART_FD 1
+#else
+#define SEEDISA_UART_FD 0
+#endif
+
+// UartFd — connects a UART to host file descriptors: TX goes out to one,
+// RX comes in from the other. Either may be a pipe, a pty or a socket,
+// and they may be the same descriptor. Pass -1 for a direction that
+// isn't connected.
+//
+// Both descriptors are switched to non-blocking, and pump() moves
+// whatever can move without waiting: the UART's TX ring straight into
+// write(), read() straight into the RX ring (no staging buffer either
+// way). Call it between runs, e.g.
+//
+//     UartFd console(c.get_uart(), STDIN_FILENO, STDOUT_FILENO);
+//     while (!console.closed()) { c.run(100000); console.pump(); }
+//
+// Input is rationed by the RX ring's capacity: what doesn't fit stays
+// in the descriptor for the next pump(). A pump() that brings input
+// raises the UART interrupt; the pending bit makes that one interrupt
+// per pump. It arrives through UART::commit_input, so a Recorder on
+// the Computer logs it like any other input. POSIX only; elsewhere
+// nothing is ever moved.
+
+class UartFd {
+public:
+    UartFd(UART& uart, int in_fd, int out_fd) : uart(uart), in_fd(in_fd), out_fd(out_fd) {
+        set_nonblocking(in_fd);
+        if (out_fd != in_fd) set_nonblocking(out_fd);
+    }
+
+    UartFd(const UartFd&) = delete;
+    UartFd& operator=(const UartFd&) = delete;
+
+    // Move output, then input, as far as they go without blocking.
+    // Returns the number of bytes moved either way.
+    size_t pump() {
+        size_t moved = 0;
+#if SEEDISA_UART_FD
+        if (out_fd >= 0 && !out_failed) {
+            const uint8_t* data;
+            while (size_t n = uart.output(data)) {
+                ssize_t w = ::write(out_fd, data, n);
+                if (w < 0 && errno == EINTR) continue;
+                if (w < 0) { out_failed = errno != EAGAIN && errno != EWOULDBLOCK; break; }
+                uart.consume_output(size_t(w));
+                moved += size_t(w);
+                if (size_t(w) < n) break;   // the descriptor is full for now
+            }
+        }
+        if (in_fd >= 0 && !in_closed) {
+            size_t got = 0;
+            uint8_t* space;
+            while (size_t n = uart.input_space(space)) {
+                ssize_t r = ::read(in_fd, space, n);
+                if (r < 0 && errno == EINTR) continue;
+                if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) in_closed = true;
+                if (r <= 0) break;
+                uart.commit_input(size_t(r));
+                got += size_t(r);
+                if (size_t(r) < n) break;   // drained for now
+            }
+            moved += got;
+        }
+#endif
+        return moved;
+    }
+
+    // Input reached end of file (or failed), or output failed
+    bool closed() const { return in_closed || out_failed; }
+
+private:
+    UART& uart;
+    int in_fd;
+    int out_fd;
+    bool in_closed = false;
+    bool out_failed = false;
+
+    static void set_nonblocking(int fd) {
+#if SEEDISA_UART_FD
+        if (fd < 0) return;
+        int flags = ::fcntl(fd, F_GETFL, 0);
+        if (flags >= 0) ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+#else
+        (void)fd;
+#endif
+    }
+};
@@ -1,7 +1,22 @@
 #pragma once
+#include "profile.h"
+#include <array>
+#include <cstddef>
 
 namespace gate {
 
-inline bool AND(bool a, bool b) { return a && b; }
+inline bool AND(bool a, bool b) { SEEDISA_PROFILE_GATE(bool); return a && b; }
+
+// Bit-sliced: one AND per machine, all lanes at once (see lane.h)
+template <typename Lane>
+inline Lane AND(Lane a, Lane b) { SEEDISA_PROFILE_GATE(Lane); return a & b; }
+
+// A whole bus of unpacked wires, one gate per wire
+template <typename Lane, size_t N>
+inline std::array<Lane, N> AND(const std::array<Lane, N>& a, const std::array<Lane, N>& b) {
+    std::array<Lane, N> out = {};
+    for (size_t i = 0; i < N; i++) out[i] = AND(a[i], b[i]);
+    return out;
+}
 
 } // namespace gate
@@ -0,0 +1,105 @@
+#pragma once
+#include "lane.h"
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+// Bits<N> — an N-bit bus packed into one machine word.
+//
+// Reads and writes of single wires still work (bits[3] = true), so the
+// gate-level loops read the same as with one bool per wire. But the
+// whole bus is also a lane type: gate::AND(a, b) on two Bits<8> is one
+// AND instruction for all 8 wires, and converting to and from an
+// integer is a mask instead of a loop.
+//
+// Wires beyond N are always 0.
+
+template <int N>
+class Bits {
+    static_assert(N > 0 && N <= 64, "Bits<N> holds at most one 64-bit word");
+
+public:
+    using Word = std::conditional_t<(N <= 8), uint8_t,
+                 std::conditional_t<(N <= 16), uint16_t,
+                 std::conditional_t<(N <= 32), uint32_t, uint64_t>>>;
+
+    static constexpr Word MASK = N == 64 ? ~Word(0) : Word((uint64_t(1) << N) - 1);
+
+    // One wire of a non-const bus, assignable like a bool&
+    class Ref {
+    public:
+        Ref(Word& w, int i) : word(w), bit(Word(1) << i) {}
+        Ref& operator=(bool v) { word = v ? (word | bit) : (word & ~bit); return *this; }
+        Ref& operator=(const Ref& other) { return *this = bool(other); }
+        operator bool() const { return word & bit; }
+
+    private:
+        Word& word;
+        Word bit;
+    };
+
+    constexpr Bits() = default;
+    constexpr explicit Bits(uint64_t value) : word(Word(value) & MASK) {}
+
+    explicit Bits(const std::array<bool, N>& wires) {
+        for (int i = 0; i < N; i++) (*this)[i] = wires[i];
+    }
+
+    bool operator[](int i) const { return (word >> i) & 1; }
+    Ref operator[](int i) { return Ref(word, i); }
+
+    static constexpr int size() { return N; }
+    constexpr Word to_int() const { return word; }
+
+    // OR of every wire
+    bool any() const { return word != 0; }
+
+    friend Bits operator&(Bits a, Bits b) { return Bits(a.word & b.word); }
+    friend Bits operator|(Bits a, Bits b) { return Bits(a.word | b.word); }
+    friend Bits operator^(Bits a, Bits b) { return Bits(a.word ^ b.word); }
+    friend Bits operator~(Bits a) { return Bits(Word(~a.word)); }
+    friend bool operator==(Bits a, Bits b) { return a.word == b.word; }
+    friend bool operator!=(Bits a, Bits b) { return a.word != b.word; }
+
+private:
+    Word word = 0;
+};
+
+template <int N>
+struct LaneTraits<Bits<N>> {
+    static constexpr int WIDTH = N;
+    static Bits<N> zeros() { return Bits<N>(); }
+    static Bits<N> ones() { return Bits<N>(Bits<N>::MASK); }
+};
+
+// A bus of unpacked wires is a lane type too (gates apply wire by wire)
+template <typename Lane, size_t N>
+struct LaneTraits<std::array<Lane, N>> {
+    static constexpr int WIDTH = N * LaneTraits<Lane>::WIDTH;
+    static std::array<Lane, N> zeros() { return fill(LaneTraits<Lane>::zeros()); }
+    static std::array<Lane, N> ones() { return fill(LaneTraits<Lane>::ones()); }
+
+private:
+    static std::array<Lane, N> fill(Lane v) {
+        std::array<Lane, N> out;
+        out.fill(v);
+        return out;
+    }
+};
+
+// Wires<N, Lane> — the bus type components use: packed Bits<N> for
+// plain bool wires, one Lane per wire for anything else.
+template <int N, typename Lane>
+using Wires = std::conditional_t<std::is_same<Lane, bool>::value, Bits<N>, std::array<Lane, N>>;
+
+// Fan one wire out to all N wires of a bus
+template <int N, typename Lane>
+inline Wires<N, Lane> fanout(Lane x) {
+    if constexpr (std::is_same<Lane, bool>::value) {
+        return broadcast<Bits<N>>(x);
+    } else {
+        std::array<Lane, N> out;
+        out.fill(x);
+        return out;
+    }
+}
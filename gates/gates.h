@@ -6,3 +6,5 @@
 #include "nand.h"
 #include "nor.h"
 #include "xor.h"
+#include "lane.h"
+#include "bits.h"
@@ -0,0 +1,112 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Lanes — what a "wire" holds.
+//
+// Every gate and component is written once and instantiated over a lane
+// type. With bool a wire is one signal in one machine, exactly as in the
+// book. With uint64_t a wire is 64 signals: bit k belongs to machine k,
+// and one bitwise AND evaluates the same gate in 64 independent machines
+// at once (bit slicing). Where the compiler targets AVX2 or AVX-512,
+// Lane256 and Lane512 do the same for 256 and 512 machines: word w of
+// their words() holds machines 64w to 64w + 63, the same way a uint64_t
+// slice holds 64 (slice_pack below).
+//
+// A lane type needs &, |, ^, ~ and the two constants below.
+
+template <typename Lane>
+struct LaneTraits {
+    static constexpr int WIDTH = 8 * sizeof(Lane);
+    static Lane zeros() { return Lane(0); }
+    static Lane ones() { return ~Lane(0); }
+};
+
+template <>
+struct LaneTraits<bool> {
+    static constexpr int WIDTH = 1;
+    static bool zeros() { return false; }
+    static bool ones() { return true; }
+};
+
+// The same bool in every machine
+template <typename Lane>
+inline Lane broadcast(bool b) {
+    return b ? LaneTraits<Lane>::ones() : LaneTraits<Lane>::zeros();
+}
+
+#if defined(__AVX2__)
+struct Lane256 {
+    __m256i v;
+    Lane256() : v(_mm256_setzero_si256()) {}
+    explicit Lane256(__m256i x) : v(x) {}
+    explicit Lane256(const std::array<uint64_t, 4>& w)
+        : v(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(w.data()))) {}
+    std::array<uint64_t, 4> words() const {
+        std::array<uint64_t, 4> w;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(w.data()), v);
+        return w;
+    }
+    friend Lane256 operator&(Lane256 a, Lane256 b) { return Lane256(_mm256_and_si256(a.v, b.v)); }
+    friend Lane256 operator|(Lane256 a, Lane256 b) { return Lane256(_mm256_or_si256(a.v, b.v)); }
+    friend Lane256 operator^(Lane256 a, Lane256 b) { return Lane256(_mm256_xor_si256(a.v, b.v)); }
+    friend Lane256 operator~(Lane256 a) { return Lane256(_mm256_xor_si256(a.v, _mm256_set1_epi32(-1))); }
+};
+
+template <>
+struct LaneTraits<Lane256> {
+    static constexpr int WIDTH = 256;
+    static Lane256 zeros() { return Lane256(); }
+    static Lane256 ones() { return Lane256(_mm256_set1_epi32(-1)); }
+};
+#endif
+
+#if defined(__AVX512F__)
+struct Lane512 {
+    __m512i v;
+    Lane512() : v(_mm512_setzero_si512()) {}
+    explicit Lane512(__m512i x) : v(x) {}
+    explicit Lane512(const std::array<uint64_t, 8>& w) : v(_mm512_loadu_si512(w.data())) {}
+    std::array<uint64_t, 8> words() const {
+        std::array<uint64_t, 8> w;
+        _mm512_storeu_si512(w.data(), v);
+        return w;
+    }
+    friend Lane512 operator&(Lane512 a, Lane512 b) { return Lane512(_mm512_and_si512(a.v, b.v)); }
+    friend Lane512 operator|(Lane512 a, Lane512 b) { return Lane512(_mm512_or_si512(a.v, b.v)); }
+    friend Lane512 operator^(Lane512 a, Lane512 b) { return Lane512(_mm512_xor_si512(a.v, b.v)); }
+    friend Lane512 operator~(Lane512 a) { return Lane512(_mm512_xor_si512(a.v, _mm512_set1_epi32(-1))); }
+};
+
+template <>
+struct LaneTraits<Lane512> {
+    static constexpr int WIDTH = 512;
+    static Lane512 zeros() { return Lane512(); }
+    static Lane512 ones() { return Lane512(_mm512_set1_epi32(-1)); }
+};
+#endif
+
+// --- Moving values in and out of 64-machine slices ---
+
+// values[k] is machine k's N-bit value; wire i of the result holds bit i
+// of every machine.
+template <int N>
+inline std::array<uint64_t, N> slice_pack(const uint64_t (&values)[64]) {
+    std::array<uint64_t, N> wires = {};
+    for (int k = 0; k < 64; k++)
+        for (int i = 0; i < N; i++)
+            wires[i] |= ((values[k] >> i) & 1) << k;
+    return wires;
+}
+
+// Machine k's N-bit value out of a slice
+template <int N>
+inline uint64_t slice_get(const std::array<uint64_t, N>& wires, int k) {
+    uint64_t v = 0;
+    for (int i = 0; i < N; i++) v |= ((wires[i] >> k) & 1) << i;
+    return v;
+}
@@ -5,6 +5,7 @@
 
 namespace gate {
 
-inline bool NAND(bool a, bool b) { return NOT(AND(a, b)); }
+template <typename Lane>
+inline Lane NAND(Lane a, Lane b) { return NOT(AND(a, b)); }
 
 } // namespace gate
@@ -0,0 +1,224 @@
+#pragma once
+#include "and.h"
+#include "or.h"
+#include "not.h"
+#include "lane.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Netlist — a combinational circuit flattened into a list of gates.
+//
+// The component templates call gates through nested functions and build
+// their sub-components (full adders, decoders, ...) on every evaluation.
+// A Netlist is the same circuit captured once: every gate becomes one
+// NetOp reading two wires and writing a third, sorted by level (a gate's
+// inputs always come from lower levels), so evaluation is a single pass
+// over an array.
+//
+// Wire numbering:
+//   0, 1                      constant 0 and constant 1
+//   2 .. 2+num_inputs-1       circuit inputs
+//   2+num_inputs ..           one per gate, in ops order
+
+struct NetOp {
+    enum Kind : uint8_t { AND, OR, NOT };
+    Kind kind;
+    uint32_t a, b;   // input wires (b unused for NOT)
+};
+
+class Netlist {
+public:
+    static constexpr uint32_t ZERO = 0;
+    static constexpr uint32_t ONE = 1;
+
+    int num_inputs = 0;
+    std::vector<NetOp> ops;            // gate i drives wire first_gate() + i
+    std::vector<uint32_t> outputs;     // wire feeding each circuit output
+    int depth = 0;                     // levels of gates on the longest path
+
+    uint32_t first_gate() const { return 2 + num_inputs; }
+    uint32_t num_wires() const { return first_gate() + ops.size(); }
+    size_t gate_count() const { return ops.size(); }
+
+    // Evaluate with caller-provided scratch of num_wires() lanes.
+    // Works for any lane type, so one pass can evaluate 64 circuits.
+    template <typename Lane>
+    void eval(const Lane* in, Lane* out, Lane* wires) const {
+        wires[ZERO] = LaneTraits<Lane>::zeros();
+        wires[ONE] = LaneTraits<Lane>::ones();
+        for (int i = 0; i < num_inputs; i++) wires[2 + i] = in[i];
+
+        Lane* w = wires + first_gate();
+        for (const NetOp& op : ops) {
+            switch (op.kind) {
+            case NetOp::AND: *w = gate::AND(wires[op.a], wires[op.b]); break;
+            case NetOp::OR:  *w = gate::OR(wires[op.a], wires[op.b]); break;
+            case NetOp::NOT: *w = gate::NOT(wires[op.a]); break;
+            }
+            ++w;
+        }
+        for (size_t i = 0; i < outputs.size(); i++) out[i] = wires[outputs[i]];
+    }
+
+    // Write the circuit as one straight-line C++ function:
+    //   template <typename Lane> inline void name(const Lane* in, Lane* out)
+    void emit_cpp(std::ostream& os, const std::string& name) const {
+        std::vector<bool> used(num_wires(), false);
+        for (const NetOp& op : ops) {
+            used[op.a] = true;
+            if (op.kind != NetOp::NOT) used[op.b] = true;
+        }
+        for (uint32_t o : outputs) used[o] = true;
+
+        os << "// " << gate_count() << " gates, depth " << depth << "\n";
+        os << "template <typename Lane>\n";
+        os << "inline void " << name << "(const Lane* in, Lane* out) {\n";
+        if (used[ZERO]) os << "    const Lane w0 = LaneTraits<Lane>::zeros();\n";
+        if (used[ONE]) os << "    const Lane w1 = LaneTraits<Lane>::ones();\n";
+        for (int i = 0; i < num_inputs; i++)
+            if (used[2 + i]) os << "    const Lane w" << 2 + i << " = in[" << i << "];\n";
+        uint32_t w = first_gate();
+        for (const NetOp& op : ops) {
+            os << "    const Lane w" << w++ << " = ";
+            if (op.kind == NetOp::NOT) os << "gate::NOT(w" << op.a << ");\n";
+            else os << (op.kind == NetOp::AND ? "gate::AND(w" : "gate::OR(w") << op.a << ", w" << op.b << ");\n";
+        }
+        for (size_t i = 0; i < outputs.size(); i++)
+            os << "    out[" << i << "] = w" << outputs[i] << ";\n";
+        os << "}\n";
+    }
+};
+
+// NetWire — a lane type that records instead of computing.
+//
+// Instantiating a component template with NetWire and calling it once
+// runs every gate::AND/OR/NOT against the active NetlistBuilder, which
+// appends the gate and hands back the wire it drives.
+
+struct NetWire {
+    uint32_t id = Netlist::ZERO;
+};
+
+class NetlistBuilder {
+public:
+    // Builder that NetWire operators record into (one capture at a time)
+    static NetlistBuilder*& active() {
+        static thread_local NetlistBuilder* b = nullptr;
+        return b;
+    }
+
+    explicit NetlistBuilder(int num_inputs) { net.num_inputs = num_inputs; }
+
+    NetWire input(int i) const { return {uint32_t(2 + i)}; }
+
+    // Append a gate, folding constants and reusing an identical gate
+    // if one already exists
+    NetWire gate(NetOp::Kind kind, NetWire x, NetWire y = {}) {
+        uint32_t a = x.id, b = y.id;
+        if (kind == NetOp::NOT) {
+            if (a == Netlist::ZERO) return {Netlist::ONE};
+            if (a == Netlist::ONE) return {Netlist::ZERO};
+            if (a >= net.first_gate() && op_at(a).kind == NetOp::NOT) return {op_at(a).a};
+            b = 0;
+        } else {
+            uint32_t absorb = kind == NetOp::AND ? Netlist::ZERO : Netlist::ONE;
+            uint32_t identity = kind == NetOp::AND ? Netlist::ONE : Netlist::ZERO;
+            if (a == absorb || b == absorb) return {absorb};
+            if (a == identity) return {b};
+            if (b == identity || a == b) return {a};
+            if (a > b) std::swap(a, b);
+        }
+
+        uint64_t key = (uint64_t(kind) << 62) | (uint64_t(a) << 31) | b;
+        auto it = seen.find(key);
+        if (it != seen.end()) return {it->second};
+
+        uint32_t w = net.num_wires();
+        net.ops.push_back({kind, a, b});
+        seen.emplace(key, w);
+        return {w};
+    }
+
+    // Drop gates no output depends on, then order the rest by level
+    Netlist finish(const std::vector<NetWire>& outs) {
+        uint32_t first = net.first_gate();
+        size_t n = net.ops.size();
+
+        std::vector<bool> live(n, false);
+        for (const NetWire& o : outs)
+            if (o.id >= first) live[o.id - first] = true;
+        for (size_t i = n; i-- > 0; ) {
+            if (!live[i]) continue;
+            const NetOp& op = net.ops[i];
+            if (op.a >= first) live[op.a - first] = true;
+            if (op.kind != NetOp::NOT && op.b >= first) live[op.b - first] = true;
+        }
+
+        // Recorded order is already topological, so one forward pass
+        // gives each gate its level
+        std::vector<int> level(n, 0);
+        auto level_of = [&](uint32_t w) { return w >= first ? level[w - first] : 0; };
+        std::vector<uint32_t> order;
+        for (size_t i = 0; i < n; i++) {
+            if (!live[i]) continue;
+            const NetOp& op = net.ops[i];
+            level[i] = 1 + std::max(level_of(op.a), op.kind == NetOp::NOT ? 0 : level_of(op.b));
+            order.push_back(i);
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&](uint32_t x, uint32_t y) { return level[x] < level[y]; });
+
+        Netlist out;
+        out.num_inputs = net.num_inputs;
+        std::vector<uint32_t> remap(net.num_wires());
+        for (uint32_t w = 0; w < first; w++) remap[w] = w;
+        for (uint32_t i : order) {
+            NetOp op = net.ops[i];
+            op.a = remap[op.a];
+            op.b = op.kind == NetOp::NOT ? 0 : remap[op.b];
+            remap[first + i] = out.num_wires();
+            out.ops.push_back(op);
+            out.depth = std::max(out.depth, level[i]);
+        }
+        for (const NetWire& o : outs) out.outputs.push_back(remap[o.id]);
+        return out;
+    }
+
+private:
+    Netlist net;
+    std::unordered_map<uint64_t, uint32_t> seen;
+
+    const NetOp& op_at(uint32_t wire) const { return net.ops[wire - net.first_gate()]; }
+};
+
+inline NetWire operator&(NetWire a, NetWire b) { return NetlistBuilder::active()->gate(NetOp::AND, a, b); }
+inline NetWire operator|(NetWire a, NetWire b) { return NetlistBuilder::active()->gate(NetOp::OR, a, b); }
+inline NetWire operator~(NetWire a) { return NetlistBuilder::active()->gate(NetOp::NOT, a); }
+
+template <>
+struct LaneTraits<NetWire> {
+    static constexpr int WIDTH = 1;
+    static NetWire zeros() { return {Netlist::ZERO}; }
+    static NetWire ones() { return {Netlist::ONE}; }
+};
+
+// Capture a circuit: `body` gets the input wires and returns the output
+// wires, calling gates (or NetWire-instantiated components) in between.
+inline Netlist capture_netlist(int num_inputs,
+                               const std::function<std::vector<NetWire>(const std::vector<NetWire>&)>& body) {
+    NetlistBuilder b(num_inputs);
+    NetlistBuilder* outer = NetlistBuilder::active();
+    NetlistBuilder::active() = &b;
+
+    std::vector<NetWire> in;
+    for (int i = 0; i < num_inputs; i++) in.push_back(b.input(i));
+    std::vector<NetWire> outs = body(in);
+
+    NetlistBuilder::active() = outer;
+    return b.finish(outs);
+}
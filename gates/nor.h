@@ -5,6 +5,7 @@
 
 namespace gate {
 
-inline bool NOR(bool a, bool b) { return NOT(OR(a, b)); }
+template <typename Lane>
+inline Lane NOR(Lane a, Lane b) { return NOT(OR(a, b)); }
 
 } // namespace gate
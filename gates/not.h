@@ -1,7 +1,22 @@
 #pragma once
+#include "profile.h"
+#include <array>
+#include <cstddef>
 
 namespace gate {
 
-inline bool NOT(bool a) { return !a; }
+inline bool NOT(bool a) { SEEDISA_PROFILE_GATE(bool); return !a; }
+
+// Bit-sliced: one NOT per machine, all lanes at once (see lane.h)
+template <typename Lane>
+inline Lane NOT(Lane a) { SEEDISA_PROFILE_GATE(Lane); return ~a; }
+
+// A whole bus of unpacked wires, one gate per wire
+template <typename Lane, size_t N>
+inline std::array<Lane, N> NOT(const std::array<Lane, N>& a) {
+    std::array<Lane, N> out = {};
+    for (size_t i = 0; i < N; i++) out[i] = NOT(a[i]);
+    return out;
+}
 
 } // namespace gate
@@ -0,0 +1,135 @@
+#pragma once
+#include "lane.h"
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+// Gate-level profiling. Off unless built with -DSEEDISA_GATE_PROFILE=1;
+// when off, every SEEDISA_PROFILE_* macro expands to nothing.
+//
+// Counts are in wires: a gate, latch or flip-flop over a lane counts
+// LaneTraits<Lane>::WIDTH times. So a gate over a packed Bits<8> counts
+// 8, the same as the 8 one-wire gates of a ripple adder doing the same
+// work, and Register<8> clocks 8 flip-flops. (For a sliced lane that
+// is one per machine: a uint64_t gate counts 64.)
+#ifndef SEEDISA_GATE_PROFILE
+#define SEEDISA_GATE_PROFILE 0
+#endif
+
+// The gate-level CPU's component instances, for attributing work
+enum class Part : uint8_t { Other, RegisterFile, PC, IR, Flags, ALU, ControlUnit, COUNT };
+
+struct GateCounts {
+    uint64_t gates = 0;        // gate::AND/OR/NOT evaluations, per wire
+    uint64_t latches = 0;      // SR latch updates, per wire
+    uint64_t flip_flops = 0;   // D flip-flop clocks, per wire
+
+    GateCounts& operator+=(const GateCounts& o) {
+        gates += o.gates; latches += o.latches; flip_flops += o.flip_flops;
+        return *this;
+    }
+    GateCounts operator-(const GateCounts& o) const {
+        GateCounts d;
+        d.gates = gates - o.gates; d.latches = latches - o.latches; d.flip_flops = flip_flops - o.flip_flops;
+        return d;
+    }
+};
+
+// GateProfile — counters for one thread's gate-level simulation.
+//
+// Every count lands on the current Part (set by PartScope around each
+// component call in the CPU). The CPU also tallies each step's counts
+// under the opcode it executed, so the report shows both which hardware
+// and which instructions the time goes to.
+
+class GateProfile {
+public:
+    static constexpr int IRQ = 16;   // opcode slot for interrupt entry
+
+    static GateProfile& get() {
+        static thread_local GateProfile p;
+        return p;
+    }
+
+    Part current = Part::Other;
+    GateCounts parts[int(Part::COUNT)];
+    GateCounts opcodes[17];
+    uint64_t steps[17] = {};
+
+    GateCounts& here() { return parts[int(current)]; }
+
+    GateCounts total() const {
+        GateCounts t;
+        for (const GateCounts& p : parts) t += p;
+        return t;
+    }
+
+    void reset() { *this = GateProfile(); }
+
+    void report(std::ostream& os) const {
+        static const char* const part_names[] = {
+            "other", "register file", "PC", "IR", "flags", "ALU", "control unit",
+        };
+        static const char* const op_names[] = {
+            "misc", "LDI", "LD", "ST", "ADD", "SUB", "AND", "OR",
+            "MOV", "CMP", "JMP", "JZ", "JNZ", "ADDI", "CALL", "HLT", "(irq)",
+        };
+        auto row = [&](const char* name, const GateCounts& c) {
+            os << "  " << std::left << std::setw(14) << name << std::right
+               << std::setw(14) << c.gates << std::setw(12) << c.latches << std::setw(12) << c.flip_flops;
+        };
+
+        os << "=== gate profile ===\n  " << std::left << std::setw(14) << "component" << std::right
+           << std::setw(14) << "gates" << std::setw(12) << "latches" << std::setw(12) << "flip-flops\n";
+        for (int i = 0; i < int(Part::COUNT); i++) { row(part_names[i], parts[i]); os << "\n"; }
+        row("total", total());
+        os << "\n\n  " << std::left << std::setw(14) << "opcode" << std::right << std::setw(14) << "gates"
+           << std::setw(12) << "latches" << std::setw(12) << "flip-flops" << std::setw(10) << "steps"
+           << std::setw(12) << "gates/step\n";
+        for (int i = 0; i < 17; i++) {
+            if (!steps[i]) continue;
+            row(op_names[i], opcodes[i]);
+            os << std::setw(10) << steps[i] << std::setw(12) << opcodes[i].gates / steps[i] << "\n";
+        }
+    }
+
+    // Makes `p` the current Part until the end of the enclosing block
+    class PartScope {
+    public:
+        explicit PartScope(Part p) : saved(get().current) { get().current = p; }
+        ~PartScope() { get().current = saved; }
+    private:
+        Part saved;
+    };
+
+    // Charges everything counted during one CPU step to an opcode slot
+    class StepScope {
+    public:
+        StepScope() : start(get().total()) {}
+        ~StepScope() {
+            if (slot < 0) return;
+            GateProfile& p = get();
+            p.opcodes[slot] += p.total() - start;
+            p.steps[slot]++;
+        }
+        int slot = -1;
+    private:
+        GateCounts start;
+    };
+};
+
+#if SEEDISA_GATE_PROFILE
+#define SEEDISA_PROFILE_GATE(Lane)     (GateProfile::get().here().gates += LaneTraits<Lane>::WIDTH)
+#define SEEDISA_PROFILE_LATCH(Lane)    (GateProfile::get().here().latches += LaneTraits<Lane>::WIDTH)
+#define SEEDISA_PROFILE_FLIP_FLOP(Lane) (GateProfile::get().here().flip_flops += LaneTraits<Lane>::WIDTH)
+#define SEEDISA_PROFILE_PART(p)        GateProfile::PartScope seedisa_part_scope_(Part::p)
+#define SEEDISA_PROFILE_STEP()         GateProfile::StepScope seedisa_step_scope_
+#define SEEDISA_PROFILE_OPCODE(op)     (seedisa_step_scope_.slot = (op))
+#else
+#define SEEDISA_PROFILE_GATE(Lane)     ((void)0)
+#define SEEDISA_PROFILE_LATCH(Lane)    ((void)0)
+#define SEEDISA_PROFILE_FLIP_FLOP(Lane) ((void)0)
+#define SEEDISA_PROFILE_PART(p)        ((void)0)
+#define SEEDISA_PROFILE_STEP()         ((void)0)
+#define SEEDISA_PROFILE_OPCODE(op)     ((void)0)
+#endif
@@ -6,6 +6,7 @@
 
 namespace gate {
 
-inline bool XOR(bool a, bool b) { return AND(OR(a, b), NAND(a, b)); }
+template <typename Lane>
+inline Lane XOR(Lane a, Lane b) { return AND(OR(a, b), NAND(a, b)); }
 
 } // namespace gate
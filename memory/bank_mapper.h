@@ -0,0 +1,29 @@
+#pragma once
+#include "bus.h"
+#include "../devices/device.h"
+#include <cstdint>
+
+// BankMapper — the guest's view of Bus banking.
+//
+// Registers (I/O offsets from the mapper's base):
+//   0-14: frame shown in window 0-14 (CPU addresses 0x1000*w .. 0x1000*w + 0xFFF)
+//
+// Writing a register switches the window at once, so the next
+// instruction already sees the new frame; reading one returns the frame
+// it shows. Frames are 4 KB, numbered 0-255 across the 1 MB Memory.
+
+class BankMapper : public Device {
+public:
+    explicit BankMapper(Bus& bus) : bus(bus) {}
+
+    uint8_t read_reg(uint8_t reg) override {
+        return reg < Bus::NUM_WINDOWS ? bus.window_frame(reg) : 0;
+    }
+
+    void write_reg(uint8_t reg, uint8_t val) override {
+        if (reg < Bus::NUM_WINDOWS) bus.map_window(reg, val);
+    }
+
+private:
+    Bus& bus;
+};
@@ -1,16 +1,76 @@
 #pragma once
 #include "memory.h"
+#include "../devices/device.h"
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
 #include <functional>
+#include <memory>
+#include <vector>
 
 // System Bus — routes CPU reads/writes to RAM or I/O devices.
 //
 // Memory map (64 KB, matching the CPU's 16-bit address space):
-//   0x0000 – 0xEFFF  (60 KB)  General-purpose RAM
+//   0x0000 – 0xEFFF  (60 KB)  General-purpose RAM, as 15 banked windows
 //   0xF000 – 0xFFFF  (4 KB)   Memory-mapped I/O
 //
-// When the CPU accesses an address in the I/O region,
-// the bus calls the registered device handler instead of RAM.
+// Behind the RAM region is the full 1 MB Memory, in 256 frames of 4 KB.
+// Each 4 KB window of the RAM region shows one frame, chosen with
+// map_window() (the BankMapper device exposes this to the guest). At
+// reset window w shows frame w. Switching a window only repoints 16
+// page-table entries; nothing is copied. Two windows may show the same
+// frame.
+//
+// The address space is a table of 256 pages of 256 bytes. A RAM page
+// holds host pointers to its bytes, so a RAM access is one table load
+// and one indexed load. RAM is sparse (see Memory): until a page is
+// first written its read pointer is Memory's shared zero page and it
+// has no write pointer, so the first write allocates it and repoints
+// the table. An I/O page holds a slot per byte naming the
+// device and register behind it; devices claim address ranges with
+// map_device(). I/O bytes no device claims read as 0 and ignore writes.
+//
+// Devices can only be mapped in the I/O region: the threaded and JIT
+// cores treat everything below IO_BASE as plain RAM.
+//
+// Code tracking: anything that caches decoded guest code (the CPU's
+// decode cache) marks the pages it fetched from with mark_code() and
+// registers a watcher, removing it by its id before it goes away. A
+// write to a marked page calls every watcher
+// with the address (every address, if several windows show the byte),
+// so the cache can drop the stale instructions. Marks are sticky and
+// follow the physical memory. Remapping a window calls the remap
+// watchers with the window's address range, since everything cached
+// there may now be different code.
+//
+// Dirty tracking: the bus records which frames have been written since
+// the last clear_dirty(), for incremental snapshots. It costs nothing
+// on the write path: a frame that isn't dirty has no write pointers,
+// so its first write takes the same slow path as a first write to an
+// unallocated page, which marks it.
+//
+// Watchpoints: add_watchpoint() flags CPU addresses to watch for data
+// reads and/or writes. A page holding a watched byte loses the host
+// pointer for that kind of access, so only accesses to that page take
+// the slow path, which looks the byte up in a table; every other page
+// is untouched. The first watched access is kept until
+// clear_watch_hit(). Instruction fetches go through fetch(), which
+// watchpoints don't see.
+//
+// Write log: while set_write_log() has a log in place, every page drops
+// its write pointer and each write (RAM or I/O) is appended to the log,
+// for tracing. A device writing on its own account (DMA) pauses the log
+// around its writes, so the log holds only the CPU's.
+//
+// Threads: a bus belongs to one host thread at a time, except that
+// cores on several host threads may share it between share_ram() and
+// unshare_ram(), if their devices guard themselves. Every RAM byte is
+// read and written with one atomic host access: a load acquires, a
+// store releases. So a core's stores reach the others in the order it
+// made them, and what a core did before a store is seen by any core
+// that loads the stored byte. A burst is that many byte accesses, not
+// one access.
 
 class Bus {
 public:
@@ -18,55 +78,537 @@ public:
     static constexpr uint32_t IO_SIZE = 0x1000;   // 4 KB
     static constexpr uint32_t RAM_SIZE = IO_BASE;  // 60 KB
 
-    using IoReadFn  = std::function<uint8_t(uint32_t addr)>;
-    using IoWriteFn = std::function<void(uint32_t addr, uint8_t value)>;
+    using CodeWriteFn = std::function<void(uint32_t addr)>;
+    using RemapFn = std::function<void(uint32_t addr, uint32_t length)>;
+    using WatcherId = uint32_t;
+
+    static constexpr uint8_t WATCH_READ = 1;
+    static constexpr uint8_t WATCH_WRITE = 2;
 
-    Bus() = default;
+    // A watched access: the address, WATCH_READ or WATCH_WRITE, and the
+    // byte read or written
+    struct WatchHit {
+        uint16_t addr = 0;
+        uint8_t kind = 0;
+        uint8_t value = 0;
+    };
 
-    void attach_io(IoReadFn read_fn, IoWriteFn write_fn) {
-        io_read  = read_fn;
-        io_write = write_fn;
+    static constexpr int PAGE_BITS = 8;
+    static constexpr uint32_t PAGE_SIZE = 1u << PAGE_BITS;
+    static constexpr int NUM_PAGES = 0x10000 >> PAGE_BITS;
+
+    static constexpr int FRAME_BITS = Memory::PAGE_BITS;
+    static constexpr uint32_t FRAME_SIZE = 1u << FRAME_BITS;          // 4 KB
+    static constexpr uint32_t NUM_WINDOWS = RAM_SIZE >> FRAME_BITS;   // 15
+    static constexpr uint32_t NUM_FRAMES = Memory::SIZE >> FRAME_BITS; // 256
+
+    Bus() : ram(Memory::SIZE), code_phys(Memory::SIZE >> PAGE_BITS, false), dirty(NUM_FRAMES, false) {
+        for (uint32_t w = 0; w < NUM_WINDOWS; w++) {
+            windows[w] = w;
+            point_window(w);
+        }
     }
 
-    uint8_t read_byte(uint32_t addr) const {
-        addr &= 0xFFFF;  // wrap to 16-bit
-        if (addr >= IO_BASE) {
-            if (io_read) return io_read(addr - IO_BASE);
-            return 0;
+    // Pages point into this bus's own RAM and I/O slots
+    Bus(const Bus&) = delete;
+    Bus& operator=(const Bus&) = delete;
+
+    // Map `dev` at [base, base+length); the device sees offsets 0..length-1.
+    // Fails (returns false) outside the I/O region, for more than 256
+    // registers, or if any byte of the range is already taken.
+    bool map_device(uint32_t base, uint32_t length, Device& dev) {
+        if (base < IO_BASE || length == 0 || length > 256 || base + length > 0x10000) return false;
+        for (uint32_t a = base; a < base + length; a++) {
+            const IoPage* io = pages[a >> PAGE_BITS].io;
+            if (io && io->slots[a & (PAGE_SIZE - 1)].dev) return false;
+        }
+        for (uint32_t a = base; a < base + length; a++)
+            io_page(a >> PAGE_BITS).slots[a & (PAGE_SIZE - 1)] = {&dev, uint8_t(a - base)};
+        return true;
+    }
+
+    // --- Banking ---
+
+    // Show physical frame `frame` in window `window` (CPU addresses
+    // window*FRAME_SIZE up). Out-of-range windows are ignored; frames
+    // wrap at NUM_FRAMES.
+    void map_window(uint32_t window, uint32_t frame) {
+        if (window >= NUM_WINDOWS) return;
+        frame &= NUM_FRAMES - 1;
+        if (windows[window] == frame) return;
+        windows[window] = frame;
+        point_window(window);
+
+        aliased = false;
+        for (uint32_t a = 0; a < NUM_WINDOWS; a++)
+            for (uint32_t b = a + 1; b < NUM_WINDOWS; b++) aliased = aliased || windows[a] == windows[b];
+
+        for (auto& w : remap_watchers) w.fn(window << FRAME_BITS, FRAME_SIZE);
+    }
+
+    uint32_t window_frame(uint32_t window) const { return window < NUM_WINDOWS ? windows[window] : 0; }
+
+    // --- Forking ---
+
+    // Show the same memory and windows as `parent`, sharing every page
+    // copy-on-write with it. Both buses drop their write pointers, so
+    // the first write on either side to a shared page copies it.
+    // Devices, watchers and code marks stay this bus's own.
+    void share_memory(Bus& parent) {
+        ram = parent.ram;
+        windows = parent.windows;
+        aliased = parent.aliased;
+        for (uint32_t w = 0; w < NUM_WINDOWS; w++) {
+            point_window(w);
+            parent.point_window(w);
+        }
+        for (auto& w : remap_watchers) w.fn(0, RAM_SIZE);
+    }
+
+    // --- Dirty tracking ---
+
+    // Written since the last clear_dirty() (or since construction)
+    bool is_dirty(uint32_t frame) const { return dirty[frame & (NUM_FRAMES - 1)]; }
+
+    // Start a new interval: drop every write pointer so the next write
+    // to each frame marks it again
+    void clear_dirty() {
+        dirty.assign(NUM_FRAMES, false);
+        for (uint32_t w = 0; w < NUM_WINDOWS; w++) point_window(w);
+    }
+
+    // Replace a frame's contents with `bytes` (see Memory::set_page; null
+    // for zeros), as restoring a snapshot does. Windows showing the
+    // frame are repointed and reported to the remap watchers.
+    void replace_frame(uint32_t frame, std::shared_ptr<uint8_t> bytes) {
+        frame &= NUM_FRAMES - 1;
+        ram.set_page(frame, std::move(bytes));
+        for (uint32_t w = 0; w < NUM_WINDOWS; w++) {
+            if (windows[w] != frame) continue;
+            point_window(w);
+            for (auto& watcher : remap_watchers) watcher.fn(w << FRAME_BITS, FRAME_SIZE);
         }
-        return ram.read_byte(addr);
+    }
+
+    // --- Watchpoints ---
+
+    // Watch [addr, addr+length) (CPU addresses, wrapping at 64 KB) for
+    // `kinds` of access, a mask of WATCH_READ and WATCH_WRITE
+    void add_watchpoint(uint32_t addr, uint32_t length, uint8_t kinds) {
+        set_watch(addr, length, kinds, true);
+    }
+
+    void remove_watchpoint(uint32_t addr, uint32_t length, uint8_t kinds = WATCH_READ | WATCH_WRITE) {
+        set_watch(addr, length, kinds, false);
+    }
+
+    void clear_watchpoints() { remove_watchpoint(0, 0x10000); }
+
+    bool has_watchpoints() const { return watched_pages > 0; }
+
+    // A write, as the write log records it
+    struct LoggedWrite {
+        uint16_t addr;
+        uint8_t value;
+    };
+
+    // Append every write to `log` from now on (null: stop)
+    void set_write_log(std::vector<LoggedWrite>* log) {
+        write_log = log;
+        for (uint32_t w = 0; w < NUM_WINDOWS; w++) point_window(w);
+    }
+
+    // Leave writes out of the log until resumed; pauses nest
+    void pause_write_log() { log_paused++; }
+    void resume_write_log() { log_paused--; }
+
+    // The first watched access since the last clear_watch_hit()
+    bool has_watch_hit() const { return watch_hit_pending; }
+    const WatchHit& get_watch_hit() const { return watch_hit; }
+    void clear_watch_hit() { watch_hit_pending = false; }
+
+    uint8_t read_byte(uint32_t addr) const {
+        const Page& p = pages[(addr & 0xFFFF) >> PAGE_BITS];
+        if (p.rd) return load(p.rd + (addr & (PAGE_SIZE - 1)));
+        return read_slow(p, addr & 0xFFFF);
     }
 
     void write_byte(uint32_t addr, uint8_t value) {
-        addr &= 0xFFFF;
-        if (addr >= IO_BASE) {
-            if (io_write) io_write(addr - IO_BASE, value);
+        Page& p = pages[(addr & 0xFFFF) >> PAGE_BITS];
+        if (p.wr) {
+            store(p.wr + (addr & (PAGE_SIZE - 1)), value);
+            if (p.code) notify_code_write(addr & 0xFFFF);
             return;
         }
-        ram.write_byte(addr, value);
+        write_slow(p, addr & 0xFFFF, value);
+    }
+
+    // Instruction fetch: a read that watchpoints don't see
+    void fetch(uint32_t addr, uint8_t* out, uint32_t length) const {
+        for (; length > 0; addr++, out++, length--) {
+            addr &= 0xFFFF;
+            const Page& p = pages[addr >> PAGE_BITS];
+            if (p.rd && (addr & (PAGE_SIZE - 1)) + length <= PAGE_SIZE) {
+                copy_out(out, p.rd + (addr & (PAGE_SIZE - 1)), length);
+                return;
+            }
+            *out = addr < RAM_SIZE ? ram.read_byte(p.phys | (addr & (PAGE_SIZE - 1))) : read_io(p, addr);
+        }
     }
 
     uint16_t read_word(uint32_t addr) const {
-        uint8_t lo = read_byte(addr);
-        uint8_t hi = read_byte(addr + 1);
-        return (hi << 8) | lo;
+        uint8_t b[2];
+        read(addr, b, 2);
+        return (b[1] << 8) | b[0];
     }
 
     void write_word(uint32_t addr, uint16_t value) {
-        write_byte(addr, value & 0xFF);
-        write_byte(addr + 1, (value >> 8) & 0xFF);
+        const uint8_t b[2] = {uint8_t(value & 0xFF), uint8_t(value >> 8)};
+        write(addr, b, 2);
     }
 
+    // --- Burst access ---
+    //
+    // Copy [addr, addr+length) out of or into the address space. A run
+    // of RAM pages is one memcpy; I/O bytes go to their device one at a
+    // time, in address order. Addresses wrap at 64 KB as they do for
+    // single bytes.
+
+    void read(uint32_t addr, uint8_t* out, uint32_t length) const {
+        const Page& p = pages[(addr & 0xFFFF) >> PAGE_BITS];
+        uint32_t offset = addr & (PAGE_SIZE - 1);
+        if (p.rd && offset + length <= PAGE_SIZE) {   // the common case: inside one RAM page
+            copy_out(out, p.rd + offset, length);
+            return;
+        }
+        while (length > 0) {
+            addr &= 0xFFFF;
+            uint32_t n = ram_run(addr, length, &Page::rd);
+            if (n) copy_out(out, pages[addr >> PAGE_BITS].rd + (addr & (PAGE_SIZE - 1)), n);
+            else { *out = read_slow(pages[addr >> PAGE_BITS], addr); n = 1; }
+            addr += n; out += n; length -= n;
+        }
+    }
+
+    void write(uint32_t addr, const uint8_t* data, uint32_t length) {
+        Page& p = pages[(addr & 0xFFFF) >> PAGE_BITS];
+        uint32_t offset = addr & (PAGE_SIZE - 1);
+        if (p.wr && offset + length <= PAGE_SIZE) {
+            copy_in(p.wr + offset, data, length);
+            if (p.code) for (uint32_t i = 0; i < length; i++) notify_code_write((addr + i) & 0xFFFF);
+            return;
+        }
+        while (length > 0) {
+            addr &= 0xFFFF;
+            Page& first = pages[addr >> PAGE_BITS];
+            uint32_t n = ram_run(addr, length, &Page::wr);
+            if (n) {
+                copy_in(first.wr + (addr & (PAGE_SIZE - 1)), data, n);
+                notify_code_range(addr, n);
+            } else {
+                write_slow(first, addr, *data);   // allocates a RAM page, so the rest can run
+                n = 1;
+            }
+            addr += n; data += n; length -= n;
+        }
+    }
+
+    // Programs and images go in as one burst
     void load(uint32_t start_addr, const uint8_t* data, uint32_t length) {
-        for (uint32_t i = 0; i < length; i++) {
-            write_byte(start_addr + i, data[i]);
+        write(start_addr, data, length);
+    }
+
+    // --- Atomics ---
+
+    // Compare-and-swap one byte: if it holds `expected`, write `desired`.
+    // Returns the byte it held either way. A RAM byte with a write
+    // pointer is swapped with one atomic host instruction, so another
+    // host thread writing the same byte sees it happen whole; anything
+    // else (I/O, watched, not yet owned) is a read and then a write.
+    uint8_t compare_exchange(uint32_t addr, uint8_t expected, uint8_t desired) {
+        Page& p = pages[(addr & 0xFFFF) >> PAGE_BITS];
+        if (!p.wr) {
+            uint8_t old = read_byte(addr);
+            if (old == expected) write_byte(addr, desired);
+            return old;
         }
+        uint8_t* at = p.wr + (addr & (PAGE_SIZE - 1));
+        bool swapped = __atomic_compare_exchange_n(at, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+        if (swapped && p.code) notify_code_write(addr & 0xFFFF);
+        return expected;   // on failure, what it held
     }
 
-    Memory& get_ram() { return ram; }
+    // Swap one byte: write `value`, return what it held. Atomic the same
+    // way as compare_exchange.
+    uint8_t exchange(uint32_t addr, uint8_t value) {
+        Page& p = pages[(addr & 0xFFFF) >> PAGE_BITS];
+        if (!p.wr) {
+            uint8_t old = read_byte(addr);
+            write_byte(addr, value);
+            return old;
+        }
+        uint8_t old = __atomic_exchange_n(p.wr + (addr & (PAGE_SIZE - 1)), value, __ATOMIC_SEQ_CST);
+        if (p.code) notify_code_write(addr & 0xFFFF);
+        return old;
+    }
+
+    // Get ready for cores on several host threads: give every frame the
+    // windows show its own write pointers now, so no RAM write takes the
+    // slow path (which repoints pages), and make bursts copy byte by
+    // byte with the atomic accesses single bytes use. False, changing
+    // nothing, if a watchpoint or the write log would send accesses down
+    // the slow path anyway. Until unshare_ram(), the host must leave
+    // the windows, dirty marks, watchpoints and write log alone.
+    bool share_ram() {
+        if (watched_pages > 0 || write_log) return false;
+        for (uint32_t w = 0; w < NUM_WINDOWS; w++) {
+            Page& p = pages[w << (FRAME_BITS - PAGE_BITS)];
+            if (!dirty[p.phys >> FRAME_BITS] || !ram.is_writable(p.phys >> FRAME_BITS)) allocate(p);
+        }
+        shared = true;
+        return true;
+    }
+
+    void unshare_ram() { shared = false; }
+
+    // --- Code tracking ---
+
+    WatcherId add_code_watcher(CodeWriteFn fn) {
+        code_watchers.push_back({next_watcher, std::move(fn)});
+        return next_watcher++;
+    }
+
+    WatcherId add_remap_watcher(RemapFn fn) {
+        remap_watchers.push_back({next_watcher, std::move(fn)});
+        return next_watcher++;
+    }
+
+    // Either kind of watcher, by the id adding it returned
+    void remove_watcher(WatcherId id) {
+        auto gone = [id](const auto& w) { return w.id == id; };
+        code_watchers.erase(std::remove_if(code_watchers.begin(), code_watchers.end(), gone), code_watchers.end());
+        remap_watchers.erase(std::remove_if(remap_watchers.begin(), remap_watchers.end(), gone), remap_watchers.end());
+    }
+
+    // Mark [addr, addr+length) as holding cached code
+    void mark_code(uint32_t addr, uint32_t length) {
+        for (uint32_t a = addr; a < addr + length; a++) {
+            Page& p = pages[(a & 0xFFFF) >> PAGE_BITS];
+            if (p.code) continue;
+            p.code = true;
+            if ((a & 0xFFFF) >= RAM_SIZE) continue;
+            code_phys[p.phys >> PAGE_BITS] = true;
+            for (uint32_t w = 0; aliased && w < NUM_WINDOWS; w++)
+                if (windows[w] == p.phys >> FRAME_BITS) page_in_window(w, p.phys).code = true;
+        }
+    }
+
+    // Read-only: the page table caches pointers into it
+    const Memory& get_ram() const { return ram; }
 
 private:
+    // The device register behind one I/O byte (dev null: unmapped)
+    struct IoSlot {
+        Device* dev = nullptr;
+        uint8_t reg = 0;
+    };
+    struct IoPage {
+        std::array<IoSlot, PAGE_SIZE> slots;
+    };
+
+    // A RAM page has rd (and wr once its Memory page is allocated and
+    // dirty) unless that kind of access is watched; an I/O page has io,
+    // or nothing if no device is mapped there yet
+    struct Page {
+        const uint8_t* rd = nullptr;
+        uint8_t* wr = nullptr;
+        IoPage* io = nullptr;
+        uint32_t phys = 0;     // RAM pages: address in Memory
+        bool code = false;
+        uint8_t watch = 0;     // kinds watched on some byte of the page
+    };
+
     Memory ram;
-    IoReadFn  io_read;
-    IoWriteFn io_write;
+    std::array<Page, NUM_PAGES> pages = {};
+    std::array<uint32_t, NUM_WINDOWS> windows = {};   // frame shown in each window
+    bool aliased = false;                             // some frame is in two windows
+    std::vector<bool> code_phys;                      // mark_code() per physical 256 bytes
+    std::vector<bool> dirty;                          // per frame, since clear_dirty()
+    std::vector<std::unique_ptr<IoPage>> io_pages;
+    template <typename Fn>
+    struct Watcher {
+        WatcherId id;
+        Fn fn;
+    };
+    std::vector<Watcher<CodeWriteFn>> code_watchers;
+    std::vector<Watcher<RemapFn>> remap_watchers;
+    WatcherId next_watcher = 0;
+    std::vector<uint8_t> watch_kinds;                 // per CPU address, empty until first used
+    uint32_t watched_pages = 0;
+    mutable WatchHit watch_hit;
+    mutable bool watch_hit_pending = false;
+    std::vector<LoggedWrite>* write_log = nullptr;
+    int log_paused = 0;
+    bool shared = false;   // between share_ram() and unshare_ram()
+
+    // RAM through host pointers (see Threads above). An acquire load or
+    // release store of a byte is a plain one on x86 and most others.
+    static uint8_t load(const uint8_t* at) { return __atomic_load_n(at, __ATOMIC_ACQUIRE); }
+    static void store(uint8_t* at, uint8_t value) { __atomic_store_n(at, value, __ATOMIC_RELEASE); }
+
+    void copy_out(uint8_t* out, const uint8_t* from, uint32_t n) const {
+        if (!shared) { std::memcpy(out, from, n); return; }
+        for (uint32_t i = 0; i < n; i++) out[i] = load(from + i);
+    }
+
+    void copy_in(uint8_t* to, const uint8_t* data, uint32_t n) {
+        if (!shared) { std::memcpy(to, data, n); return; }
+        for (uint32_t i = 0; i < n; i++) store(to + i, data[i]);
+    }
+
+    // The bus page of window w that shows physical address phys
+    Page& page_in_window(uint32_t w, uint32_t phys) {
+        return pages[(w << (FRAME_BITS - PAGE_BITS)) | ((phys & (FRAME_SIZE - 1)) >> PAGE_BITS)];
+    }
+
+    // Repoint a window's pages at the frame it now shows
+    void point_window(uint32_t w) {
+        for (uint32_t i = 0; i < FRAME_SIZE >> PAGE_BITS; i++) {
+            Page& p = pages[(w << (FRAME_BITS - PAGE_BITS)) + i];
+            p.phys = (windows[w] << FRAME_BITS) + (i << PAGE_BITS);
+            p.code = code_phys[p.phys >> PAGE_BITS];
+            refresh(p);
+        }
+    }
+
+    IoPage& io_page(uint32_t page) {
+        if (!pages[page].io) {
+            io_pages.push_back(std::make_unique<IoPage>());
+            pages[page].io = io_pages.back().get();
+        }
+        return *pages[page].io;
+    }
+
+    uint8_t read_io(const Page& p, uint32_t addr) const {
+        if (!p.io) return 0;
+        const IoSlot& s = p.io->slots[addr & (PAGE_SIZE - 1)];
+        return s.dev ? s.dev->read_reg(s.reg) : 0;
+    }
+
+    void write_io(const Page& p, uint32_t addr, uint8_t value) {
+        if (!p.io) return;
+        const IoSlot& s = p.io->slots[addr & (PAGE_SIZE - 1)];
+        if (s.dev) s.dev->write_reg(s.reg, value);
+    }
+
+    // Point a RAM page at its Memory bytes as they are now
+    void refresh(Page& p) {
+        uint32_t frame = p.phys >> Memory::PAGE_BITS;
+        uint32_t offset = p.phys & (Memory::PAGE_SIZE - 1);
+        p.rd = ram.page_for_read(frame) + offset;
+        p.wr = dirty[frame] && ram.is_writable(frame) ? ram.page_for_write(frame) + offset : nullptr;
+        if (p.watch & WATCH_READ) p.rd = nullptr;
+        if ((p.watch & WATCH_WRITE) || write_log) p.wr = nullptr;
+    }
+
+    // Everything without a host pointer: I/O, watched or logged pages,
+    // and RAM pages not yet allocated (or clean, or shared) for writes
+    uint8_t read_slow(const Page& p, uint32_t addr) const {
+        uint8_t value = addr < RAM_SIZE ? ram.read_byte(p.phys | (addr & (PAGE_SIZE - 1))) : read_io(p, addr);
+        if (p.watch & WATCH_READ) check_watch(addr, WATCH_READ, value);
+        return value;
+    }
+
+    void write_slow(Page& p, uint32_t addr, uint8_t value) {
+        if (p.watch & WATCH_WRITE) check_watch(addr, WATCH_WRITE, value);
+        if (write_log && !log_paused) write_log->push_back({uint16_t(addr), value});
+        if (addr >= RAM_SIZE) {
+            write_io(p, addr, value);
+            return;
+        }
+        uint32_t frame = p.phys >> FRAME_BITS;
+        if (!dirty[frame] || !ram.is_writable(frame)) allocate(p);
+        if (p.wr) store(p.wr + (addr & (PAGE_SIZE - 1)), value);
+        else ram.write_byte(p.phys | (addr & (PAGE_SIZE - 1)), value);
+        if (p.code) notify_code_write(addr);
+    }
+
+    void check_watch(uint32_t addr, uint8_t kind, uint8_t value) const {
+        if (watch_hit_pending || !(watch_kinds[addr] & kind)) return;
+        watch_hit = {uint16_t(addr), kind, value};
+        watch_hit_pending = true;
+    }
+
+    void set_watch(uint32_t addr, uint32_t length, uint8_t kinds, bool on) {
+        if (watch_kinds.empty()) {
+            if (!on) return;
+            watch_kinds.assign(0x10000, 0);
+        }
+        if (length > 0x10000) length = 0x10000;
+        for (uint32_t i = 0; i < length; i++) {
+            uint8_t& k = watch_kinds[(addr + i) & 0xFFFF];
+            k = on ? k | kinds : k & ~kinds;
+        }
+        // Re-derive the flags of the pages the range touched
+        uint32_t first = (addr & 0xFFFF) >> PAGE_BITS;
+        uint32_t count = ((addr & (PAGE_SIZE - 1)) + length + PAGE_SIZE - 1) >> PAGE_BITS;
+        for (uint32_t n = 0; n < count && n < NUM_PAGES; n++) {
+            uint32_t page = (first + n) % NUM_PAGES;
+            uint8_t any = 0;
+            for (uint32_t i = 0; i < PAGE_SIZE; i++) any |= watch_kinds[(page << PAGE_BITS) | i];
+            if (any == pages[page].watch) continue;
+            watched_pages += (any != 0) - (pages[page].watch != 0);
+            pages[page].watch = any;
+            if (page < (RAM_SIZE >> PAGE_BITS)) refresh(pages[page]);
+        }
+    }
+
+    // First write to a RAM page since it was allocated, shared or last
+    // counted clean: give it its own frame, mark it dirty and repoint
+    // every window that shows it
+    void allocate(Page& p) {
+        uint32_t frame = p.phys >> FRAME_BITS;
+        ram.page_for_write(frame);
+        dirty[frame] = true;
+        for (uint32_t w = 0; w < NUM_WINDOWS; w++)
+            if (windows[w] == frame) point_window(w);
+    }
+
+    // Bytes from addr (up to length) behind pointers `ptr` that are
+    // contiguous in host memory, without wrapping past 0xFFFF; 0 if
+    // addr's page has no such pointer
+    template <typename P>
+    uint32_t ram_run(uint32_t addr, uint32_t length, P* Page::*ptr) const {
+        uint32_t page = addr >> PAGE_BITS;
+        const uint8_t* base = pages[page].*ptr;
+        if (!base) return 0;
+        uint32_t n = PAGE_SIZE - (addr & (PAGE_SIZE - 1));
+        while (n < length && ++page < NUM_PAGES
+               && pages[page].*ptr == base + (page - (addr >> PAGE_BITS)) * PAGE_SIZE)
+            n += PAGE_SIZE;
+        return n < length ? n : length;
+    }
+
+    // Tell the watchers about every byte of [addr, addr+n) on a code page
+    void notify_code_range(uint32_t addr, uint32_t n) {
+        for (uint32_t a = addr; a < addr + n; ) {
+            uint32_t page_end = (a | (PAGE_SIZE - 1)) + 1;
+            uint32_t end = page_end < addr + n ? page_end : addr + n;
+            if (pages[a >> PAGE_BITS].code)
+                for (; a < end; a++) notify_code_write(a);
+            a = end;
+        }
+    }
+
+    void notify_code_write(uint32_t addr) {
+        if (!aliased) {
+            for (auto& w : code_watchers) w.fn(addr);
+            return;
+        }
+        uint32_t phys = pages[addr >> PAGE_BITS].phys | (addr & (PAGE_SIZE - 1));
+        for (uint32_t w = 0; w < NUM_WINDOWS; w++) {
+            if (windows[w] != phys >> FRAME_BITS) continue;
+            for (auto& watcher : code_watchers) watcher.fn((w << FRAME_BITS) | (phys & (FRAME_SIZE - 1)));
+        }
+    }
 };
@@ -1,49 +1,66 @@
 #pragma once
 #include "../gates/gates.h"
 #include <array>
+#include <memory>
 #include <vector>
 #include <cstdint>
+#include <cstring>
 
-// Memory — 1 MB (1,048,576 bytes), 20-bit address bus, 8-bit data bus.
+// Memory — up to 1 MB (1,048,576 bytes), 20-bit address bus, 8-bit data bus.
 //
 // In real hardware this would be a grid of flip-flops with a decoder selecting
 // which row to read/write. Simulating 8 million flip-flops would eat ~4 GB of
-// host RAM, so the storage is a plain byte array — but the interface matches
+// host RAM, so the storage is plain bytes — but the interface matches
 // what the gate-level version would look like.
 //
+// Storage is sparse: 4 KB pages, each allocated on its first write.
+// A page that was never written reads as zeros (every read of it sees
+// one shared zero page), so a fresh Memory costs a small pointer table
+// whatever its size. The size is chosen at construction, in whole
+// pages; addresses wrap at it.
+//
+// Copies share pages copy-on-write: copying a Memory copies the page
+// table, and whichever copy next writes a shared page gets its own
+// copy of it first. A copy costs a pointer per page, and afterwards
+// each side only pays for the pages it changes.
+//
 // Two interfaces:
-//   1. clock()      — gate-level: bool arrays for address/data, rising-edge writes
+//   1. clock()      — gate-level: Bits buses for address/data, rising-edge writes
 //   2. read/write   — direct byte/word access for the CPU to use at speed
 
 class Memory {
 public:
     static constexpr int ADDR_BITS = 20;
     static constexpr int DATA_BITS = 8;
-    static constexpr int SIZE = 1 << ADDR_BITS;  // 1,048,576 bytes
+    static constexpr int SIZE = 1 << ADDR_BITS;  // 1,048,576 bytes, the most it can hold
+
+    static constexpr int PAGE_BITS = 12;
+    static constexpr uint32_t PAGE_SIZE = 1u << PAGE_BITS;   // 4 KB
+
+    Bits<DATA_BITS> data_out = {};
 
-    std::array<bool, DATA_BITS> data_out = {};
+    // `size` is rounded up to whole pages and capped at SIZE
+    explicit Memory(uint32_t size = SIZE)
+        : pages(page_count(size)), bytes(uint32_t(pages.size()) << PAGE_BITS) {}
 
-    Memory() : storage(SIZE, 0) {}
+    uint32_t size() const { return bytes; }
 
     // --- Gate-level interface ---
 
     void clock(bool clk,
                bool write_en,
-               const std::array<bool, ADDR_BITS>& address,
-               const std::array<bool, DATA_BITS>& data_in)
+               const Bits<ADDR_BITS>& address,
+               const Bits<DATA_BITS>& data_in)
     {
-        int addr = addr_to_int(address);
+        uint32_t addr = address.to_int();
 
         // Read: always output the value at the address
-        uint8_t byte = storage[addr];
-        for (int i = 0; i < DATA_BITS; i++) {
-            data_out[i] = (byte >> i) & 1;
-        }
+        data_out = Bits<DATA_BITS>(read_byte(addr));
 
         // Write: on rising edge when write_enable is high
         bool rising_edge = gate::AND(clk, gate::NOT(prev_clk));
         if (gate::AND(rising_edge, write_en)) {
-            storage[addr] = data_to_byte(data_in);
+            write_byte(addr, data_in.to_int());
         }
 
         prev_clk = clk;
@@ -52,11 +69,13 @@ public:
     // --- Direct interface (used by CPU) ---
 
     uint8_t read_byte(uint32_t addr) const {
-        return storage[addr & (SIZE - 1)];
+        addr = wrap(addr);
+        return page_for_read(addr >> PAGE_BITS)[addr & (PAGE_SIZE - 1)];
     }
 
     void write_byte(uint32_t addr, uint8_t value) {
-        storage[addr & (SIZE - 1)] = value;
+        addr = wrap(addr);
+        page_for_write(addr >> PAGE_BITS)[addr & (PAGE_SIZE - 1)] = value;
     }
 
     // 16-bit word access, little-endian (low byte at lower address)
@@ -71,30 +90,89 @@ public:
         write_byte(addr + 1, (value >> 8) & 0xFF);
     }
 
+    // Burst access: one memcpy per page touched
+    void read(uint32_t addr, uint8_t* out, uint32_t length) const {
+        while (length > 0) {
+            addr = wrap(addr);
+            uint32_t offset = addr & (PAGE_SIZE - 1);
+            uint32_t n = length < PAGE_SIZE - offset ? length : PAGE_SIZE - offset;
+            std::memcpy(out, page_for_read(addr >> PAGE_BITS) + offset, n);
+            addr += n; out += n; length -= n;
+        }
+    }
+
+    void write(uint32_t addr, const uint8_t* data, uint32_t length) {
+        while (length > 0) {
+            addr = wrap(addr);
+            uint32_t offset = addr & (PAGE_SIZE - 1);
+            uint32_t n = length < PAGE_SIZE - offset ? length : PAGE_SIZE - offset;
+            std::memcpy(page_for_write(addr >> PAGE_BITS) + offset, data, n);
+            addr += n; data += n; length -= n;
+        }
+    }
+
     // Bulk load — for loading programs into memory
     void load(uint32_t start_addr, const uint8_t* data, uint32_t length) {
-        for (uint32_t i = 0; i < length; i++) {
-            write_byte(start_addr + i, data[i]);
+        write(start_addr, data, length);
+    }
+
+    // --- Pages (for buses that map memory page by page) ---
+
+    uint32_t num_pages() const { return uint32_t(pages.size()); }
+    bool is_allocated(uint32_t page) const { return pages[page] != nullptr; }
+
+    // Allocated and not shared with a copy: page_for_write() won't move it
+    bool is_writable(uint32_t page) const { return pages[page] && pages[page].use_count() == 1; }
+
+    size_t allocated_pages() const {
+        size_t n = 0;
+        for (const auto& p : pages) n += p != nullptr;
+        return n;
+    }
+
+    // The page's bytes; the shared zero page if it was never written.
+    // Valid until the page is next made writable.
+    const uint8_t* page_for_read(uint32_t page) const {
+        return pages[page] ? pages[page].get() : zero_page();
+    }
+
+    // The page's own bytes: allocated (zeroed) on first use, copied
+    // first if a copy of this Memory still shares it
+    uint8_t* page_for_write(uint32_t page) {
+        if (!pages[page]) {
+            pages[page].reset(new uint8_t[PAGE_SIZE](), std::default_delete<uint8_t[]>());
+        } else if (pages[page].use_count() > 1) {
+            std::shared_ptr<uint8_t> own(new uint8_t[PAGE_SIZE], std::default_delete<uint8_t[]>());
+            std::memcpy(own.get(), pages[page].get(), PAGE_SIZE);
+            pages[page] = std::move(own);
         }
+        return pages[page].get();
+    }
+
+    // Put `bytes` (PAGE_SIZE of them, or null for zeros) behind a page,
+    // e.g. a page of a snapshot file. They are shared like a copy's
+    // pages: a write that finds them shared copies them first.
+    void set_page(uint32_t page, std::shared_ptr<uint8_t> bytes) {
+        pages[page] = std::move(bytes);
     }
 
 private:
-    std::vector<uint8_t> storage;
+    std::vector<std::shared_ptr<uint8_t>> pages;
+    uint32_t bytes;
     bool prev_clk = false;
 
-    static int addr_to_int(const std::array<bool, ADDR_BITS>& address) {
-        int addr = 0;
-        for (int i = 0; i < ADDR_BITS; i++) {
-            if (address[i]) addr |= (1 << i);
-        }
-        return addr;
+    static size_t page_count(uint32_t size) {
+        if (size > uint32_t(SIZE)) size = SIZE;
+        size_t n = (size + PAGE_SIZE - 1) >> PAGE_BITS;
+        return n ? n : 1;
     }
 
-    static uint8_t data_to_byte(const std::array<bool, DATA_BITS>& data) {
-        uint8_t byte = 0;
-        for (int i = 0; i < DATA_BITS; i++) {
-            if (data[i]) byte |= (1 << i);
-        }
-        return byte;
+    uint32_t wrap(uint32_t addr) const {
+        return (bytes & (bytes - 1)) == 0 ? addr & (bytes - 1) : addr % bytes;
+    }
+
+    static const uint8_t* zero_page() {
+        static const uint8_t zeros[PAGE_SIZE] = {};
+        return zeros;
     }
 };
@@ -0,0 +1,22 @@
+#include "cpu/netlists.h"
+#include <iostream>
+
+// Writes cpu/netlists_gen.h: the captured netlists as straight-line C++.
+//
+// Build: g++ -std=c++17 -O2 -o netgen netgen.cpp && ./netgen > cpu/netlists_gen.h
+// Rerun whenever a gate, adder, the ALU or the control unit changes;
+// the tests check the generated code against the templates.
+
+int main() {
+    std::cout << "#pragma once\n"
+              << "#include \"../gates/gates.h\"\n\n"
+              << "// Generated by netgen.cpp from the component templates. Do not edit.\n"
+              << "// Pin order is documented in cpu/netlists.h.\n\n";
+
+    adder_netlist<8>().emit_cpp(std::cout, "adder8_net");
+    std::cout << "\n";
+    alu_netlist<8>().emit_cpp(std::cout, "alu8_net");
+    std::cout << "\n";
+    control_unit_netlist().emit_cpp(std::cout, "control_unit_net");
+    return 0;
+}
@@ -0,0 +1,43 @@
+#define SEEDISA_GATE_PROFILE 1
+#include "cpu/computer.h"
+#include <cstdint>
+#include <vector>
+
+// Where the gate-level CPU spends its gates: runs a small guest loop
+// with profiling compiled in; Computer::run prints the report.
+//
+// Build: g++ -std=c++17 -O2 -o profile profile.cpp && ./profile
+// (add -DICACHE=0 to clock every fetch through the IR and control unit)
+
+#ifndef ICACHE
+#define ICACHE 1
+#endif
+
+void emit(std::vector<uint8_t>& prog, uint8_t opcode, uint8_t rd, uint8_t rs, uint16_t imm) {
+    uint8_t top = (opcode << 4) | ((rd & 3) << 2) | (rs & 3);
+    prog.push_back(imm & 0xFF);
+    prog.push_back((imm >> 8) & 0xFF);
+    prog.push_back(top);
+}
+
+int main() {
+    std::vector<uint8_t> prog;
+    emit(prog, 0x1, 1, 0, 1);          // addr 0:  LDI R1, 1
+    emit(prog, 0x1, 0, 0, 20);         // addr 3:  LDI R0, 20
+    emit(prog, 0x5, 0, 1, 0);          // addr 6:  SUB R0, R1
+    emit(prog, 0xC, 0, 0, 6);          // addr 9:  JNZ 6
+    emit(prog, 0x2, 2, 0, 0x1000);     // addr 12: LD R2, [0x1000]
+    emit(prog, 0xD, 2, 0, 1);          // addr 15: ADDI R2, 1
+    emit(prog, 0x3, 2, 0, 0x1000);     // addr 18: ST R2, [0x1000]
+    emit(prog, 0xE, 0, 0, 27);         // addr 21: CALL 27
+    emit(prog, 0xA, 0, 0, 3);          // addr 24: JMP 3
+    emit(prog, 0x0, 1, 1, 0);          // addr 27: PUSH R1
+    emit(prog, 0x0, 1, 2, 0);          // addr 30: POP R1
+    emit(prog, 0x0, 0, 3, 0);          // addr 33: RET
+
+    Computer c(CoreType::Gate);
+    static_cast<CPU&>(c.get_cpu()).set_decode_cache(ICACHE);
+    c.load_program(prog.data(), prog.size());
+    c.run(100000);
+    return 0;
+}
@@ -21,12 +21,13 @@
 template <int N>
 class Counter {
 public:
-    std::array<bool, N> value = {};
+    Bits<N> value = {};
 
     void clock(bool clk, bool reset, bool enable) {
         // Compute the next value for each bit
         // A bit toggles when enable is high and all lower bits are 1
         bool all_lower_ones = true;
+        Bits<N> next;
 
         for (int i = 0; i < N; i++) {
             // Should this bit toggle?
@@ -34,28 +35,23 @@ public:
 
             // XOR current value with toggle to get next value
             // But if reset, force to 0
-            bool next = gate::AND(
+            next[i] = gate::AND(
                 gate::NOT(reset),
                 gate::XOR(value[i], toggle)
             );
 
-            bits[i].clock(clk, next);
-            value[i] = bits[i].q;
-
             // Update the carry chain: all bits up to here must be 1
             all_lower_ones = gate::AND(all_lower_ones, value[i]);
         }
+
+        // All N flip-flops share the clock, so they clock as one bus
+        bits.clock(fanout<N>(clk), next);
+        value = bits.q;
     }
 
     // Helper: get count as an integer
-    int to_int() const {
-        int result = 0;
-        for (int i = 0; i < N; i++) {
-            if (value[i]) result |= (1 << i);
-        }
-        return result;
-    }
+    int to_int() const { return value.to_int(); }
 
 private:
-    std::array<DFlipFlop, N> bits = {};
+    BasicDFlipFlop<Bits<N>> bits;
 };
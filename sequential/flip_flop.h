@@ -12,12 +12,14 @@
 //   - Slave latch:  enabled when CLK is HIGH (outputs master's value)
 // The result: output only changes on the 0→1 clock transition.
 
-class DFlipFlop {
+template <typename Lane>
+class BasicDFlipFlop {
 public:
-    bool q  = false;
-    bool qn = true;
+    Lane q  = LaneTraits<Lane>::zeros();
+    Lane qn = LaneTraits<Lane>::ones();
 
-    void clock(bool clk, bool d) {
+    void clock(Lane clk, Lane d) {
+        SEEDISA_PROFILE_FLIP_FLOP(Lane);
         // Master is transparent when clock is LOW
         master.update(gate::NOT(clk), d);
 
@@ -30,6 +32,8 @@ public:
     }
 
 private:
-    DLatch master;
-    DLatch slave;
+    BasicDLatch<Lane> master;
+    BasicDLatch<Lane> slave;
 };
+
+using DFlipFlop = BasicDFlipFlop<bool>;
@@ -4,13 +4,18 @@
 // SR Latch — the simplest memory element.
 // Built from two cross-coupled NOR gates (like in the book).
 // Set makes Q=1, Reset makes Q=0. Both high is invalid.
+//
+// Lane is the wire type (see gates/lane.h): bool for one latch,
+// uint64_t for 64 independent latches evaluated together.
 
-class SRLatch {
+template <typename Lane>
+class BasicSRLatch {
 public:
-    bool q  = false;
-    bool qn = true;  // Q-bar (complement of Q)
+    Lane q  = LaneTraits<Lane>::zeros();
+    Lane qn = LaneTraits<Lane>::ones();  // Q-bar (complement of Q)
 
-    void update(bool set, bool reset) {
+    void update(Lane set, Lane reset) {
+        SEEDISA_PROFILE_LATCH(Lane);
         // Two cross-coupled NOR gates:
         //   Q  = NOR(R, Q̄)
         //   Q̄ = NOR(S, Q)
@@ -22,21 +27,24 @@ public:
     }
 };
 
+using SRLatch = BasicSRLatch<bool>;
+
 // D Latch — level-triggered. When enable is HIGH, output follows input.
 // When enable goes LOW, output is latched (held).
 // Built from an SR latch + gates that steer D into set/reset.
 
-class DLatch {
+template <typename Lane>
+class BasicDLatch {
 public:
-    bool q  = false;
-    bool qn = true;
+    Lane q  = LaneTraits<Lane>::zeros();
+    Lane qn = LaneTraits<Lane>::ones();
 
-    void update(bool enable, bool d) {
+    void update(Lane enable, Lane d) {
         // D feeds into an SR latch like this:
         //   Set   = AND(enable, D)
         //   Reset = AND(enable, NOT(D))
-        bool set   = gate::AND(enable, d);
-        bool reset = gate::AND(enable, gate::NOT(d));
+        Lane set   = gate::AND(enable, d);
+        Lane reset = gate::AND(enable, gate::NOT(d));
 
         sr.update(set, reset);
         q  = sr.q;
@@ -44,5 +52,7 @@ public:
     }
 
 private:
-    SRLatch sr;
+    BasicSRLatch<Lane> sr;
 };
+
+using DLatch = BasicDLatch<bool>;
@@ -12,26 +12,32 @@
 //
 // Output:
 //   data_out — the N stored bits
+//
+// Lane picks the wire type (gates/lane.h): Register<8, uint64_t> is 64
+// independent 8-bit registers, each lane with its own load and data.
+//
+// The row of flip-flops is a single flip-flop over the whole bus: every
+// bit sees the same clock and the same gates, so with packed bool wires
+// (Bits<N>) one word-wide gate clocks all N bits at once.
 
-template <int N>
+template <int N, typename Lane = bool>
 class Register {
 public:
-    std::array<bool, N> data_out = {};
+    Wires<N, Lane> data_out = {};
 
-    void clock(bool clk, bool load, const std::array<bool, N>& data_in) {
-        for (int i = 0; i < N; i++) {
-            // Mux: if load is high, feed in new data; otherwise feed back current output
-            // This is just: selected = OR(AND(load, data_in), AND(NOT(load), data_out))
-            bool selected = gate::OR(
-                gate::AND(load, data_in[i]),
-                gate::AND(gate::NOT(load), data_out[i])
-            );
+    void clock(Lane clk, Lane load, const Wires<N, Lane>& data_in) {
+        // Mux: if load is high, feed in new data; otherwise feed back current output
+        // This is just: selected = OR(AND(load, data_in), AND(NOT(load), data_out))
+        Wires<N, Lane> ld = fanout<N>(load);
+        Wires<N, Lane> selected = gate::OR(
+            gate::AND(ld, data_in),
+            gate::AND(gate::NOT(ld), data_out)
+        );
 
-            bits[i].clock(clk, selected);
-            data_out[i] = bits[i].q;
-        }
+        bits.clock(fanout<N>(clk), selected);
+        data_out = bits.q;
     }
 
 private:
-    std::array<DFlipFlop, N> bits = {};
+    BasicDFlipFlop<Wires<N, Lane>> bits;
 };
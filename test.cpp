@@ -1,8 +1,19 @@
 #include "cpu/computer.h"
+#include "cpu/smp_computer.h"
+#include "cpu/snapshot.h"
+#include "cpu/replay.h"
+#include "devices/uart_fd.h"
+#include "cpu/netlists.h"
+#include "cpu/netlists_gen.h"
 #include <iostream>
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <random>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
 
 // Encode a 24-bit instruction into three bytes
 // Layout: byte0=imm_lo, byte1=imm_hi, byte2=[opcode:4][rd:2][rs:2]
@@ -13,14 +24,14 @@ void emit(std::vector<uint8_t>& prog, uint8_t opcode, uint8_t rd, uint8_t rs, ui
     prog.push_back(top);
 }
 
-bool test_add() {
+bool test_add(CoreType core) {
     std::vector<uint8_t> prog;
     emit(prog, 0x1, 0, 0, 3);   // addr 0: LDI R0, 3
     emit(prog, 0x1, 1, 0, 5);   // addr 3: LDI R1, 5
     emit(prog, 0x4, 0, 1, 0);   // addr 6: ADD R0, R1
     emit(prog, 0xF, 0, 0, 0);   // addr 9: HLT
 
-    Computer c;
+    Computer c(core);
     c.load_program(prog.data(), prog.size());
     c.run();
 
@@ -29,14 +40,14 @@ bool test_add() {
     return pass;
 }
 
-bool test_sub() {
+bool test_sub(CoreType core) {
     std::vector<uint8_t> prog;
     emit(prog, 0x1, 0, 0, 20);  // addr 0
     emit(prog, 0x1, 1, 0, 7);   // addr 3
     emit(prog, 0x5, 0, 1, 0);   // addr 6
     emit(prog, 0xF, 0, 0, 0);   // addr 9
 
-    Computer c;
+    Computer c(core);
     c.load_program(prog.data(), prog.size());
     c.run();
 
@@ -45,13 +56,13 @@ bool test_sub() {
     return pass;
 }
 
-bool test_ldi_and_mov() {
+bool test_ldi_and_mov(CoreType core) {
     std::vector<uint8_t> prog;
     emit(prog, 0x1, 2, 0, 42);  // addr 0
     emit(prog, 0x8, 3, 2, 0);   // addr 3
     emit(prog, 0xF, 0, 0, 0);   // addr 6
 
-    Computer c;
+    Computer c(core);
     c.load_program(prog.data(), prog.size());
     c.run();
 
@@ -60,7 +71,7 @@ bool test_ldi_and_mov() {
     return pass;
 }
 
-bool test_jump() {
+bool test_jump(CoreType core) {
     // JMP should skip one instruction
     std::vector<uint8_t> prog;
     emit(prog, 0x1, 0, 0, 1);   // addr 0: LDI R0, 1
@@ -68,7 +79,7 @@ bool test_jump() {
     emit(prog, 0x1, 0, 0, 99);  // addr 6: LDI R0, 99 (skipped)
     emit(prog, 0xF, 0, 0, 0);   // addr 9: HLT
 
-    Computer c;
+    Computer c(core);
     c.load_program(prog.data(), prog.size());
     c.run();
 
@@ -77,7 +88,7 @@ bool test_jump() {
     return pass;
 }
 
-bool test_conditional_jump() {
+bool test_conditional_jump(CoreType core) {
     std::vector<uint8_t> prog;
     emit(prog, 0x1, 0, 0, 5);   // addr 0: LDI R0, 5
     emit(prog, 0x1, 1, 0, 5);   // addr 3: LDI R1, 5
@@ -87,7 +98,7 @@ bool test_conditional_jump() {
     emit(prog, 0x1, 2, 0, 1);   // addr 15: LDI R2, 1
     emit(prog, 0xF, 0, 0, 0);   // addr 18: HLT
 
-    Computer c;
+    Computer c(core);
     c.load_program(prog.data(), prog.size());
     c.run();
 
@@ -96,7 +107,7 @@ bool test_conditional_jump() {
     return pass;
 }
 
-bool test_memory() {
+bool test_memory(CoreType core) {
     // LD/ST now use imm16 as address
     std::vector<uint8_t> prog;
     emit(prog, 0x1, 0, 0, 77);      // addr 0: LDI R0, 77
@@ -105,7 +116,7 @@ bool test_memory() {
     emit(prog, 0x2, 1, 0, 0x1000);  // addr 9: LD R1, [0x1000]
     emit(prog, 0xF, 0, 0, 0);       // addr 12: HLT
 
-    Computer c;
+    Computer c(core);
     c.load_program(prog.data(), prog.size());
     c.run();
 
@@ -114,7 +125,7 @@ bool test_memory() {
     return pass;
 }
 
-bool test_loop() {
+bool test_loop(CoreType core) {
     std::vector<uint8_t> prog;
     emit(prog, 0x1, 0, 0, 0);   // addr 0: LDI R0, 0
     emit(prog, 0x1, 1, 0, 5);   // addr 3: LDI R1, 5
@@ -124,7 +135,7 @@ bool test_loop() {
     emit(prog, 0xC, 0, 0, 9);   // addr 15: JNZ 9
     emit(prog, 0xF, 0, 0, 0);   // addr 18: HLT
 
-    Computer c;
+    Computer c(core);
     c.load_program(prog.data(), prog.size());
     c.run();
 
@@ -133,7 +144,7 @@ bool test_loop() {
     return pass;
 }
 
-bool test_push_pop() {
+bool test_push_pop(CoreType core) {
     std::vector<uint8_t> prog;
     emit(prog, 0x1, 0, 0, 42);  // LDI R0, 42
     emit(prog, 0x0, 0, 1, 0);   // PUSH R0
@@ -141,7 +152,7 @@ bool test_push_pop() {
     emit(prog, 0x0, 1, 2, 0);   // POP R1
     emit(prog, 0xF, 0, 0, 0);   // HLT
 
-    Computer c;
+    Computer c(core);
     c.load_program(prog.data(), prog.size());
     c.run();
 
@@ -150,7 +161,7 @@ bool test_push_pop() {
     return pass;
 }
 
-bool test_call_ret() {
+bool test_call_ret(CoreType core) {
     std::vector<uint8_t> prog;
     emit(prog, 0x1, 0, 0, 10);  // addr 0: LDI R0, 10
     emit(prog, 0xE, 0, 0, 9);   // addr 3: CALL 9
@@ -158,7 +169,7 @@ bool test_call_ret() {
     emit(prog, 0xD, 0, 0, 10);  // addr 9: ADDI R0, 10
     emit(prog, 0x0, 0, 3, 0);   // addr 12: RET
 
-    Computer c;
+    Computer c(core);
     c.load_program(prog.data(), prog.size());
     c.run();
 
@@ -167,14 +178,14 @@ bool test_call_ret() {
     return pass;
 }
 
-bool test_16bit_address() {
+bool test_16bit_address(CoreType core) {
     // Test that we can jump to and execute code beyond 256 bytes
     // Put HLT at address 0x200 (512), jump to it
     std::vector<uint8_t> prog;
     emit(prog, 0x1, 0, 0, 42);     // addr 0: LDI R0, 42
     emit(prog, 0xA, 0, 0, 0x200);  // addr 3: JMP 0x200
 
-    Computer c;
+    Computer c(core);
     c.load_program(prog.data(), prog.size());
     // Place a HLT at 0x200
     uint8_t hlt_instr[3];
@@ -189,13 +200,13 @@ bool test_16bit_address() {
     return pass;
 }
 
-bool test_software_interrupt() {
+bool test_software_interrupt(CoreType core) {
     // Set up IVT entry 2 (software interrupt) pointing to handler at 0x100
     // Handler adds 100 to R0, then RTI
     // Main program: LDI R0, 5 → STI → SWI 2 → HLT
     // After SWI, R0 should be 105
 
-    Computer c;
+    Computer c(core);
 
     // Write IVT entry 2 at 0xEFF4 (IVT_BASE + 2*2)
     // Handler address = 0x0100, little-endian
@@ -223,9 +234,9 @@ bool test_software_interrupt() {
     return pass;
 }
 
-bool test_hardware_interrupt() {
+bool test_hardware_interrupt(CoreType core) {
     // Timer fires after a few cycles, handler sets R1=99
-    Computer c;
+    Computer c(core);
 
     // IVT entry 1 (timer) at 0xEFF2 → handler at 0x0100
     c.get_bus().write_byte(0xEFF2, 0x00);
@@ -257,10 +268,10 @@ bool test_hardware_interrupt() {
     return pass;
 }
 
-bool test_timer_device() {
+bool test_timer_device(CoreType core) {
     // Program enables interrupts, arms timer via I/O, then loops.
     // Timer fires after 5 ticks, handler sets R1=77 and halts.
-    Computer c;
+    Computer c(core);
 
     // IVT entry 1 (timer) → handler at 0x0100
     c.get_bus().write_byte(0xEFF2, 0x00);
@@ -288,10 +299,10 @@ bool test_timer_device() {
     return pass;
 }
 
-bool test_uart() {
+bool test_uart(CoreType core) {
     // CPU writes 'H' and 'i' to UART TX (0xF002), then reads a char
     // from RX that the host pushed. Verifies both directions work.
-    Computer c;
+    Computer c(core);
 
     // IVT entry 2 (UART interrupt) → handler at 0x0100
     c.get_bus().write_byte(0xEFF4, 0x00);
@@ -328,7 +339,309 @@ bool test_uart() {
     return pass;
 }
 
-bool test_jc_jnc() {
+bool test_uart_stream(CoreType core) {
+    // A burst of input is one interrupt, and a handler that reads while
+    // RX has data echoes all of it. Output can be read in place. A full
+    // RX drops (and counts) the rest. Then the same guest behind pipes.
+    Computer c(core);
+    c.get_bus().write_word(0xEFF4, 0x0100);   // IVT 2 (UART)
+    std::vector<uint8_t> prog, isr;
+    emit(prog, 0x0, 2, 0, 0);          // addr 0: STI
+    emit(prog, 0xA, 0, 0, 3);          // addr 3: JMP 3
+    emit(isr, 0x2, 0, 0, 0xF003);      // 0x100: LD R0, [UART status]
+    emit(isr, 0x1, 1, 0, 1);           // 0x103: LDI R1, 1
+    emit(isr, 0x6, 0, 1, 0);           // 0x106: AND R0, R1
+    emit(isr, 0xB, 0, 0, 0x0115);      // 0x109: JZ 0x115
+    emit(isr, 0x2, 0, 0, 0xF002);      // 0x10C: LD R0, [UART data]
+    emit(isr, 0x3, 0, 0, 0xF002);      // 0x10F: ST R0, [UART data]
+    emit(isr, 0xA, 0, 0, 0x0100);      // 0x112: JMP 0x100
+    emit(isr, 0xD, 2, 0, 1);           // 0x115: ADDI R2, 1
+    emit(isr, 0x0, 3, 0, 0);           // 0x118: RTI
+    c.load_program(prog.data(), prog.size());
+    c.load_program(isr.data(), isr.size(), 0x0100);
+    UART& uart = c.get_uart();
+
+    uart.send_string("hello");
+    c.run(200);
+    const uint8_t* out;
+    size_t n = uart.output(out);
+    bool burst = c.get_cpu().get_reg(2) == 1 && n == 5 && std::string(out, out + n) == "hello";
+    uart.consume_output(n);
+
+    std::string big(uart.capacity() + 10, 'x');
+    bool full = uart.send_quiet(reinterpret_cast<const uint8_t*>(big.data()), big.size()) == uart.capacity()
+             && uart.get_rx_dropped() == 10 && c.get_bus().read_byte(0xF003) == 3;
+    uart.set_state({});
+
+    bool piped = true;
+#if SEEDISA_UART_FD
+    int in[2], outp[2];
+    piped = ::pipe(in) == 0 && ::pipe(outp) == 0;
+    if (piped) {
+        UartFd console(uart, in[0], outp[1]);
+        piped = ::write(in[1], "abc", 3) == 3 && console.pump() == 3;
+        c.run(200);
+        char buf[8] = {};
+        piped = piped && console.pump() == 3 && ::read(outp[0], buf, sizeof buf) == 3
+             && std::string(buf) == "abc" && c.get_cpu().get_reg(2) == 2 && !console.closed();
+        ::close(in[1]);
+        console.pump();
+        piped = piped && console.closed();
+        ::close(in[0]); ::close(outp[0]); ::close(outp[1]);
+    }
+#endif
+
+    bool pass = burst && full && piped;
+    std::cout << "test_uart_stream: burst=" << burst << " full=" << full << " piped=" << piped
+              << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_dma(CoreType core) {
+    // An unpaced copy lands before the next instruction. A paced fill
+    // takes a cycle per byte, then interrupts: the handler sees it done.
+    // run() and single steps agree on when.
+    auto build = [core] {
+        auto c = std::make_unique<Computer>(core);
+        c->get_bus().write_word(0xEFF6, 0x0100);   // IVT 3 (DMA)
+        for (uint32_t i = 0; i < 300; i++) c->get_bus().write_byte(0x3000 + i, uint8_t(i * 7 + 1));
+        std::vector<uint8_t> prog, isr;
+        auto store = [&](uint16_t addr, uint8_t v) {
+            emit(prog, 0x1, 0, 0, v);
+            emit(prog, 0x3, 0, 0, addr);
+        };
+        store(0xF008, 0x00); store(0xF009, 0x30);   // source 0x3000
+        store(0xF00A, 0x00); store(0xF00B, 0x50);   // destination 0x5000
+        store(0xF00C, 0x2C); store(0xF00D, 0x01);   // length 300
+        store(0xF00F, DMA::START);
+        emit(prog, 0x2, 1, 0, 0x512B);              // LD R1, [0x512B]
+        store(0xF00A, 0x00); store(0xF00B, 0x60);   // destination 0x6000
+        store(0xF00E, 0xAB);                        // fill value
+        store(0xF00F, DMA::START | DMA::FILL | DMA::IRQ | DMA::PACED);
+        emit(prog, 0x2, 3, 0, 0x612B);              // LD R3, [0x612B] (not there yet)
+        emit(prog, 0x0, 2, 0, 0);                   // STI
+        uint16_t here = uint16_t(prog.size());
+        emit(prog, 0xA, 0, 0, here);                // JMP .
+        emit(isr, 0x2, 2, 0, 0xF00F);               // LD R2, [DMA control]
+        emit(isr, 0x2, 3, 0, 0x612B);               // LD R3, [0x612B]
+        emit(isr, 0xF, 0, 0, 0);                    // HLT
+        c->load_program(prog.data(), prog.size());
+        c->load_program(isr.data(), isr.size(), 0x0100);
+        return c;
+    };
+
+    auto a = build(), b = build();
+    uint64_t started = 0;
+    a->run(100000);
+    while (!b->get_cpu().is_halted() && b->get_step_count() < 100000) {
+        b->step();
+        if (!started && b->get_dma().busy()) started = b->get_cycle_count();
+    }
+    Core& cpu = a->get_cpu();
+    Bus& bus = a->get_bus();
+    bool copied = cpu.get_reg(1) == uint8_t(299 * 7 + 1);
+    for (uint32_t i = 0; i < 300; i++) copied = copied && bus.read_byte(0x5000 + i) == uint8_t(i * 7 + 1);
+    bool filled = bus.read_byte(0x612C) == 0 && cpu.get_reg(3) == 0xAB
+               && cpu.get_reg(2) == (DMA::DONE | DMA::FILL | DMA::IRQ | DMA::PACED);
+    for (uint32_t i = 0; i < 300; i++) filled = filled && bus.read_byte(0x6000 + i) == 0xAB;
+    bool timed = cpu.is_halted() && a->get_step_count() == b->get_step_count()
+              && a->get_cycle_count() == b->get_cycle_count() && a->get_cycle_count() > started + 300;
+
+    bool pass = copied && filled && timed;
+    std::cout << "test_dma: copied=" << copied << " filled=" << filled << " timed=" << timed
+              << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_interrupt_controller(CoreType core) {
+    // Lines 5 and 6 share a priority, 6 masked; the DMA's line 3 is the
+    // most urgent. Line 5's handler runs STI and starts a DMA, whose
+    // interrupt nests inside it; unmasking 6 inside it changes nothing
+    // until its EOI. Each handler logs a letter at 0x0300 + R3.
+    Computer c(core);
+    Bus& bus = c.get_bus();
+    bus.write_word(0xEFF6, 0x0140);   // IVT 3 (DMA)
+    bus.write_word(0xEFFA, 0x0100);   // IVT 5
+    bus.write_word(0xEFFC, 0x0180);   // IVT 6
+    const uint16_t intc = Computer::INTC_BASE;
+    bus.write_byte(intc + 0, InterruptController::ENABLE);
+    bus.write_byte(intc + 1, 1 << 6);   // mask 6
+    bus.write_byte(intc + 4 + 3, 0);
+    bus.write_byte(intc + 4 + 5, 4);
+    bus.write_byte(intc + 4 + 6, 4);
+
+    std::vector<uint8_t> prog, isr5, isr3, isr6;
+    auto log = [](std::vector<uint8_t>& p, char ch) {
+        emit(p, 0x1, 0, 0, uint8_t(ch));   // LDI R0, ch
+        emit(p, 0x3, 0, 1, 0);             // STR R0, [R2:R3]
+        emit(p, 0xD, 3, 0, 1);             // ADDI R3, 1
+    };
+    emit(prog, 0x1, 2, 0, 0x03);           // LDI R2, 0x03
+    emit(prog, 0x1, 3, 0, 0x00);           // LDI R3, 0
+    emit(prog, 0x0, 2, 0, 0);              // STI
+    emit(prog, 0xA, 0, 0, 9);              // JMP .
+    log(isr5, 'A');
+    emit(isr5, 0x0, 2, 0, 0);              // STI
+    emit(isr5, 0x1, 0, 0, DMA::START | DMA::IRQ);
+    emit(isr5, 0x3, 0, 0, 0xF00F);         // start an empty DMA -> line 3
+    log(isr5, 'C');
+    emit(isr5, 0x1, 0, 0, 0);
+    emit(isr5, 0x3, 0, 0, intc + 1);       // unmask 6
+    log(isr5, 'D');
+    emit(isr5, 0x3, 0, 0, intc + 2);       // EOI
+    emit(isr5, 0x0, 3, 0, 0);              // RTI
+    for (auto* isr : {&isr3, &isr6}) {
+        log(*isr, isr == &isr3 ? 'B' : 'E');
+        emit(*isr, 0x3, 0, 0, intc + 2);   // EOI
+        emit(*isr, 0x0, 3, 0, 0);          // RTI
+    }
+    c.load_program(prog.data(), prog.size());
+    c.load_program(isr5.data(), isr5.size(), 0x0100);
+    c.load_program(isr3.data(), isr3.size(), 0x0140);
+    c.load_program(isr6.data(), isr6.size(), 0x0180);
+
+    CoreState s = c.get_cpu().get_state();
+    s.sp = 0xE000;   // nested frames would reach down into the IVT
+    c.get_cpu().set_state(s);
+    c.run(10);
+    c.get_cpu().raise_interrupt(6);
+    c.get_cpu().raise_interrupt(5);
+    c.run(200);
+
+    std::string order;
+    for (uint16_t i = 0; i < 5; i++) order += char(bus.read_byte(0x0300 + i));
+    InterruptController& ic = c.get_intc();
+    bool settled = bus.read_byte(intc + 2) == 0 && bus.read_byte(intc + 3) == 0;
+    // 5 is taken on the next step; 3 one step after the store raising
+    // it; 6 the 22 steps up to 5's EOI (5 runs with interrupts on, so
+    // 6 gets in before its RTI)
+    const LatencyHistogram& l6 = ic.get_latency_steps(6);
+    bool timed = ic.get_latency_steps(5).samples == 1 && ic.get_latency_steps(5).max == 0
+              && ic.get_latency_steps(3).max == 1 && l6.samples == 1 && l6.max == 22
+              && l6.buckets[LatencyHistogram::bucket(22)] == 1 && LatencyHistogram::bucket_floor(5) == 16
+              && ic.get_latency_cycles(6).total == 22;
+
+    bool pass = order == "ABCDE" && settled && timed;
+    std::cout << "test_intc: order=" << order << " (expect ABCDE) settled=" << settled
+              << " timed=" << timed << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+// Every core of an SmpComputer runs this. Each adds 1 to the byte at
+// 0x2001 `rounds` times under a TAS spinlock at 0x2000. Then core 0
+// sends an IPI to each other core and halts; the others wait for
+// theirs, whose handler stores the core's ID at 0x2010 + ID and halts.
+void load_smp_program(SmpComputer& c, uint8_t rounds) {
+    const uint16_t smp = SmpComputer::SMP_BASE;
+    std::vector<uint8_t> prog, isr;
+    emit(prog, 0x2, 3, 0, smp + 0);          // LD R3, [ID]
+    emit(prog, 0x1, 0, 0, 0x00);
+    emit(prog, 0x3, 0, 0, smp + 4);
+    emit(prog, 0x1, 0, 0, 0x20);
+    emit(prog, 0x3, 0, 0, smp + 5);          // atomic address 0x2000
+    emit(prog, 0x1, 2, 0, rounds);           // LDI R2, rounds
+    uint16_t lock = uint16_t(prog.size());
+    emit(prog, 0x2, 0, 0, smp + 9);          // LD R0, [TAS]
+    emit(prog, 0x1, 1, 0, 0);
+    emit(prog, 0x9, 0, 1, 0);                // CMP R0, 0
+    emit(prog, 0xC, 0, 0, lock);             // JNZ lock
+    emit(prog, 0x2, 0, 0, 0x2001);
+    emit(prog, 0xD, 0, 0, 1);
+    emit(prog, 0x3, 0, 0, 0x2001);           // [0x2001]++
+    emit(prog, 0x3, 1, 0, 0x2000);           // release
+    emit(prog, 0xD, 2, 0, 0xFF);             // R2--
+    emit(prog, 0xC, 0, 0, lock);             // JNZ lock
+    emit(prog, 0x9, 3, 1, 0);                // CMP R3, 0
+    size_t to_secondary = prog.size();
+    emit(prog, 0xC, 0, 0, 0);                // JNZ secondary
+    for (int i = 1; i < c.num_cores(); i++) {
+        emit(prog, 0x1, 0, 0, uint8_t(i));
+        emit(prog, 0x3, 0, 0, smp + 2);      // IPI core i
+    }
+    emit(prog, 0xF, 0, 0, 0);                // HLT
+    uint16_t secondary = uint16_t(prog.size());
+    prog[to_secondary] = secondary & 0xFF;
+    prog[to_secondary + 1] = secondary >> 8;
+    emit(prog, 0x0, 2, 0, 0);                // STI
+    emit(prog, 0xA, 0, 0, uint16_t(secondary + 3));   // JMP .
+
+    emit(isr, 0x2, 0, 0, smp + 0);           // LD R0, [ID]
+    emit(isr, 0x1, 2, 0, 0x20);
+    emit(isr, 0x8, 3, 0, 0);                 // MOV R3, R0
+    emit(isr, 0xD, 3, 0, 0x10);
+    emit(isr, 0x3, 0, 1, 0);                 // STR R0, [0x20:ID+0x10]
+    emit(isr, 0xF, 0, 0, 0);                 // HLT
+    c.get_bus().write_word(IVT_BASE + SmpController::IPI_INTERRUPT * 2, 0x0100);
+    c.load_program(prog.data(), prog.size());
+    c.load_program(isr.data(), isr.size(), 0x0100);
+}
+
+// All halted, the count right and every other core interrupted
+bool smp_done(SmpComputer& c, uint8_t rounds) {
+    Bus& bus = c.get_bus();
+    bool ok = c.all_halted() && bus.read_byte(0x2001) == uint8_t(rounds * c.num_cores());
+    for (int i = 1; i < c.num_cores(); i++) ok = ok && bus.read_byte(0x2010 + i) == i;
+    return ok;
+}
+
+bool test_smp(CoreType core) {
+    // Four cores in lockstep quanta, small enough that the lock is often
+    // held across one. The same run twice gives the same counts.
+    auto build = [core] {
+        auto c = std::make_unique<SmpComputer>(4, core);
+        c->set_quantum(37);
+        load_smp_program(*c, 50);
+        return c;
+    };
+    auto a = build(), b = build();
+    StopReason why = a->run(1000000);
+    b->run(1000000);
+    bool same = true;
+    for (int i = 0; i < 4; i++)
+        same = same && a->get_step_count(i) == b->get_step_count(i) && a->get_cycle_count(i) == b->get_cycle_count(i);
+    bool done = why == StopReason::Halted && smp_done(*a, 50);
+
+    bool pass = done && same;
+    std::cout << "test_smp: count=" << (int)a->get_bus().read_byte(0x2001) << " (expect 200) done=" << done
+              << " same=" << same << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_smp_parallel() {
+    // The same program with a core per host thread: the lock keeps the
+    // count right however the cores interleave (and the run is clean
+    // under -fsanitize=thread). Two systems on one thread each keep
+    // their own idea of which core is running, and a controller built
+    // where another was destroyed by a different thread starts fresh.
+    const int n = 4;
+    const uint8_t rounds = 60;   // n * rounds fits a byte
+    SmpComputer c(n, CoreType::Fast);
+    c.set_quantum(500);
+    load_smp_program(c, rounds);
+    StopReason why = c.run_parallel(10000000);
+    bool done = why == StopReason::Halted && smp_done(c, rounds);
+
+    SmpComputer other(2, CoreType::Fast);
+    c.get_smp().set_current(3);
+    other.get_smp().set_current(1);
+    bool own = c.get_bus().read_byte(SmpComputer::SMP_BASE) == 3
+            && other.get_bus().read_byte(SmpComputer::SMP_BASE) == 1;
+
+    Bus bus;
+    std::optional<SmpController> smp;
+    smp.emplace(bus, 4);
+    smp->set_current(3);
+    std::thread([&] { smp.emplace(bus, 1); }).join();
+    bool fresh = smp->current() == 0;
+
+    bool pass = done && own && fresh;
+    std::cout << "test_smp_parallel: count=" << (int)c.get_bus().read_byte(0x2001) << " (expect "
+              << n * rounds << ") own core ids=" << own << " fresh=" << fresh << " "
+              << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_jc_jnc(CoreType core) {
     // Test JC (jump if carry) and JNC (jump if no carry).
     // CMP/SUB sets carry when A >= B (no borrow).
     //
@@ -337,7 +650,7 @@ bool test_jc_jnc() {
     // Then: R0=3, R1=8. CMP R0, R1 → carry clear (3 < 8).
     //   JNC should jump. JC should not.
 
-    Computer c;
+    Computer c(core);
     std::vector<uint8_t> prog;
 
     // Part 1: 10 >= 5 → carry set
@@ -369,12 +682,12 @@ bool test_jc_jnc() {
     return pass;
 }
 
-bool test_indexed_load_store() {
+bool test_indexed_load_store(CoreType core) {
     // Test LDR and STR — indexed memory access via R2:R3 pointer.
     //
     // Store 42 to address 0x0050 using STR, then load it back with LDR.
     // Also test that we can iterate through memory by incrementing R3.
-    Computer c;
+    Computer c(core);
     std::vector<uint8_t> prog;
 
     // Set up pointer R2:R3 = 0x0050
@@ -412,28 +725,1295 @@ bool test_indexed_load_store() {
     return pass;
 }
 
+// Two registers: reg 0 reads back what was last written to reg 1, plus one
+struct PlusOneDevice : Device {
+    uint8_t latched = 0;
+    uint8_t read_reg(uint8_t reg) override { return reg == 0 ? latched + 1 : 0; }
+    void write_reg(uint8_t reg, uint8_t val) override { if (reg == 1) latched = val; }
+};
+
+bool test_mapped_device(CoreType core) {
+    // A device mapped next to the built-in ones, driven by ST/LD and by
+    // STR/LDR through R2:R3. Unclaimed I/O bytes read as 0, and ranges
+    // that overlap a device or leave the I/O region are refused.
+    Computer c(core);
+    PlusOneDevice dev;
+    bool mapped = c.get_bus().map_device(0xF010, 2, dev);
+    bool refused = !c.get_bus().map_device(0xF003, 1, dev) && !c.get_bus().map_device(0xEFFF, 2, dev);
+
+    std::vector<uint8_t> prog;
+    emit(prog, 0x1, 0, 0, 41);         // LDI R0, 41
+    emit(prog, 0x3, 0, 0, 0xF011);     // ST R0, [0xF011]
+    emit(prog, 0x2, 1, 0, 0xF010);     // LD R1, [0xF010]  -> 42
+    emit(prog, 0x1, 2, 0, 0xF0);       // LDI R2, 0xF0
+    emit(prog, 0x1, 3, 0, 0x11);       // LDI R3, 0x11
+    emit(prog, 0x1, 0, 0, 98);         // LDI R0, 98
+    emit(prog, 0x3, 0, 1, 0);          // STR R0, [R2:R3]
+    emit(prog, 0x1, 3, 0, 0x10);       // LDI R3, 0x10
+    emit(prog, 0x2, 0, 1, 0);          // LDR R0, [R2:R3]  -> 99
+    emit(prog, 0x1, 3, 0, 7);          // LDI R3, 7
+    emit(prog, 0x2, 3, 0, 0xF800);     // LD R3, [0xF800]  -> 0 (unmapped)
+    emit(prog, 0xF, 0, 0, 0);          // HLT
+    c.load_program(prog.data(), prog.size());
+    c.run();
+
+    Core& cpu = c.get_cpu();
+    bool pass = mapped && refused && cpu.get_reg(1) == 42 && cpu.get_reg(0) == 99 && cpu.get_reg(3) == 0;
+    std::cout << "test_mmio: R1=" << (int)cpu.get_reg(1) << " R0=" << (int)cpu.get_reg(0)
+              << " R3=" << (int)cpu.get_reg(3) << " (expect 42, 99, 0) " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_bus_burst() {
+    // Bursts that cross into the I/O region and past 0xFFFF must match
+    // byte-at-a-time access, and code watchers still see every write.
+    Computer c(CoreType::Fast);
+    Bus& bus = c.get_bus();
+    PlusOneDevice dev;
+    bus.map_device(0xFFFE, 2, dev);
+
+    std::vector<uint8_t> image(Bus::RAM_SIZE);
+    for (size_t i = 0; i < image.size(); i++) image[i] = uint8_t(i * 7 + 3);
+    bus.load(0, image.data(), image.size());
+    bool loaded = true;
+    for (uint32_t a = 0; a < Bus::RAM_SIZE; a += 251) loaded = loaded && bus.read_byte(a) == image[a];
+
+    // 0xEFFC..0xF003 spans RAM, then the timer and UART registers
+    uint8_t span[8];
+    bus.read(0xEFFC, span, 8);
+    bool io_split = true;
+    for (int i = 0; i < 8; i++) io_split = io_split && span[i] == bus.read_byte(0xEFFC + i);
+
+    // 0xFFFD..0x0002: unmapped, the device's two registers, then RAM again
+    const uint8_t wrap_in[6] = {1, 2, 41, 4, 5, 6};
+    bus.write(0xFFFD, wrap_in, 6);
+    uint8_t wrap_out[6];
+    bus.read(0xFFFD, wrap_out, 6);
+    bool wrapped = wrap_out[0] == 0 && wrap_out[1] == 42 && wrap_out[2] == 0
+                && wrap_out[3] == 4 && wrap_out[4] == 5 && wrap_out[5] == 6;
+
+    std::vector<uint32_t> seen;
+    bus.add_code_watcher([&](uint32_t addr) { seen.push_back(addr); });
+    bus.mark_code(0x0200, 3);
+    const uint8_t patch[4] = {9, 9, 9, 9};
+    bus.write(0x01FE, patch, 4);   // two bytes on an unmarked page, two on the code page
+    bool watched = seen.size() == 2 && seen[0] == 0x0200 && seen[1] == 0x0201;
+
+    bool pass = loaded && io_split && wrapped && watched;
+    std::cout << "test_bus_burst: load=" << loaded << " io=" << io_split << " wrap=" << wrapped
+              << " watch=" << watched << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_core_watchers() {
+    // Cores built on a bus that outlives them: each removes its code
+    // and remap watchers when it goes, so later code writes and remaps
+    // call only what's still there
+    Bus bus;
+    std::vector<uint8_t> prog;
+    emit(prog, 0x1, 0, 0, 7);   // addr 0: LDI R0, 7
+    emit(prog, 0xA, 0, 0, 0);   // addr 3: JMP 0
+    bus.load(0, prog.data(), prog.size());
+    for (CoreType type : {CoreType::Gate, CoreType::Threaded, CoreType::Jit}) {
+        std::unique_ptr<Core> core = Computer::make_core(type, bus);
+        core->reset();
+        for (int i = 0; i < 10; i++) core->step();
+    }
+
+    int calls = 0;
+    Bus::WatcherId id = bus.add_code_watcher([&](uint32_t) { calls++; });
+    bus.map_window(0, Bus::NUM_WINDOWS);   // a frame no other window shows
+    bus.mark_code(0, 6);
+    bus.write_byte(0, 8);
+    bool kept = calls == 1;
+    bus.remove_watcher(id);
+    bus.write_byte(0, 9);
+    bool removed = calls == 1;
+
+    bool pass = kept && removed;
+    std::cout << "test_core_watchers: kept=" << kept << " removed=" << removed << " "
+              << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_sparse_memory() {
+    // A fresh Computer allocates no RAM; reads of untouched pages are
+    // zero and allocate nothing; a write allocates just its 4 KB page,
+    // and the bus sees the new page straight away.
+    Computer c(CoreType::Fast);
+    const Memory& ram = c.get_bus().get_ram();
+    size_t fresh = ram.allocated_pages();
+
+    uint8_t probe[16];
+    c.get_bus().read(0x7FF8, probe, 16);
+    bool zeros = probe[0] == 0 && probe[15] == 0 && ram.allocated_pages() == 0;
+
+    c.get_bus().write_byte(0x8123, 0x5A);
+    bool one_page = ram.allocated_pages() == 1 && ram.is_allocated(0x8123 / Memory::PAGE_SIZE);
+    bool visible = c.get_bus().read_byte(0x8123) == 0x5A && c.get_bus().read_byte(0x80FF) == 0;
+
+    bool sized = ram.size() == uint32_t(Memory::SIZE) && Memory(Bus::RAM_SIZE).size() == Bus::RAM_SIZE;
+
+    bool pass = fresh == 0 && zeros && one_page && visible && sized;
+    std::cout << "test_sparse_memory: fresh=" << fresh << " pages after write=" << ram.allocated_pages()
+              << " (expect 0, 1) " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_bank_switch(CoreType core) {
+    // Window 2 (0x2000) flips between frame 2 and frame 0x40, which
+    // hold different data; window 1 (0x1000) flips between two
+    // versions of a subroutine, so cached translations must go too.
+    Computer c(core);
+    Bus& bus = c.get_bus();
+
+    std::vector<uint8_t> one, two;
+    emit(one, 0x1, 0, 0, 1);           // LDI R0, 1
+    emit(one, 0x0, 0, 3, 0);           // RET
+    emit(two, 0x1, 0, 0, 2);           // LDI R0, 2
+    emit(two, 0x0, 0, 3, 0);           // RET
+    c.load_program(one.data(), one.size(), 0x1000);
+    bus.map_window(1, 0x41);
+    c.load_program(two.data(), two.size(), 0x1000);
+    bus.map_window(1, 1);
+
+    std::vector<uint8_t> prog;
+    emit(prog, 0x1, 0, 0, 0xAA);       // addr 0:  LDI R0, 0xAA
+    emit(prog, 0x3, 0, 0, 0x2000);     // addr 3:  ST R0, [0x2000]   (frame 2)
+    emit(prog, 0x1, 0, 0, 0x40);       // addr 6:  LDI R0, 0x40
+    emit(prog, 0x3, 0, 0, 0xF022);     // addr 9:  ST R0, [bank 2]
+    emit(prog, 0x2, 2, 0, 0x2000);     // addr 12: LD R2, [0x2000]   (fresh frame: 0)
+    emit(prog, 0x1, 0, 0, 2);          // addr 15: LDI R0, 2
+    emit(prog, 0x3, 0, 0, 0xF022);     // addr 18: ST R0, [bank 2]
+    emit(prog, 0x2, 3, 0, 0x2000);     // addr 21: LD R3, [0x2000]   (0xAA again)
+    emit(prog, 0xE, 0, 0, 0x1000);     // addr 24: CALL 0x1000
+    emit(prog, 0x8, 1, 0, 0);          // addr 27: MOV R1, R0
+    emit(prog, 0x1, 0, 0, 0x41);       // addr 30: LDI R0, 0x41
+    emit(prog, 0x3, 0, 0, 0xF021);     // addr 33: ST R0, [bank 1]
+    emit(prog, 0xE, 0, 0, 0x1000);     // addr 36: CALL 0x1000
+    emit(prog, 0xF, 0, 0, 0);          // addr 39: HLT
+    c.load_program(prog.data(), prog.size());
+    c.run();
+
+    Core& cpu = c.get_cpu();
+    bool pass = cpu.get_reg(2) == 0 && cpu.get_reg(3) == 0xAA && cpu.get_reg(1) == 1 && cpu.get_reg(0) == 2
+             && bus.window_frame(1) == 0x41 && c.get_banks().read_reg(2) == 2;
+    std::cout << "test_bank: R2=" << (int)cpu.get_reg(2) << " R3=" << (int)cpu.get_reg(3)
+              << " R1=" << (int)cpu.get_reg(1) << " R0=" << (int)cpu.get_reg(0)
+              << " (expect 0, 170, 1, 2) " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_fork(CoreType core) {
+    // Fork mid-run: the child carries on exactly as the parent does,
+    // shares its pages until one side writes, and never sees the
+    // other's writes afterwards.
+    Computer parent(core);
+    std::vector<uint8_t> prog;
+    emit(prog, 0x2, 0, 0, 0x3000);     // addr 0:  LD R0, [0x3000]
+    emit(prog, 0xD, 0, 0, 1);          // addr 3:  ADDI R0, 1
+    emit(prog, 0x3, 0, 0, 0x3000);     // addr 6:  ST R0, [0x3000]
+    emit(prog, 0x3, 0, 0, 0xF002);     // addr 9:  ST R0, [UART data]
+    emit(prog, 0xA, 0, 0, 0);          // addr 12: JMP 0
+    parent.load_program(prog.data(), prog.size());
+    parent.run(50);
+
+    auto child = parent.fork();
+    const uint32_t frame = 0x3000 / Memory::PAGE_SIZE;
+    bool shared = !parent.get_bus().get_ram().is_writable(frame) && !child->get_bus().get_ram().is_writable(frame);
+
+    parent.run(50);
+    child->run(50);
+    CoreState a = parent.get_cpu().get_state(), b = child->get_cpu().get_state();
+    bool same = a.pc == b.pc && a.regs[0] == b.regs[0]
+             && parent.get_bus().read_byte(0x3000) == child->get_bus().read_byte(0x3000)
+             && parent.get_uart().recv_string() == child->get_uart().recv_string();
+
+    child->run(50);
+    child->get_bus().write_byte(0x5000, 0x77);
+    bool apart = parent.get_bus().read_byte(0x3000) == 20 && child->get_bus().read_byte(0x3000) == 30
+              && parent.get_bus().read_byte(0x5000) == 0;
+
+    bool pass = shared && same && apart;
+    std::cout << "test_fork: shared=" << shared << " same=" << same << " apart=" << apart
+              << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_snapshot(CoreType core) {
+    // Full snapshot, then a delta: the delta holds only the frame the
+    // program wrote, and restoring both into a fresh Computer (over
+    // stale memory and windows) carries on exactly like the original.
+    const char* full_path = "seedisa_test_full.snap";
+    const char* delta_path = "seedisa_test_delta.snap";
+    Computer a(core);
+    std::vector<uint8_t> prog;
+    emit(prog, 0x2, 0, 0, 0x3000);     // addr 0:  LD R0, [0x3000]
+    emit(prog, 0xD, 0, 0, 1);          // addr 3:  ADDI R0, 1
+    emit(prog, 0x3, 0, 0, 0x3000);     // addr 6:  ST R0, [0x3000]
+    emit(prog, 0x3, 0, 0, 0xF002);     // addr 9:  ST R0, [UART data]
+    emit(prog, 0xA, 0, 0, 0);          // addr 12: JMP 0
+    a.load_program(prog.data(), prog.size());
+    a.get_bus().map_window(5, 0x40);
+    a.get_bus().write_byte(0x5000, 0x99);
+    a.run(50);
+    bool saved = Snapshot::save(a, full_path);
+
+    a.run(50);
+    bool delta_saved = Snapshot::save(a, delta_path, Snapshot::Kind::Delta);
+    const uint32_t frame = 0x3000 / Memory::PAGE_SIZE;
+    bool delta_small = true;
+    for (uint32_t f = 0; f < Bus::NUM_FRAMES; f++) delta_small = delta_small && !a.get_bus().is_dirty(f);
+    if (FILE* f = std::fopen(delta_path, "rb")) {
+        std::fseek(f, 0, SEEK_END);
+        delta_small = delta_small && std::ftell(f) == long(2 * Snapshot::ALIGN);   // header + frame 3
+        std::fclose(f);
+    }
+
+    Computer b(core);
+    b.get_bus().write_byte(0x8000, 0x55);
+    b.get_bus().map_window(5, 7);
+    bool restored = Snapshot::restore(b, full_path) && Snapshot::restore(b, delta_path);
+    bool state = b.get_bus().read_byte(0x8000) == 0 && b.get_bus().window_frame(5) == 0x40
+              && b.get_bus().read_byte(0x5000) == 0x99 && b.get_bus().read_byte(0x3000) == a.get_bus().read_byte(0x3000)
+              && b.get_uart().recv_string() == a.get_uart().recv_string();
+
+    a.run(50);
+    b.run(50);
+    CoreState x = a.get_cpu().get_state(), y = b.get_cpu().get_state();
+    bool same = x.pc == y.pc && x.regs[0] == y.regs[0] && b.get_bus().read_byte(0x3000) == a.get_bus().read_byte(0x3000)
+             && b.get_uart().recv_string() == a.get_uart().recv_string() && b.get_bus().is_dirty(frame);
+    bool rejected = !Snapshot::restore(b, "seedisa_test_missing.snap");
+    std::remove(full_path);
+    std::remove(delta_path);
+
+    bool pass = saved && delta_saved && delta_small && restored && state && same && rejected;
+    std::cout << "test_snapshot: saved=" << (saved && delta_saved) << " delta=" << delta_small
+              << " restored=" << (restored && state) << " same=" << same << " rejected=" << rejected
+              << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_snapshot_versions() {
+    // A version 3 file cut down to version 2 (no interrupt controller)
+    // and version 1 (no DMA either) still restores, the missing devices
+    // at reset. A version newer than Snapshot::VERSION is refused.
+    const char* path = "seedisa_test_version.snap";
+    Computer a;
+    a.get_bus().write_byte(0x3000, 0x42);
+    CoreState s = a.get_cpu().get_state();
+    s.regs[1] = 9;
+    a.get_cpu().set_state(s);
+    DMA::State d;
+    d.src = 0x1234;
+    a.get_dma().set_state(d);
+    a.get_intc().write_reg(1, 0x0F);   // mask
+    bool saved = Snapshot::save(a, path);
+
+    std::vector<uint8_t> v3;
+    if (FILE* f = std::fopen(path, "rb")) {
+        for (int c; (c = std::fgetc(f)) != EOF; ) v3.push_back(uint8_t(c));
+        std::fclose(f);
+    }
+    auto at32 = [&](size_t i) { return v3[i] | v3[i + 1] << 8 | v3[i + 2] << 16 | uint32_t(v3[i + 3]) << 24; };
+    const size_t DMA_BYTES = 12, INTC_BYTES = 11;
+    // As `version`: drop the devices after the UART buffers it doesn't
+    // have, padding the header so the frames stay 4 KB aligned
+    auto restore_as = [&](Computer& c, uint32_t version) {
+        std::vector<uint8_t> f = v3;
+        size_t tail = 52 + 4 + at32(52);
+        tail += 4 + at32(tail);
+        size_t keep = version >= 2 ? DMA_BYTES : 0;
+        size_t drop = version >= 3 ? 0 : DMA_BYTES + INTC_BYTES - keep;
+        f[8] = uint8_t(version);
+        f.erase(f.begin() + tail + keep, f.begin() + tail + keep + drop);
+        f.insert(f.begin() + Snapshot::ALIGN - drop, drop, 0);
+        FILE* out = std::fopen(path, "wb");
+        bool ok = out && std::fwrite(f.data(), 1, f.size(), out) == f.size();
+        if (out) std::fclose(out);
+        return ok && Snapshot::restore(c, path);
+    };
+    auto restored = [](Computer& c) {
+        return c.get_cpu().get_state().regs[1] == 9 && c.get_bus().read_byte(0x3000) == 0x42;
+    };
+
+    Computer b, c, e;
+    b.get_intc().write_reg(1, 0xFF);
+    c.get_intc().write_reg(1, 0xFF);
+    c.get_dma().set_state(DMA::State{0x5555, 0, 0, 0, 0, 0});
+    bool v2 = v3.size() > Snapshot::ALIGN && restore_as(b, 2) && restored(b)
+           && b.get_dma().get_state().src == 0x1234 && b.get_intc().get_state().mask == 0;
+    bool v1 = restore_as(c, 1) && restored(c)
+           && c.get_dma().get_state().src == 0 && c.get_intc().get_state().mask == 0;
+    bool newer = !restore_as(e, Snapshot::VERSION + 1) && !restored(e);
+    std::remove(path);
+
+    bool pass = saved && v2 && v1 && newer;
+    std::cout << "test_snapshot_versions: v2=" << v2 << " v1=" << v1 << " newer rejected=" << newer
+              << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_replay(CoreType core) {
+    // Record a run with timer interrupts and host input arriving
+    // mid-run, then replay it: to the end, back to the middle (past
+    // several checkpoints) and forward again, matching the original
+    // state every time.
+    Computer c(core);
+    c.get_bus().write_word(0xEFF2, 0x0100);   // IVT 1 (timer)
+    c.get_bus().write_word(0xEFF4, 0x0200);   // IVT 2 (UART)
+    std::vector<uint8_t> prog;
+    emit(prog, 0x0, 2, 0, 0);          // addr 0:  STI
+    emit(prog, 0x1, 0, 0, 7);          // addr 3:  LDI R0, 7
+    emit(prog, 0x3, 0, 0, 0xF000);     // addr 6:  ST R0, [timer reload]
+    emit(prog, 0x1, 0, 0, 2);          // addr 9:  LDI R0, 2
+    emit(prog, 0x3, 0, 0, 0xF001);     // addr 12: ST R0, [timer ctrl]
+    emit(prog, 0xD, 3, 0, 1);          // addr 15: ADDI R3, 1
+    emit(prog, 0x3, 3, 0, 0x3000);     // addr 18: ST R3, [0x3000]
+    emit(prog, 0xA, 0, 0, 15);         // addr 21: JMP 15
+    c.load_program(prog.data(), prog.size());
+    std::vector<uint8_t> timer_isr, uart_isr;
+    emit(timer_isr, 0xD, 2, 0, 1);     // ADDI R2, 1
+    emit(timer_isr, 0x0, 3, 0, 0);     // RTI
+    emit(uart_isr, 0x2, 1, 0, 0xF002); // LD R1, [UART data]
+    emit(uart_isr, 0x4, 0, 1, 0);      // ADD R0, R1
+    emit(uart_isr, 0x3, 0, 0, 0x3001); // ST R0, [0x3001]
+    emit(uart_isr, 0x3, 1, 0, 0xF002); // ST R1, [UART data] (echo)
+    emit(uart_isr, 0x0, 3, 0, 0);      // RTI
+    c.load_program(timer_isr.data(), timer_isr.size(), 0x0100);
+    c.load_program(uart_isr.data(), uart_isr.size(), 0x0200);
+
+    auto same = [](Computer& a, Computer& b) {
+        CoreState x = a.get_cpu().get_state(), y = b.get_cpu().get_state();
+        Timer::State s = a.get_timer().get_state(), t = b.get_timer().get_state();
+        return a.get_step_count() == b.get_step_count() && x.pc == y.pc && x.sp == y.sp
+            && std::equal(x.regs, x.regs + 4, y.regs) && x.zero == y.zero && x.carry == y.carry
+            && x.int_enabled == y.int_enabled && x.int_pending == y.int_pending
+            && s.counter == t.counter && s.fired == t.fired
+            && a.get_bus().read_word(0x3000) == b.get_bus().read_word(0x3000)
+            && a.get_uart().get_state().tx == b.get_uart().get_state().tx;
+    };
+
+    Recorder rec(c, 64);
+    rec.run(100);
+    rec.send_char('a');
+    rec.run(37);
+    rec.send_char('b');
+    rec.raise_interrupt(1);
+    rec.step();
+    rec.send_char('c');
+    auto middle = c.fork();
+    rec.run(300);
+    rec.send_char('d');
+    rec.run(50);
+    bool recorded = rec.recording().events.size() == 5 && rec.recording().checkpoints.size() == 8
+                 && c.get_uart().get_state().tx == "abc";   // b and c share one interrupt
+
+    Replayer r(rec.recording());
+    r.seek(c.get_step_count());
+    bool end = same(r.computer(), c);
+    r.step_back(c.get_step_count() - middle->get_step_count());
+    bool back = same(r.computer(), *middle);
+    r.step_forward(c.get_step_count() - r.position());
+    bool forward = same(r.computer(), c);
+
+    bool pass = recorded && end && back && forward;
+    std::cout << "test_replay: recorded=" << recorded << " end=" << end << " back=" << back
+              << " forward=" << forward << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_replay_uart_input(CoreType core) {
+    // Input sent in bulk, whichever way (the Recorder, the UART itself,
+    // quiet, through a UartFd), is logged and replays to the same state
+    Computer c(core);
+    c.get_bus().write_word(0xEFF4, 0x0100);   // IVT 2 (UART)
+    std::vector<uint8_t> prog, isr;
+    emit(prog, 0x0, 2, 0, 0);          // addr 0: STI
+    emit(prog, 0xA, 0, 0, 3);          // addr 3: JMP 3
+    emit(isr, 0x2, 0, 0, 0xF003);      // 0x100: LD R0, [UART status]
+    emit(isr, 0x1, 1, 0, 1);           // 0x103: LDI R1, 1
+    emit(isr, 0x6, 0, 1, 0);           // 0x106: AND R0, R1
+    emit(isr, 0xB, 0, 0, 0x0118);      // 0x109: JZ 0x118
+    emit(isr, 0x2, 0, 0, 0xF002);      // 0x10C: LD R0, [UART data]
+    emit(isr, 0x4, 3, 0, 0);           // 0x10F: ADD R3, R0
+    emit(isr, 0x3, 0, 0, 0xF002);      // 0x112: ST R0, [UART data]
+    emit(isr, 0xA, 0, 0, 0x0100);      // 0x115: JMP 0x100
+    emit(isr, 0xD, 2, 0, 1);           // 0x118: ADDI R2, 1
+    emit(isr, 0x0, 3, 0, 0);           // 0x11B: RTI
+    c.load_program(prog.data(), prog.size());
+    c.load_program(isr.data(), isr.size(), 0x0100);
+
+    Recorder rec(c, 64);
+    rec.run(20);
+    rec.send_string("hello");
+    rec.run(100);
+    c.get_uart().send_string(" world");
+    rec.run(100);
+    c.get_uart().send_string_quiet("!?");   // read by the next interrupt
+    rec.run(30);
+#if SEEDISA_UART_FD
+    int in[2];
+    if (::pipe(in) == 0) {
+        UartFd console(c.get_uart(), in[0], -1);
+        if (::write(in[1], "abc", 3) == 3) console.pump();
+        ::close(in[0]); ::close(in[1]);
+    }
+#endif
+    auto middle = c.fork();
+    rec.run(200);
+    const std::string echoed = c.get_uart().get_state().tx;
+    bool recorded = echoed.compare(0, 11, "hello world") == 0 && rec.recording().input.size() == echoed.size();
+
+    auto same = [](Computer& a, Computer& b) {
+        CoreState x = a.get_cpu().get_state(), y = b.get_cpu().get_state();
+        return a.get_step_count() == b.get_step_count() && x.pc == y.pc
+            && std::equal(x.regs, x.regs + 4, y.regs) && x.int_pending == y.int_pending
+            && a.get_uart().get_state().tx == b.get_uart().get_state().tx;
+    };
+    Replayer r(rec.recording());
+    r.seek(c.get_step_count());
+    bool end = same(r.computer(), c);
+    r.step_back(c.get_step_count() - middle->get_step_count());
+    bool back = same(r.computer(), *middle);
+
+    bool pass = recorded && end && back;
+    std::cout << "test_replay_uart_input: echoed=\"" << echoed << "\" recorded=" << recorded
+              << " end=" << end << " back=" << back << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_breakpoints(CoreType core) {
+    // run() stops at a breakpoint (and carries on past it next time),
+    // after a watched read or write, and not for accesses to unwatched
+    // bytes of a watched page or for fetches from watched code.
+    Computer c(core);
+    std::vector<uint8_t> prog;
+    emit(prog, 0x1, 0, 0, 0);          // addr 0:  LDI R0, 0
+    emit(prog, 0xD, 0, 0, 1);          // addr 3:  ADDI R0, 1
+    emit(prog, 0x3, 0, 0, 0x3010);     // addr 6:  ST R0, [0x3010]
+    emit(prog, 0x2, 1, 0, 0x4020);     // addr 9:  LD R1, [0x4020]
+    emit(prog, 0xA, 0, 0, 3);          // addr 12: JMP 3
+    c.load_program(prog.data(), prog.size());
+    Bus& bus = c.get_bus();
+
+    c.add_breakpoint(9);
+    bool brk = c.run(1000) == StopReason::Breakpoint && c.get_cpu().get_pc() == 9 && c.get_cpu().get_reg(0) == 1
+            && c.run(1000) == StopReason::Breakpoint && c.get_cpu().get_reg(0) == 2;
+    c.clear_breakpoints();
+
+    bus.add_watchpoint(0x3010, 1, Bus::WATCH_WRITE);
+    bool write = c.run(1000) == StopReason::Watchpoint && c.get_cpu().get_pc() == 9
+              && bus.get_watch_hit().addr == 0x3010 && bus.get_watch_hit().kind == Bus::WATCH_WRITE
+              && bus.get_watch_hit().value == 3 && bus.read_byte(0x3010) == 3;
+    bus.clear_watchpoints();
+
+    bus.add_watchpoint(0x4020, 1, Bus::WATCH_READ);
+    bool read = c.run(1000) == StopReason::Watchpoint && c.get_cpu().get_pc() == 12
+             && bus.get_watch_hit().kind == Bus::WATCH_READ;
+    bus.clear_watchpoints();
+
+    bus.add_watchpoint(0x3011, 1, Bus::WATCH_READ | Bus::WATCH_WRITE);
+    bus.add_watchpoint(0x0000, 16, Bus::WATCH_READ);
+    uint8_t before = c.get_cpu().get_reg(0);
+    bool quiet = c.run(40) == StopReason::Budget && bus.read_byte(0x3010) == c.get_cpu().get_reg(0)
+              && uint8_t(before + 10) == c.get_cpu().get_reg(0);
+    bus.clear_watchpoints();
+    bool cleared = !bus.has_watchpoints() && c.run(40) == StopReason::Budget;
+
+    bool pass = brk && write && read && quiet && cleared;
+    std::cout << "test_brk:  break=" << brk << " write=" << write << " read=" << read << " quiet=" << quiet
+              << " cleared=" << cleared << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_scheduler() {
+    // Time passing leaves the deadlines alone: the timer is asked once
+    // for a run of batches, and again only after it fires or its
+    // registers are written.
+    struct CountingTimer : Timer {
+        using Timer::Timer;
+        mutable int asked = 0;
+        uint32_t quiet_ticks() const override { asked++; return Timer::quiet_ticks(); }
+    };
+    Computer c;
+    CountingTimer t(c.get_cpu());
+    Scheduler sched;
+    sched.add(t);
+    t.write_reg(0, 100);
+    t.write_reg(1, 2);
+    bool counted = true;
+    for (uint32_t left = 99; left > 9; left -= 10) {
+        counted = counted && sched.quiet_ticks() == left;
+        sched.advance(10);
+    }
+    int batches = t.asked;
+    sched.advance(10);   // fires
+    bool fired = sched.quiet_ticks() == UINT32_MAX && t.asked == 2;
+    t.write_reg(1, 2);   // ack
+    bool acked = sched.quiet_ticks() == 99 && t.asked == 3;
+
+    bool pass = counted && batches == 1 && fired && acked;
+    std::cout << "test_scheduler: deadlines=" << counted << " asked=" << batches
+              << " (expect 1) fired=" << fired << " acked=" << acked << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_idle_skip(CoreType core) {
+    // A guest waiting on JMP . for the timer: run() lets the idle steps
+    // pass in one go, and ends up exactly where stepping one at a time
+    // does. Then a long run, which only finishes quickly if it skips.
+    auto build = [core] {
+        auto c = std::make_unique<Computer>(core);
+        c->get_bus().write_word(0xEFF2, 0x0100);   // IVT 1 (timer)
+        std::vector<uint8_t> prog, isr;
+        emit(prog, 0x0, 2, 0, 0);          // addr 0:  STI
+        emit(prog, 0x1, 0, 0, 200);        // addr 3:  LDI R0, 200
+        emit(prog, 0x3, 0, 0, 0xF000);     // addr 6:  ST R0, [timer reload]
+        emit(prog, 0x1, 0, 0, 2);          // addr 9:  LDI R0, 2
+        emit(prog, 0x3, 0, 0, 0xF001);     // addr 12: ST R0, [timer ctrl]
+        emit(prog, 0xA, 0, 0, 15);         // addr 15: JMP 15
+        emit(isr, 0xD, 2, 0, 1);           // ADDI R2, 1
+        emit(isr, 0x1, 1, 0, 2);           // LDI R1, 2
+        emit(isr, 0x3, 1, 0, 0xF001);      // ST R1, [timer ctrl] (ack)
+        emit(isr, 0x0, 3, 0, 0);           // RTI
+        c->load_program(prog.data(), prog.size());
+        c->load_program(isr.data(), isr.size(), 0x0100);
+        return c;
+    };
+
+    auto a = build(), b = build();
+    a->run(1000);
+    a->run(4000);
+    for (int i = 0; i < 5000; i++) b->step();
+    CoreState x = a->get_cpu().get_state(), y = b->get_cpu().get_state();
+    bool same = a->get_step_count() == 5000 && b->get_step_count() == 5000 && x.pc == y.pc
+             && x.regs[2] == y.regs[2] && x.regs[2] > 0 && x.sp == y.sp && x.int_pending == y.int_pending
+             && a->get_timer().get_state().counter == b->get_timer().get_state().counter;
+
+    const int LONG = 20000000;   // the timer counts through the handler: one interrupt per 200 steps
+    uint8_t ticks = x.regs[2];
+    a->run(LONG);
+    bool skipped = a->get_step_count() == 5000u + LONG && uint8_t(a->get_cpu().get_reg(2) - ticks) == uint8_t(LONG / 200);
+
+    bool pass = same && skipped;
+    std::cout << "test_idle: same=" << same << " skipped=" << skipped << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_cycles(CoreType core) {
+    // With the standard costs, steps take different numbers of cycles
+    // and the timer counts cycles. Running by a cycle budget or a step
+    // budget ends up exactly where stepping one at a time does.
+    auto build = [core] {
+        auto c = std::make_unique<Computer>(core);
+        c->set_cycle_costs(CycleCosts::standard());
+        c->get_bus().write_word(0xEFF2, 0x0100);   // IVT 1 (timer)
+        std::vector<uint8_t> prog, isr;
+        emit(prog, 0x0, 2, 0, 0);          // addr 0:  STI
+        emit(prog, 0x1, 0, 0, 100);        // addr 3:  LDI R0, 100
+        emit(prog, 0x3, 0, 0, 0xF000);     // addr 6:  ST R0, [timer reload]
+        emit(prog, 0x1, 0, 0, 2);          // addr 9:  LDI R0, 2
+        emit(prog, 0x3, 0, 0, 0xF001);     // addr 12: ST R0, [timer ctrl]
+        emit(prog, 0xE, 0, 0, 30);         // addr 15: CALL 30
+        emit(prog, 0xD, 3, 0, 1);          // addr 18: ADDI R3, 1
+        emit(prog, 0x3, 3, 0, 0x3000);     // addr 21: ST R3, [0x3000]
+        emit(prog, 0xA, 0, 0, 15);         // addr 24: JMP 15
+        emit(prog, 0x0, 0, 0, 0);          // addr 27: NOP
+        emit(prog, 0x0, 3, 1, 0);          // addr 30: PUSH R3
+        emit(prog, 0x0, 1, 2, 0);          // addr 33: POP R1
+        emit(prog, 0x0, 0, 3, 0);          // addr 36: RET
+        emit(isr, 0xD, 2, 0, 1);           // ADDI R2, 1
+        emit(isr, 0x1, 1, 0, 2);           // LDI R1, 2
+        emit(isr, 0x3, 1, 0, 0xF001);      // ST R1, [timer ctrl] (ack)
+        emit(isr, 0x0, 3, 0, 0);           // RTI
+        c->load_program(prog.data(), prog.size());
+        c->load_program(isr.data(), isr.size(), 0x0100);
+        return c;
+    };
+    auto same = [](Computer& a, Computer& b) {
+        CoreState x = a.get_cpu().get_state(), y = b.get_cpu().get_state();
+        return a.get_step_count() == b.get_step_count() && a.get_cycle_count() == b.get_cycle_count()
+            && x.pc == y.pc && x.sp == y.sp && std::equal(x.regs, x.regs + 4, y.regs)
+            && x.int_pending == y.int_pending && x.int_enabled == y.int_enabled
+            && a.get_timer().get_state().counter == b.get_timer().get_state().counter;
+    };
+
+    auto a = build(), b = build();
+    for (int i = 0; i < 5; i++) b->step();
+    bool costs = b->get_cycle_count() == 3 + 4 + 6 + 4 + 6;   // STI, LDI, ST, LDI, ST
+
+    a->run_cycles(4000);
+    while (b->get_cycle_count() < 4000) b->step();
+    bool by_cycles = same(*a, *b) && a->get_cycle_count() - 4000 < 14 && a->get_cpu().get_reg(2) > 0;
+
+    a->run(1500);
+    for (int i = 0; i < 1500; i++) b->step();
+    bool by_steps = same(*a, *b) && a->get_cycle_count() > a->get_step_count();
+
+    Computer plain(core);
+    plain.run(100);
+    bool uniform = plain.get_cycle_count() == plain.get_step_count();
+
+    bool pass = costs && by_cycles && by_steps && uniform;
+    std::cout << "test_cycles: costs=" << costs << " by_cycles=" << by_cycles << " by_steps=" << by_steps
+              << " uniform=" << uniform << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_trace(CoreType core) {
+    // Trace an interrupt entry, a store and a call, and read the file
+    // back. Then a 1-slot ring: whatever the writer can't keep up with
+    // is dropped and counted, never waited for.
+    const char* path = "seedisa_test.trace";
+    Computer c(core);
+    c.get_bus().write_word(0xEFF2, 0x0100);   // IVT 1
+    std::vector<uint8_t> prog, isr;
+    emit(prog, 0x0, 2, 0, 0);          // addr 0:  STI
+    emit(prog, 0x1, 0, 0, 5);          // addr 3:  LDI R0, 5
+    emit(prog, 0x3, 0, 0, 0x3000);     // addr 6:  ST R0, [0x3000]
+    emit(prog, 0xE, 0, 0, 15);         // addr 9:  CALL 15
+    emit(prog, 0xF, 0, 0, 0);          // addr 12: HLT
+    emit(prog, 0xD, 0, 0, 1);          // addr 15: ADDI R0, 1
+    emit(prog, 0x0, 0, 3, 0);          // addr 18: RET
+    emit(isr, 0x0, 3, 0, 0);           // RTI
+    c.load_program(prog.data(), prog.size());
+    c.load_program(isr.data(), isr.size(), 0x0100);
+    c.get_cpu().raise_interrupt(1);
+
+    Tracer tracer(path);
+    c.set_tracer(&tracer);
+    c.run();
+    c.set_tracer(nullptr);
+    bool stopped = tracer.stop() && tracer.written() == 9 && tracer.dropped() == 0;
+
+    std::vector<TraceRecord> t;
+    bool read = Tracer::read_file(path, t) && t.size() == 9;
+    bool records = read
+        && t[0].pc == 0 && t[0].inst[2] == 0x08 && (t[0].flags & 4)
+        && t[1].kind == TraceRecord::INTERRUPT && t[1].inst[0] == 1 && t[1].pc == 3
+        && t[1].mem_len == 3 && t[1].mem_addr == 0xEFFC && t[1].mem[1] == 3 && !(t[1].flags & 4)
+        && t[2].pc == 0x100 && t[3].pc == 3 && t[3].regs_changed == 1 && t[3].regs[0] == 5
+        && t[4].mem_addr == 0x3000 && t[4].mem_len == 1 && t[4].mem[0] == 5
+        && t[5].mem_len == 2 && t[5].mem_addr == 0xEFFD && t[5].sp == 0xEFFD
+        && t[6].pc == 15 && t[6].regs[0] == 6 && t[8].pc == 12 && (t[8].flags & 8);
+    std::remove(path);
+
+    Computer d(core);
+    std::vector<uint8_t> spin;
+    emit(spin, 0xD, 0, 0, 1);          // addr 0: ADDI R0, 1
+    emit(spin, 0xA, 0, 0, 0);          // addr 3: JMP 0
+    d.load_program(spin.data(), spin.size());
+    Tracer small(path, 1);
+    d.set_tracer(&small);
+    d.run(5000);
+    d.set_tracer(nullptr);
+    small.stop();
+    bool counted = small.written() + small.dropped() == 5000;
+    std::remove(path);
+
+    bool pass = stopped && read && records && counted;
+    std::cout << "test_trace: stopped=" << stopped << " read=" << read << " records=" << records
+              << " counted=" << counted << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_trace_dma(CoreType core) {
+    // A DMA copy started by a store, and a paced fill that completes
+    // while later instructions run: the trace shows only the CPU's own
+    // writes, though the bytes land
+    const char* path = "seedisa_test.trace";
+    Computer c(core);
+    for (uint32_t i = 0; i < 8; i++) c.get_bus().write_byte(0x3000 + i, uint8_t(i + 1));
+    std::vector<uint8_t> prog;
+    auto store = [&](uint16_t addr, uint8_t v) {
+        emit(prog, 0x1, 0, 0, v);
+        emit(prog, 0x3, 0, 0, addr);
+    };
+    store(0xF008, 0x00); store(0xF009, 0x30);   // source 0x3000
+    store(0xF00A, 0x00); store(0xF00B, 0x02);   // destination 0x200
+    store(0xF00C, 8); store(0xF00D, 0);         // length 8
+    store(0xF00F, DMA::START);
+    store(0xF00A, 0x00); store(0xF00B, 0x03);   // destination 0x300
+    store(0xF00E, 0xAB);                        // fill value
+    store(0xF00F, DMA::START | DMA::FILL | DMA::PACED);
+    for (int i = 0; i < 8; i++) emit(prog, 0x0, 0, 0, 0);   // NOP
+    emit(prog, 0xF, 0, 0, 0);                   // HLT
+    c.load_program(prog.data(), prog.size());
+
+    Tracer tracer(path);
+    c.set_tracer(&tracer);
+    c.run();
+    c.set_tracer(nullptr);
+    tracer.stop();
+    std::vector<TraceRecord> t;
+    bool read = Tracer::read_file(path, t) && t.size() == 31;
+    std::remove(path);
+
+    int starts = 0, foreign = 0;
+    for (const TraceRecord& r : t) {
+        if (r.mem_len == 0) continue;
+        if (r.mem_addr == 0xF00F && r.mem_len == 1) starts++;
+        if (r.mem_addr < 0xF008 || r.mem_addr > 0xF00F || r.mem_len != 1) foreign++;
+    }
+    bool landed = c.get_bus().read_byte(0x207) == 8 && c.get_bus().read_byte(0x303) == 0xAB;
+
+    bool pass = read && starts == 2 && foreign == 0 && landed;
+    std::cout << "test_trace_dma: read=" << read << " starts=" << starts << " foreign writes="
+              << foreign << " landed=" << landed << " " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_self_modifying(CoreType core) {
+    // A loop body patches its own LDI immediate, so each pass must see the
+    // new bytes. Then the host reloads the program and it must run fresh.
+    Computer c(core);
+    std::vector<uint8_t> prog;
+    emit(prog, 0x1, 1, 0, 0);          // addr 0:  LDI R1, 0 (pass counter)
+    emit(prog, 0x1, 0, 0, 5);          // addr 3:  LDI R0, 5   <- patched below
+    emit(prog, 0xD, 1, 0, 1);          // addr 6:  ADDI R1, 1
+    emit(prog, 0x1, 2, 0, 9);          // addr 9:  LDI R2, 9
+    emit(prog, 0x3, 2, 0, 3);          // addr 12: ST R2, [3] (imm_lo of addr 3)
+    emit(prog, 0x1, 3, 0, 2);          // addr 15: LDI R3, 2
+    emit(prog, 0x9, 1, 3, 0);          // addr 18: CMP R1, R3
+    emit(prog, 0xC, 0, 0, 3);          // addr 21: JNZ 3
+    emit(prog, 0xF, 0, 0, 0);          // addr 24: HLT
+    c.load_program(prog.data(), prog.size());
+    c.run();
+    bool patched = c.get_cpu().get_reg(0) == 9;
+
+    std::vector<uint8_t> prog2;
+    emit(prog2, 0x1, 0, 0, 33);        // LDI R0, 33
+    emit(prog2, 0xF, 0, 0, 0);         // HLT
+    c.load_program(prog2.data(), prog2.size());
+    c.reset();
+    c.run();
+    bool reloaded = c.get_cpu().get_reg(0) == 33;
+
+    bool pass = patched && reloaded;
+    std::cout << "test_smc:  patched=" << patched << " reloaded=" << reloaded
+              << " (expect 1, 1) " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_code_patch_loop(CoreType core) {
+    // Every pass rewrites the LDI below with the pass count: enough code
+    // writes that translating cores have to give up on the page.
+    Computer c(core);
+    std::vector<uint8_t> prog;
+    emit(prog, 0x1, 1, 0, 0);          // addr 0:  LDI R1, 0
+    emit(prog, 0x1, 0, 0, 0);          // addr 3:  LDI R0, <patched>
+    emit(prog, 0xD, 1, 0, 1);          // addr 6:  ADDI R1, 1
+    emit(prog, 0x3, 1, 0, 3);          // addr 9:  ST R1, [3]
+    emit(prog, 0x1, 3, 0, 20);         // addr 12: LDI R3, 20
+    emit(prog, 0x9, 1, 3, 0);          // addr 15: CMP R1, R3
+    emit(prog, 0xC, 0, 0, 3);          // addr 18: JNZ 3
+    emit(prog, 0xF, 0, 0, 0);          // addr 21: HLT
+    c.load_program(prog.data(), prog.size());
+    c.run();
+
+    bool pass = c.get_cpu().get_reg(0) == 19 && c.get_cpu().get_reg(1) == 20;
+    std::cout << "test_patch: R0=" << (int)c.get_cpu().get_reg(0) << " R1=" << (int)c.get_cpu().get_reg(1)
+              << " (expect 19, 20) " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_jit_compiles_blocks() {
+    // The loop test again, checking the JIT really ran it natively
+    Computer c(CoreType::Jit);
+    auto& jit = static_cast<JitCPU&>(c.get_cpu());
+    if (!jit.jit_available()) {
+        std::cout << "test_jit:  no executable memory on this host, interpreting SKIP\n";
+        return true;
+    }
+    std::vector<uint8_t> prog;
+    emit(prog, 0x1, 0, 0, 0);   // addr 0: LDI R0, 0
+    emit(prog, 0x1, 1, 0, 200); // addr 3: LDI R1, 200
+    emit(prog, 0xD, 0, 0, 1);   // addr 6: ADDI R0, 1
+    emit(prog, 0x9, 0, 1, 0);   // addr 9: CMP R0, R1
+    emit(prog, 0xC, 0, 0, 6);   // addr 12: JNZ 6
+    emit(prog, 0xF, 0, 0, 0);   // addr 15: HLT
+    c.load_program(prog.data(), prog.size());
+    c.run(1000);
+
+    bool pass = c.get_cpu().get_reg(0) == 200 && c.get_cpu().is_halted() && jit.blocks_compiled() > 0;
+    std::cout << "test_jit:  R0=" << (int)c.get_cpu().get_reg(0) << " blocks=" << jit.blocks_compiled()
+              << " (expect 200, >0) " << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_bitsliced_alu() {
+    // 64 ALUs in one uint64_t slice, each with its own operands and op,
+    // checked lane by lane against the scalar ALU
+    std::mt19937 rng(99);
+    int mismatches = 0;
+    for (int round = 0; round < 50; round++) {
+        uint64_t a[64], b[64], op[64];
+        for (int k = 0; k < 64; k++) { a[k] = rng() & 0xFF; b[k] = rng() & 0xFF; op[k] = rng() & 3; }
+        auto ops = slice_pack<2>(op);
+
+        ALU<8, uint64_t> sliced;
+        sliced.compute(slice_pack<8>(a), slice_pack<8>(b), ops[0], ops[1]);
+
+        for (int k = 0; k < 64; k++) {
+            ALU<8> scalar;
+            scalar.compute(Bits<8>(a[k]), Bits<8>(b[k]), op[k] & 1, op[k] >> 1);
+            if (slice_get<8>(sliced.result, k) != (uint64_t)scalar.to_int()
+                || ((sliced.carry >> k) & 1) != scalar.carry
+                || ((sliced.zero >> k) & 1) != scalar.zero) mismatches++;
+        }
+    }
+    bool pass = mismatches == 0;
+    std::cout << "test_slice: 64-lane ALU vs scalar, " << mismatches << " mismatches "
+              << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_bitsliced_register_file() {
+    // A 64-lane register file: decoder picks the register to load, a
+    // Mux4 reads one back; every lane uses different registers
+    std::mt19937 rng(7);
+    std::array<Register<8, uint64_t>, 4> regs;
+    uint64_t model[64][4] = {};
+    const uint64_t ones = LaneTraits<uint64_t>::ones();
+    int mismatches = 0;
+
+    for (int round = 0; round < 100; round++) {
+        uint64_t data[64], wsel[64], rsel[64], we[64];
+        for (int k = 0; k < 64; k++) {
+            data[k] = rng() & 0xFF; wsel[k] = rng() & 3; rsel[k] = rng() & 3; we[k] = rng() & 1;
+        }
+        auto in = slice_pack<8>(data);
+        auto ws = slice_pack<2>(wsel);
+        auto rs = slice_pack<2>(rsel);
+
+        Decoder<2, uint64_t> dec;
+        dec.decode(ws, slice_pack<1>(we)[0]);
+        for (int r = 0; r < 4; r++) {
+            regs[r].clock(0, dec.outputs[r], in);
+            regs[r].clock(ones, dec.outputs[r], in);
+        }
+
+        Mux4<8, uint64_t> read;
+        read.select(rs[0], rs[1], regs[0].data_out, regs[1].data_out,
+                    regs[2].data_out, regs[3].data_out);
+
+        for (int k = 0; k < 64; k++) {
+            if (we[k]) model[k][wsel[k]] = data[k];
+            if (slice_get<8>(read.output, k) != model[k][rsel[k]]) mismatches++;
+        }
+    }
+    bool pass = mismatches == 0;
+    std::cout << "test_slice: 64-lane register file, " << mismatches << " mismatches "
+              << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+#if SEEDISA_GATE_PROFILE
+// Profile counts are per wire: one clock of Register<8> is 8 flip-flops
+// (16 latches), and a packed bus costs what the same wires unpacked do
+bool test_gate_profile_units() {
+    GateProfile& p = GateProfile::get();
+    Register<8> reg;
+    reg.clock(false, true, Bits<8>(0x5A));
+    p.reset();
+    reg.clock(true, true, Bits<8>(0x5A));   // the rising edge
+    GateCounts r = p.total();
+
+    p.reset();
+    BasicDFlipFlop<Bits<8>> packed;
+    packed.clock(Bits<8>(0xFF), Bits<8>(0x5A));
+    GateCounts a = p.total();
+    p.reset();
+    std::array<bool, 8> d;
+    for (int i = 0; i < 8; i++) d[i] = (0x5A >> i) & 1;
+    BasicDFlipFlop<std::array<bool, 8>> unpacked;
+    unpacked.clock(LaneTraits<std::array<bool, 8>>::ones(), d);
+    GateCounts b = p.total();
+    p.reset();
+
+    bool pass = r.flip_flops == 8 && r.latches == 16 && reg.data_out.to_int() == 0x5A
+        && a.gates == b.gates && a.latches == b.latches && a.flip_flops == b.flip_flops;
+    std::cout << "test_gate_profile: Register<8> flip-flops=" << r.flip_flops << " latches=" << r.latches
+              << " (expect 8, 16), packed gates=" << a.gates << " unpacked=" << b.gates << " "
+              << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+#endif
+
+#if defined(__AVX2__)
+// ALU<8> into a Register<8> over a wide lane, every machine checked
+// against the scalar ALU and a model register. Each 64 machines are
+// packed as a uint64_t slice and the slices put side by side.
+template <typename Lane>
+bool test_wide_lanes(const char* name) {
+    constexpr int WORDS = LaneTraits<Lane>::WIDTH / 64;
+    using Slices = std::array<uint64_t, WORDS>;
+    std::mt19937 rng(WORDS);
+    Register<8, Lane> reg;
+    uint64_t model[WORDS][64] = {};
+    int mismatches = 0;
+
+    auto value = [](const Wires<8, Lane>& wires, int w, int k) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++) v |= ((wires[i].words()[w] >> k) & 1) << i;
+        return v;
+    };
+
+    for (int round = 0; round < 20; round++) {
+        uint64_t a[WORDS][64], b[WORDS][64], op[WORDS][64], ld[WORDS][64];
+        Wires<8, Lane> wa, wb;
+        Slices op0, op1, load;
+        for (int w = 0; w < WORDS; w++) {
+            for (int k = 0; k < 64; k++) {
+                a[w][k] = rng() & 0xFF; b[w][k] = rng() & 0xFF; op[w][k] = rng() & 3; ld[w][k] = rng() & 1;
+            }
+            auto as = slice_pack<8>(a[w]), bs = slice_pack<8>(b[w]);
+            auto ops = slice_pack<2>(op[w]);
+            op0[w] = ops[0]; op1[w] = ops[1]; load[w] = slice_pack<1>(ld[w])[0];
+            for (int i = 0; i < 8; i++) {
+                Slices x = wa[i].words(), y = wb[i].words();
+                x[w] = as[i]; y[w] = bs[i];
+                wa[i] = Lane(x); wb[i] = Lane(y);
+            }
+        }
+
+        ALU<8, Lane> alu;
+        alu.compute(wa, wb, Lane(op0), Lane(op1));
+        reg.clock(LaneTraits<Lane>::zeros(), Lane(load), alu.result);
+        reg.clock(LaneTraits<Lane>::ones(), Lane(load), alu.result);
+
+        Slices carry = alu.carry.words(), zero = alu.zero.words();
+        for (int w = 0; w < WORDS; w++) {
+            for (int k = 0; k < 64; k++) {
+                ALU<8> scalar;
+                scalar.compute(Bits<8>(a[w][k]), Bits<8>(b[w][k]), op[w][k] & 1, op[w][k] >> 1);
+                if (ld[w][k]) model[w][k] = scalar.to_int();
+                if (value(alu.result, w, k) != (uint64_t)scalar.to_int()
+                    || ((carry[w] >> k) & 1) != scalar.carry
+                    || ((zero[w] >> k) & 1) != scalar.zero
+                    || value(reg.data_out, w, k) != model[w][k]) mismatches++;
+            }
+        }
+    }
+    bool pass = mismatches == 0;
+    std::cout << "test_slice: " << name << " ALU and register vs scalar, " << mismatches << " mismatches "
+              << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+#endif
+
+// Every input combination through the template (`reference`), the
+// netlist's eval loop and the generated straight-line function
+bool netlist_matches(const char* name, const Netlist& net,
+                     const std::function<std::vector<bool>(const std::vector<bool>&)>& reference,
+                     void (*generated)(const bool*, bool*)) {
+    int mismatches = 0;
+    std::vector<bool> in(net.num_inputs);
+    bool in_buf[32], net_out[64], gen_out[64];
+    std::unique_ptr<bool[]> wires(new bool[net.num_wires()]);
+    for (uint32_t v = 0; v < (1u << net.num_inputs); v++) {
+        for (int i = 0; i < net.num_inputs; i++) in_buf[i] = in[i] = (v >> i) & 1;
+        std::vector<bool> want = reference(in);
+        net.eval(in_buf, net_out, wires.get());
+        generated(in_buf, gen_out);
+        for (size_t o = 0; o < want.size(); o++)
+            if (net_out[o] != want[o] || gen_out[o] != want[o]) { mismatches++; break; }
+    }
+    bool pass = mismatches == 0;
+    std::cout << "test_net:  " << name << " " << net.gate_count() << " gates depth " << net.depth
+              << ", " << (1u << net.num_inputs) << " inputs, " << mismatches << " mismatches "
+              << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_adder_netlist() {
+    return netlist_matches("adder8", adder_netlist<8>(), [](const std::vector<bool>& in) {
+        Bits<8> a, b;
+        for (int i = 0; i < 8; i++) { a[i] = in[i]; b[i] = in[8 + i]; }
+        RippleCarryAdder<8> adder;
+        adder.add(a, b, in[16]);
+        std::vector<bool> out;
+        for (int i = 0; i < 8; i++) out.push_back(adder.sum[i]);
+        out.push_back(adder.carry_out);
+        return out;
+    }, adder8_net<bool>);
+}
+
+bool test_alu_netlist() {
+    return netlist_matches("alu8", alu_netlist<8>(), [](const std::vector<bool>& in) {
+        Bits<8> a, b;
+        for (int i = 0; i < 8; i++) { a[i] = in[i]; b[i] = in[8 + i]; }
+        ALU<8> alu;
+        alu.compute(a, b, in[16], in[17]);
+        std::vector<bool> out;
+        for (int i = 0; i < 8; i++) out.push_back(alu.result[i]);
+        out.push_back(alu.carry);
+        out.push_back(alu.zero);
+        return out;
+    }, alu8_net<bool>);
+}
+
+bool test_control_unit_netlist() {
+    return netlist_matches("control", control_unit_netlist(), [](const std::vector<bool>& in) {
+        ControlUnit cu;
+        cu.decode(Bits<4>(in[0] | in[1] << 1 | in[2] << 2 | in[3] << 3), in[4]);
+        std::vector<bool> out;
+        for (auto pin : control_pins<bool>()) out.push_back(cu.signals.*pin);
+        return out;
+    }, control_unit_net<bool>);
+}
+
+// One adder design: every 8-bit a, b and carry-in against integer
+// addition, then its 16-bit netlist on random 64-lane slices
+template <template <int, typename> class Adder>
+bool check_adder() {
+    int mismatches = 0;
+    for (uint32_t v = 0; v < (1u << 17); v++) {
+        uint32_t a = v & 0xFF, b = (v >> 8) & 0xFF, cin = v >> 16;
+        Adder<8, bool> adder;
+        adder.add(Bits<8>(a), Bits<8>(b), cin);
+        uint32_t want = a + b + cin;
+        if ((uint32_t)adder.to_int() != (want & 0xFF) || adder.carry_out != bool(want >> 8)) mismatches++;
+    }
+
+    Netlist net = adder_netlist<16, Adder>();
+    std::vector<uint64_t> wires(net.num_wires());
+    std::mt19937_64 rng(16);
+    for (int round = 0; round < 64; round++) {
+        uint64_t in[33], out[17];
+        for (uint64_t& x : in) x = rng();
+        net.eval(in, out, wires.data());
+        for (int k = 0; k < 64; k++) {
+            uint32_t a = 0, b = 0, got = 0;
+            for (int i = 0; i < 16; i++) {
+                a |= ((in[i] >> k) & 1) << i;
+                b |= ((in[16 + i] >> k) & 1) << i;
+            }
+            for (int i = 0; i < 17; i++) got |= ((out[i] >> k) & 1) << i;
+            if (got != a + b + ((in[32] >> k) & 1)) mismatches++;
+        }
+    }
+
+    bool pass = mismatches == 0;
+    std::cout << "test_adder: " << Adder<16, bool>::NAME << ", 16-bit " << net.gate_count()
+              << " gates depth " << net.depth << ", " << mismatches << " mismatches "
+              << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_ripple_adder() { return check_adder<RippleCarryAdder>(); }
+bool test_lookahead_adder() { return check_adder<CarryLookaheadAdder>(); }
+bool test_kogge_stone_adder() { return check_adder<KoggeStoneAdder>(); }
+bool test_brent_kung_adder() { return check_adder<BrentKungAdder>(); }
+
+bool test_adder_in_alu_and_pc() {
+    // ALU and PC built on a prefix adder behave exactly like the ripple ones
+    std::mt19937 rng(8);
+    int mismatches = 0;
+    for (int n = 0; n < 5000; n++) {
+        Bits<8> a(rng()), b(rng());
+        bool op0 = rng() & 1, op1 = rng() & 1;
+        ALU<8> ripple;
+        ALU<8, bool, BrentKungAdder> prefix;
+        ripple.compute(a, b, op0, op1);
+        prefix.compute(a, b, op0, op1);
+        if (ripple.to_int() != prefix.to_int() || ripple.carry != prefix.carry || ripple.zero != prefix.zero)
+            mismatches++;
+    }
+
+    ProgramCounter pc;
+    BasicProgramCounter<CarryLookaheadAdder> pc_cla;
+    for (int n = 0; n < 300; n++) {
+        bool jump = n % 50 == 0;
+        Bits<16> target(rng());
+        for (bool clk : {false, true}) {
+            pc.clock(clk, jump, target);
+            pc_cla.clock(clk, jump, target);
+        }
+        if (pc.to_int() != pc_cla.to_int()) mismatches++;
+    }
+
+    bool pass = mismatches == 0;
+    std::cout << "test_adder: ALU/PC with prefix adders, " << mismatches << " mismatches "
+              << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+// Architectural state that every core must agree on after each step
+bool same_state(Core& a, Core& b) {
+    for (int i = 0; i < 4; i++)
+        if (a.get_reg(i) != b.get_reg(i)) return false;
+    return a.get_pc() == b.get_pc() && a.get_sp() == b.get_sp()
+        && a.get_zero() == b.get_zero() && a.get_carry() == b.get_carry()
+        && a.get_int_enabled() == b.get_int_enabled()
+        && a.is_halted() == b.is_halted();
+}
+
+// Fill the low 1 KB with random instructions and point every IVT entry into
+// it, then seed both machines identically. Random code is free to store
+// anywhere, including over itself and into the I/O page.
+void load_random_program(std::mt19937& rng, Computer& a, Computer& b) {
+    std::vector<uint8_t> prog;
+    for (int i = 0; i < 0x400 / 3; i++) {
+        uint16_t imm = rng() & 0x3FF;                      // mostly in-range jumps
+        if ((rng() & 7) == 0) imm = 0xF000 | (rng() & 3);  // sometimes I/O
+        uint8_t op = rng() & 0xF;
+        if (op == 0xF && (rng() & 7)) op = rng() & 0xE;    // keep HLT rare
+        emit(prog, op, rng() & 3, rng() & 3, imm);
+    }
+    a.load_program(prog.data(), prog.size());
+    b.load_program(prog.data(), prog.size());
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        uint16_t handler = (rng() % (0x400 / 3)) * 3;
+        a.get_bus().write_word(IVT_BASE + i * 2, handler);
+        b.get_bus().write_word(IVT_BASE + i * 2, handler);
+    }
+}
+
+// Programs that once made a core diverge, each run for a few steps
+struct DirectedProgram {
+    std::vector<uint8_t> code;
+    int steps;
+};
+
+std::vector<DirectedProgram> directed_programs() {
+    std::vector<DirectedProgram> progs;
+
+    // SWI past the IVT with SP clear of the I/O region: its vector is
+    // read from the timer, which a batch must not have left behind
+    std::vector<uint8_t> swi;
+    emit(swi, 0x1, 0, 0, 200);      // LDI R0, 200
+    emit(swi, 0x3, 0, 0, 0xF000);   // ST R0, [timer reload]
+    emit(swi, 0x1, 0, 0, 2);        // LDI R0, 2
+    emit(swi, 0x3, 0, 0, 0xF001);   // ST R0, [timer ctrl] (enable)
+    emit(swi, 0x0, 0, 1, 0);        // PUSH R0
+    emit(swi, 0x0, 0, 1, 0);        // PUSH R0
+    for (int i = 0; i < 10; i++) emit(swi, 0x0, 0, 0, 0);   // NOP
+    emit(swi, 0x0, 1, 3, 8);        // SWI 8: vector at 0xF000
+    progs.push_back({swi, 27});
+    return progs;
+}
+
+// Run the directed programs, then random ones, on the reference
+// gate-level core (decode cache off, every fetch clocked through the IR)
+// and on `core` side by side, injecting the same host events into both.
+bool cross_check(CoreType core, const char* name) {
+    std::mt19937 rng(1234);
+    int programs = 200, steps = 300, mismatches = 0;
+
+    for (const DirectedProgram& d : directed_programs()) {
+        Computer ref(CoreType::Gate), dut(core);
+        static_cast<CPU&>(ref.get_cpu()).set_decode_cache(false);
+        ref.load_program(d.code.data(), d.code.size());
+        dut.load_program(d.code.data(), d.code.size());
+        ref.run(d.steps);
+        dut.run(d.steps);
+        if (!same_state(ref.get_cpu(), dut.get_cpu())) {
+            std::cout << "  " << name << " diverged: directed program, pc="
+                      << ref.get_cpu().get_pc() << "/" << dut.get_cpu().get_pc() << "\n";
+            mismatches++;
+        }
+    }
+
+    for (int p = 0; p < programs && !mismatches; p++) {
+        Computer ref(CoreType::Gate), dut(core);
+        static_cast<CPU&>(ref.get_cpu()).set_decode_cache(false);
+        load_random_program(rng, ref, dut);
+
+        // Advance in short runs of random length so batching cores get
+        // cut at arbitrary points, with host events in between
+        for (int s = 0; s < steps; ) {
+            int chunk = 1 + rng() % 24;
+            uint32_t ev = rng() % 8;
+            if (ev == 0) {
+                uint8_t num = rng() & 7;
+                ref.get_cpu().raise_interrupt(num);
+                dut.get_cpu().raise_interrupt(num);
+            }
+            if (ev == 1) { ref.get_uart().send_char('x'); dut.get_uart().send_char('x'); }
+            ref.run(chunk);
+            dut.run(chunk);
+            s += chunk;
+            if (!same_state(ref.get_cpu(), dut.get_cpu())
+                || ref.get_uart().recv_string() != dut.get_uart().recv_string()) {
+                std::cout << "  " << name << " diverged: program " << p << " step " << s
+                          << " pc=" << ref.get_cpu().get_pc() << "/" << dut.get_cpu().get_pc() << "\n";
+                mismatches++;
+                break;
+            }
+        }
+    }
+
+    bool pass = mismatches == 0;
+    std::cout << "test_xchk: " << name << " vs gate, " << programs << " random programs "
+              << (pass ? "PASS" : "FAIL") << "\n";
+    return pass;
+}
+
+bool test_fast_core_matches_gate() { return cross_check(CoreType::Fast, "fast"); }
+bool test_threaded_core_matches_gate() { return cross_check(CoreType::Threaded, "threaded"); }
+bool test_jit_core_matches_gate() { return cross_check(CoreType::Jit, "jit"); }
+bool test_decode_cache_matches_gate() { return cross_check(CoreType::Gate, "gate+icache"); }
+
 int main() {
     std::cout << "=== seedisa CPU tests ===\n\n";
 
     int passed = 0, total = 0;
-    auto run = [&](bool (*fn)()) { total++; if (fn()) passed++; };
-
-    run(test_add);
-    run(test_sub);
-    run(test_ldi_and_mov);
-    run(test_jump);
-    run(test_conditional_jump);
-    run(test_memory);
-    run(test_loop);
-    run(test_push_pop);
-    run(test_call_ret);
-    run(test_16bit_address);
-    run(test_software_interrupt);
-    run(test_hardware_interrupt);
-    run(test_timer_device);
-    run(test_uart);
-    run(test_jc_jnc);
-    run(test_indexed_load_store);
+    auto check = [&](bool ok) { total++; if (ok) passed++; };
+
+    bool (*const tests[])(CoreType) = {
+        test_add, test_sub, test_ldi_and_mov, test_jump, test_conditional_jump,
+        test_memory, test_loop, test_push_pop, test_call_ret, test_16bit_address,
+        test_software_interrupt, test_hardware_interrupt, test_timer_device,
+        test_uart, test_uart_stream, test_dma, test_interrupt_controller, test_smp,
+        test_jc_jnc, test_indexed_load_store, test_mapped_device, test_bank_switch,
+        test_fork, test_snapshot, test_replay, test_replay_uart_input, test_breakpoints,
+        test_idle_skip, test_cycles, test_trace, test_trace_dma, test_self_modifying,
+        test_code_patch_loop,
+    };
+    const std::pair<CoreType, const char*> cores[] = {
+        {CoreType::Gate, "gate"}, {CoreType::Fast, "fast"}, {CoreType::Threaded, "threaded"},
+        {CoreType::Jit, "jit"},
+    };
+
+    // Every program test runs on every core
+    for (auto& [core, name] : cores) {
+        std::cout << "--- " << name << " core ---\n";
+        for (auto fn : tests) check(fn(core));
+        std::cout << "\n";
+    }
+
+    check(test_jit_compiles_blocks());
+    check(test_bus_burst());
+    check(test_snapshot_versions());
+    check(test_scheduler());
+    check(test_core_watchers());
+    check(test_sparse_memory());
+    check(test_bitsliced_alu());
+    check(test_bitsliced_register_file());
+#if SEEDISA_GATE_PROFILE
+    check(test_gate_profile_units());
+#endif
+#if defined(__AVX2__)
+    check(test_wide_lanes<Lane256>("256-lane"));
+#endif
+#if defined(__AVX512F__)
+    check(test_wide_lanes<Lane512>("512-lane"));
+#endif
+    check(test_adder_netlist());
+    check(test_alu_netlist());
+    check(test_control_unit_netlist());
+    check(test_ripple_adder());
+    check(test_lookahead_adder());
+    check(test_kogge_stone_adder());
+    check(test_brent_kung_adder());
+    check(test_adder_in_alu_and_pc());
+    check(test_decode_cache_matches_gate());
+    check(test_fast_core_matches_gate());
+    check(test_threaded_core_matches_gate());
+    check(test_jit_core_matches_gate());
+    check(test_smp_parallel());
 
     std::cout << "\n" << passed << "/" << total << " tests passed\n";
     return (passed == total) ? 0 : 1;